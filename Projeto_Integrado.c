@@ -10,14 +10,38 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "pico/stdlib.h"
+#include "pico/multicore.h"
+#include "pico/flash.h"
+#include "pico/stdio_usb.h"
 #include "hardware/i2c.h"
 #include "lib/ssd1306.h"
 #include "lib/font.h"
+#include "lib/compositor.h"
+#include "lib/scheduler.h"
+#include "lib/adc_sampler.h"
+#include "lib/filters.h"
+#include "lib/tone.h"
+#include "lib/ws2812b.h"
+#include "lib/led_anim.h"
+#include "lib/spsc.h"
+#include "lib/seqlock.h"
+#include "lib/sensor_conv.h"
+#include "lib/trace.h"
+#include "lib/flashlog.h"
+#include "lib/rollstats.h"
+#include "lib/health.h"
+#include "lib/irrigation.h"
+#include "lib/power.h"
+#include "lib/input.h"
+#include "lib/audio.h"
+#include "lib/telemetry.h"
 #include "hardware/clocks.h"
 #include "hardware/adc.h"
 #include "math.h"
 #include "hardware/irq.h"
+#include "tusb.h"
 #include "hardware/gpio.h"
 #include "hardware/timer.h"
 #include "hardware/pio.h"
@@ -44,88 +68,378 @@ const uint microfone = 28;     // GPIO28 para ADC2
 #define JOYSTICK_Y_PIN 27  // GPIO para eixo Y
 #define sw 22              // Controla o botão do joystick
 
-// Paramentros de planta saudável
-#define LUZ_MIN 50
-#define LUZ_MAX 90
-#define TEMP_MIN 20
-#define TEMP_MAX 35
-#define UMIDADE_MIN 10
-#define UMIDADE_MAX 50
+// Parâmetros de planta saudável: perfis por espécie em lib/health.c
 #define LED_COUNT 25
 
 //#define INTERVALO_24H 6000
 #define INTERVALO_24H 86400000 // 24 horas em milissegundos (1000 * 60 * 60 * 24)
 
+// Histórico na flash: uma amostra dos sensores por minuto
+#define HISTORICO_AMOSTRA_S 60
+#define REGA_MANUAL 0          // Origem da rega nos registros FLASHLOG_WATER
+#define REGA_BOMBA  1
+
+// Rega em malha fechada: pulsos de bomba, espera de infiltração e proteções
+// (a faixa alvo e o volume por ciclo e por dia vêm do perfil da planta)
+#define REGA_PULSO_MS      1000
+#define REGA_INFILTRA_MS   8000
+#define REGA_SUBIDA_MIN    Q8(1)      // Menos que 1 % depois do pulso conta como sem resposta
+#define REGA_PULSOS_SECOS  3
+#define REGA_DESCANSO_MS   (30 * 60 * 1000)
+
+// Economia de energia: sem botões por TELA_APAGA_MS o OLED e a matriz apagam;
+// por ECONOMIA_MS, o clock cai para 48 MHz e o ADC passa a amostrar só em
+// janelas (umidade e temperatura mudam em minutos)
+#define TELA_APAGA_MS      (60 * 1000)
+#define ECONOMIA_MS        (3 * 60 * 1000)
+#define JANELA_PERIODO_MS  (30 * 1000)     // Uma janela de amostragem a cada 30 s
+#define JANELA_MS          1000            // Os filtros assentam em ~50 ms
+#define CLOCK_ATIVO_KHZ    128000
+#define BATERIA_MAH        2000            // Base da autonomia projetada no relatório
+
+// Estados de energia, na ordem da tabela de correntes
+enum {
+  ENERGIA_ATIVO,                   // Clock cheio, tela acesa
+  ENERGIA_APAGADO,                 // Clock cheio, OLED e matriz apagados
+  ENERGIA_JANELA,                  // 48 MHz, ADC amostrando
+  ENERGIA_ECONOMIA,                // 48 MHz, ADC parado entre janelas
+  ENERGIA_ESTADOS
+};
+
+// Correntes estimadas (µA) com o núcleo 0 executando e em WFE: RP2040 ~20 mA
+// a 128 MHz e ~8 mA a 48 MHz (metade em WFE), OLED aceso ~10 mA, ADC ~1 mA e
+// os 25 LEDs da matriz ~0,5 mA cada mesmo apagados (não há chave para eles).
+// Trocar pelos valores medidos na placa; a contabilidade só multiplica
+const power_state_desc_t estados_energia[ENERGIA_ESTADOS] = {
+  [ENERGIA_ATIVO]    = { "ativo",    43500, 33500 },
+  [ENERGIA_APAGADO]  = { "apagado",  33500, 23500 },
+  [ENERGIA_JANELA]   = { "janela",   21500, 17500 },
+  [ENERGIA_ECONOMIA] = { "economia", 20500, 16500 },
+};
+
 // flags de controle
-volatile uint32_t tmp_ant = 0;
 volatile uint32_t tmp_ant2 = 0;
 volatile uint8_t mov = 0;
-volatile uint8_t ap = 0;
 volatile uint8_t cont = 3;
-volatile uint8_t problemas = 0;
-volatile uint8_t cont_molhadas = 0;
-volatile uint8_t molhadas = 0;
-volatile uint8_t flag_clear = 0;
-volatile uint8_t flag_rega = 0;
 volatile uint8_t cont2 = 5;
 
 // Variáveis Booleanas de controle de Estado
-volatile bool x = false;
-volatile bool v = false;
-volatile bool z = false;
-volatile bool botao_apertado = false; // Variável global para indicar que o botão foi pressionado
-volatile bool flag = false;
+volatile bool v = false;   // Alterna o aviso de rega (só o núcleo 1 usa)
 
 // Variáveis de Controle de Tempo
 volatile uint32_t tempo_anterior = 0;
 volatile uint32_t tempo_anterior2 = 0;
 volatile uint32_t tempo_anterior3 = 0;
-volatile uint32_t ultimo_tempo_apertado = 0; // Tempo do último aperto (para debounce)
-volatile uint32_t tempo_decorrido = 0;
+
+// Estado compartilhado do sistema. Só as tarefas do núcleo 0 escrevem, sempre no
+// rascunho 'est' (as tarefas não se interrompem umas às outras); ao terminar,
+// a tarefa publica a nova versão. ISRs, alarmes e o núcleo 1 leem com estado_le().
+typedef struct {
+  uint8_t ap;                      // Tela atual
+  bool x;                          // Animação do sorriso em curso (OLED apagado)
+  bool flag;                       // Seletor da rega automática em OFF
+  uint8_t flag_rega;               // Rega automática armada
+  uint8_t cont_molhadas;           // Acionamentos do SW no dia
+  uint8_t molhadas;                // Sorrisos (plantas molhadas) desde o boot
+  bool bomba_ligada;               // Estado da bomba (substitui os sleeps)
+  uint8_t rega_estado;             // irrigation_state_t do controlador da rega
+  uint8_t janela_tendencia;        // Janela da tela de tendências (rollstats_window_t)
+  uint8_t perfil;                  // Perfil da planta em health_profiles
+  uint8_t energia;                 // Estado de energia; fora do ATIVO o núcleo 1 apaga tudo
+  uint32_t tempo_decorrido;        // ms desde que a rega automática foi armada
+  uint32_t pedidos_sorriso;        // Pedidos ao núcleo 1 (contadores: um estado
+  uint32_t pedidos_limpeza;        // perdido não perde o pedido)
+} estado_t;
+
+estado_t est;                      // Rascunho do escritor (núcleo 0)
+estado_t estado_copias[2];         // Cópias publicadas
+seqlock_t estado_lock;
+
+// Segundos contados pelo timer da rega; a ISR só incrementa e o controle consome
+volatile uint32_t segundos_rega = 0;
+uint32_t segundos_vistos = 0;
+bool timer_rega_ativo = false;
+
+// Inatividade medida pelos botões. O núcleo 1 mantém tela_apagada (só ele
+// escreve) enquanto o OLED e a matriz estão apagados e parados: o núcleo 0 lê
+// o nível antes de o clock cair (o I2C e a PIO dele dependem do clock)
+uint32_t ultima_atividade = 0;
+volatile bool tela_apagada = false;
+uint32_t inicio_janela = 0;
+
+// Últimos contadores gravados no histórico (molhadas, cont_molhadas, flag_rega)
+int32_t contadores_gravados[3];
+
+static inline void estado_publica(void) {
+  seqlock_publish(&estado_lock, &est);
+}
+
+static inline uint32_t estado_le(estado_t *copia) {
+  return seqlock_read(&estado_lock, copia);
+}
+
+// Alerta sonoro: bipes de 1 kHz no ritmo do LED vermelho, repetidos pelo gerador PWM
+const tone_note_t som_alerta[] = {
+  { 1000, 200, 50 },
+  { TONE_REST, 200, 0 },
+};
+bool alerta_tocando = false;
+bool sorriso_rodando = false;      // Pedido enviado ao núcleo 1 e ainda não concluído
+// Sorrisos concluídos: só o núcleo 1 escreve, o núcleo 0 compara com o último visto
+volatile uint32_t sorrisos_feitos = 0;
+uint32_t sorrisos_vistos = 0;
 
 const uint amostras_por_segundo = 8000; // Frequência de amostragem (8 kHz)
 
+// Filtros por canal entre o amostrador e os consumidores: média de 32 amostras
+// (250 Hz), mediana de 5 contra picos isolados e EMA de peso 1/8
+#define FILTRO_OS_LOG2 5
+#define FILTRO_MEDIANA 5
+#define FILTRO_EMA     3
+filter_chain_t filtro_x, filtro_y, filtro_mic;
+
+// Análise do microfone em blocos de 32 ms (nível e bandas, lib/audio.h). A
+// tarefa de sensores processa os blocos prontos até estourar o orçamento; o
+// que sobra espera a próxima execução na fila do audio_t
+#define AUDIO_ORCAMENTO_US 2000
+_Static_assert(AUDIO_BANDS == SENSOR_BANDS, "bandas do audio fora das leituras");
+audio_t som;
+uint32_t audio_bloco_us, audio_pior_us;   // Último bloco e o mais lento
+uint32_t audio_adiados;                   // Execuções que deixaram bloco na fila
+
+// Telemetria binária pelo USB (lib/telemetry.h), ligada pelo comando 'x'. A
+// tarefa de sensores grava os registros; a de telemetria, acordada por ela,
+// escoa o anel sem nunca esperar o host
+#define TELEMETRIA_STATUS_MS 1000
+tlm_t telemetria;
+bool telemetria_ligada = false;
+
+// Limiares com histerese: o estado só muda depois de atravessar a faixa inteira
+hysteresis_t alerta_seca = HYST_BELOW_INIT(30, 33);        // Umidade < 30%
+hysteresis_t alerta_luz = HYST_ABOVE_INIT(80, 77);         // Luminosidade > 80%
+hysteresis_t umidade_critica = HYST_BELOW_INIT(10, 12);    // Aviso de regar
+hysteresis_t temp_rega = HYST_BELOW_INIT(25, 27);          // Ciclo de rega só começa abaixo de 25 c
+
+// Controlador da rega automática e a configuração do perfil em uso
+irrigation_config_t rega_cfg;
+irrigation_t rega;
+
+// Estado publicado pelo núcleo 0 (sensores e controle) para o núcleo 1 (renderização).
+// Vai por cópia numa fila SPSC; o núcleo 1 sempre desenha o mais recente.
+typedef struct {
+  estado_t sis;                    // Estado do sistema no momento da publicação
+  uint32_t versao;                 // Versão do estado publicada junto
+  bool alerta;                     // Umidade baixa ou luminosidade alta
+  bool sel_on, sel_off;            // Seletor ON/OFF (histerese do eixo X)
+  uint16_t adc_x, adc_y;
+  sensor_readings_t leitura;
+  rollstats_summary_t resumo[SENSOR_COUNT][ROLLSTATS_WINDOWS];   // Atualizado a cada segundo
+  health_result_t saude;           // Avaliada pelo controle, só exibida aqui
+} estado_tela_t;
+
+#define FILA_ESTADOS 4
+SPSC_STORAGE(estados_buf, estado_tela_t, FILA_ESTADOS);
+spsc_queue_t fila_estados;
+
+// Valores exibidos nas telas de dados, vinculados aos campos do compositor
+typedef struct {
+  int temp;
+  int umidade;
+  int lumi;
+  const char *status;
+  const char *problema;
+  const char *perfil;
+} leituras_t;
+
+leituras_t leituras;
+compositor_t compositor;
+
+// Telas 2 a 5: camadas estáticas (rasterizadas uma vez) e campos dinâmicos
+const compositor_layer_t camadas_temperatura[] = {
+  LAYER_TEXT_AT(7, 6, "DADOS COLETADOS"),
+  LAYER_VLINE_AT(57, 32, 64),
+  LAYER_RECT_AT(0, 0, 128, 18),
+  LAYER_RECT_AT(0, 0, 128, 32),
+  LAYER_RECT_AT(0, 0, 128, 64),
+  LAYER_TEXT_AT(14, 21, "<temperatura>"),
+  LAYER_TEXT_AT(7, 34, "ideal:"),
+  LAYER_TEXT_AT(63, 34, "20-35c"),
+  LAYER_HLINE_AT(0, 128, 47),
+  LAYER_TEXT_AT(7, 52, "atual:"),
+  LAYER_TEXT_AT(80, 52, "c"),
+};
+compositor_field_t campos_temperatura[] = { FIELD_INT_AT(63, 52, 2, &leituras.temp) };
+
+const compositor_layer_t camadas_luminosidade[] = {
+  LAYER_TEXT_AT(7, 6, "DADOS COLETADOS"),
+  LAYER_VLINE_AT(57, 32, 64),
+  LAYER_RECT_AT(0, 0, 128, 18),
+  LAYER_RECT_AT(0, 0, 128, 64),
+  LAYER_RECT_AT(0, 0, 128, 32),
+  LAYER_TEXT_AT(10, 21, "<luminosidade>"),
+  LAYER_TEXT_AT(7, 34, "ideal:"),
+  LAYER_HLINE_AT(0, 128, 47),
+  LAYER_TEXT_AT(63, 34, "50-70%"),
+  LAYER_TEXT_AT(7, 52, "atual:"),
+  LAYER_TEXT_AT(80, 52, "%"),
+};
+compositor_field_t campos_luminosidade[] = { FIELD_INT_AT(63, 52, 2, &leituras.lumi) };
+
+const compositor_layer_t camadas_umidade[] = {
+  LAYER_TEXT_AT(7, 6, "DADOS COLETADOS"),
+  LAYER_RECT_AT(0, 0, 128, 18),
+  LAYER_VLINE_AT(57, 32, 64),
+  LAYER_RECT_AT(0, 0, 128, 64),
+  LAYER_RECT_AT(0, 0, 128, 32),
+  LAYER_TEXT_AT(26, 21, "<umidade>"),
+  LAYER_TEXT_AT(6, 34, "ideal:"),
+  LAYER_TEXT_AT(7, 52, "atual:"),
+  LAYER_TEXT_AT(63, 34, "20-30%"),
+  LAYER_HLINE_AT(0, 128, 47),
+  LAYER_TEXT_AT(80, 52, "%"),
+};
+compositor_field_t campos_umidade[] = { FIELD_INT_AT(63, 52, 2, &leituras.umidade) };
+
+const compositor_layer_t camadas_saude[] = {
+  LAYER_TEXT_AT(3, 6, "PAINEL DE SAUDE"),
+  LAYER_RECT_AT(0, 0, 128, 18),
+  LAYER_RECT_AT(0, 0, 128, 64),
+  LAYER_TEXT_AT(10, 22, "Status:"),
+};
+compositor_field_t campos_saude[] = {
+  FIELD_TEXT_AT(10, 31, 14, &leituras.status),
+  FIELD_TEXT_AT(10, 41, 14, &leituras.problema),
+  FIELD_TEXT_AT(10, 52, 14, &leituras.perfil),
+};
+
+compositor_screen_t telas_dados[] = {
+  SCREEN_OF(camadas_temperatura, campos_temperatura),    // ap == 2
+  SCREEN_OF(camadas_luminosidade, campos_luminosidade),  // ap == 3
+  SCREEN_OF(camadas_umidade, campos_umidade),            // ap == 4
+  SCREEN_OF(camadas_saude, campos_saude),                // ap == 5
+};
+
 
 void draw_tree(ssd1306_t *ssd);                                                                 // Desenha a árvore
 void efect_tree(ssd1306_t *ssd, int x, int y);                                                 // Movimento da árvore
-void tela_inicial(ssd1306_t *ssd, uint8_t ap, uint16_t adc_value_x, uint16_t adc_value_y, uint16_t luminosidade, bool k);
+void tela_inicial(ssd1306_t *ssd, const estado_tela_t *e);                                      // Desenha a tela do estado publicado
 void init_disp();                                                                              // Inicializa os periféricos
 void init_ADC();                                                                               // Inicializa os disp. ADC
 void regar(ssd1306_t *ssd, bool val);                                                          // função para rega
 
-const char* avaliarSaude(int luz, int temp, int umidade);                                      // Avalia qual estado de saude
-void lumi_temp(ssd1306_t *ssd, uint16_t adc_value_x, uint16_t adc_value_y, bool v);            // Dispara quando a umidade é baixa
-void play_sound(uint frequency, uint duration_ms);                                             // Função Sonora de Alerta
-void rega_automatica(int adc_value_x, int adc_value_y, int molhada);                           // Habilita a rega automática
-void teste(ssd1306_t *ssd, uint16_t adc_value_x, uint16_t adc_value_y);                                                                                  // Teste de ADC (Joystick)
-void smile_face(ssd1306_t *ssd, PIO pio, uint sm);                                                                                            // Função Smile
-void clear_leds();                                                                              // Limpa(apaga) os Leds da Matriz
-void print_leds(PIO pio, uint sm);                                                              // Desenha os Leds na Matriz
-void set_led(uint8_t indice, uint8_t r, uint8_t g, uint8_t b);                                  // Seta os Leds que serão ativados
-
-void button_a_isr(uint gpio, uint32_t events){
-  uint32_t agora = to_us_since_boot(get_absolute_time());
-  if(flag){ //verifica se a rega automática não está acionada
-    if (agora - tmp_ant > 200) {  // Debounce de 200 us
-      if(!gpio_get(btnA)){
-        ap = 0;
-        x = 1;
-        cont = 4;
-        flag_clear = 0;
-      }
-        tmp_ant = agora;
+void avalia_saude(health_result_t *saude);                                                      // Regras do perfil sobre as médias
+void lumi_temp(ssd1306_t *ssd, const sensor_readings_t *leitura, bool v);                      // Dispara quando a umidade é baixa
+void configura_rega(uint8_t perfil);                                                            // Faixa e limites da rega do perfil
+void teste(ssd1306_t *ssd, uint16_t adc_value_x, uint16_t adc_value_y);                        // Teste de ADC (Joystick)
+void tela_tendencias(ssd1306_t *ssd, const estado_tela_t *e);                                   // Mínimo, média e máximo por janela
+void pulso_led(uint gpio, uint32_t duracao_ms);                                                 // Acende um LED por um tempo sem bloquear
+
+// Tarefas do escalonador (cada uma roda até o fim, sem sleep)
+void button_a();                                                                               // Reações aos botões
+void button_b();
+void button_sw();
+void tarefa_entrada(uint32_t eventos, void *ctx);                                               // Eventos dos botões e do seletor
+void tarefa_sensores(uint32_t eventos, void *ctx);                                              // Leitura dos ADCs
+void microfone_sink(void *ctx, uint16_t amostra);                                               // Amostra do microfone para filtro e áudio
+bool processa_audio(void);                                                                      // Blocos de áudio dentro do orçamento
+void telemetria_sensores(bool audio_novo);                                                      // Registros do lote para a telemetria
+void tarefa_rega(uint32_t eventos, void *ctx);                                                  // Bomba (rega automática)
+void tarefa_controle(uint32_t eventos, void *ctx);                                              // Alertas, seletor e publicação do estado
+void tarefa_relatorio(uint32_t eventos, void *ctx);                                             // Tempos de execução via USB
+void tarefa_comandos(uint32_t eventos, void *ctx);                                              // Comandos recebidos pelo USB
+void tarefa_historico(uint32_t eventos, void *ctx);                                             // Histórico persistente na flash
+void tarefa_telemetria(uint32_t eventos, void *ctx);                                            // Envia a telemetria binária pelo USB
+size_t usb_escreve(void *ctx, const uint8_t *dados, size_t n);                                  // Porto da telemetria, sem bloquear
+void tarefa_energia(uint32_t eventos, void *ctx);                                               // Tela, clock e amostragem por inatividade
+void muda_energia(uint8_t novo);                                                                // Aplica um estado de energia
+void restaura_contadores(void);                                                                 // Recupera os contadores do histórico
+void imprime_historico(uint32_t janela_s);                                                      // Lista o histórico pelo USB
+void imprime_estatisticas(void);                                                                // Resumo das janelas pelo USB
+void imprime_saude(void);                                                                       // Perfil e regras violadas pelo USB
+void imprime_audio(void);                                                                       // Nível, bandas e custo da análise do microfone
+
+// Núcleo 1: renderização do OLED e da matriz de LEDs
+void nucleo1_main(void);                                                                        // Laço de renderização
+void render_tela(ssd1306_t *ssd, const estado_tela_t *e);                                       // Telas do OLED
+void render_animacao(const estado_tela_t *e);                                                   // Animações da matriz de LEDs
+
+// Eventos entregues às tarefas
+#define EV_ENTRADA    (1u << 0)   // Fila do lib/input com eventos novos
+#define EV_TELEMETRIA (1u << 1)   // Registros novos no quadro da telemetria
+
+// Fontes da entrada, na ordem do cadastro em main()
+enum { ENTRADA_A, ENTRADA_B, ENTRADA_SW };
+enum { EIXO_X };
+
+// Botões: o B segurado continua passando as telas; o eixo X é o seletor da
+// rega automática, com histerese nas duas pontas (zona alta = ON)
+const input_button_cfg_t botoes[] = {
+  [ENTRADA_A]  = { btnA, 0, 0 },
+  [ENTRADA_B]  = { btnB, 600, 250 },
+  [ENTRADA_SW] = { sw, 0, 0 },
+};
+const input_axis_cfg_t eixo_seletor = {
+  .low = HYST_BELOW_INIT(1000, 1100),    // Joystick à esquerda
+  .high = HYST_ABOVE_INIT(3080, 2980),   // Joystick à direita
+};
+uint8_t zona_seletor = INPUT_ZONE_CENTER;   // Última zona recebida da fila
+
+// Leituras mais recentes dos ADCs (atualizadas pela tarefa de sensores)
+volatile uint16_t adc_value_x;
+volatile uint16_t adc_value_y;
+volatile uint16_t intensity;
+
+// Leituras convertidas do último lote, usadas por todas as telas, alertas e rega
+sensor_readings_t leitura;
+
+// Janelas de 1 min, 1 h e 24 h de cada sensor (Q8), alimentadas a cada lote
+rollstats_t tendencias[SENSOR_COUNT];
+rollstats_summary_t resumo[SENSOR_COUNT][ROLLSTATS_WINDOWS];   // Combinado pelo controle
+
+// Última avaliação de saúde (núcleo 0) e a última gravada no histórico
+health_result_t saude;
+health_result_t saude_gravada = { .violated = 0xFF };
+uint8_t perfil_gravado;
+
+ssd1306_t ssd;
+PIO pio = pio0;
+uint sm;
+ws2812b_t matriz;   // Quadro GRB empacotado da matriz, enviado por DMA
+led_anim_t animacao;
+repeating_timer_t timer;
+
+int id_entrada, id_sensores, id_rega, id_controle, id_energia, id_relatorio, id_comandos, id_telemetria, id_historico;
+
+// Estatísticas do laço de renderização (escritas pelo núcleo 1)
+volatile uint32_t render_quadros = 0;
+volatile uint32_t render_pior_us = 0;
+
+// Lógica do botão A (antes na ISR); chega já sem repique, um aperto por evento
+void button_a(){
+  // Na tela de saúde o A troca o perfil da planta; na de tendências, a janela
+  if(est.ap == 5 || est.ap == 7){
+    if(est.ap == 5)
+      est.perfil = (est.perfil + 1) % health_profile_count;
+    else
+      est.janela_tendencia = (est.janela_tendencia + 1) % ROLLSTATS_WINDOWS;
+    return;
+  }
+  if(est.flag){ //verifica se a rega automática não está acionada
+    est.ap = 0;
+    est.x = 1;
+    cont = 4;
+    est.pedidos_limpeza++;
+    if(!sorriso_rodando){
+      sorriso_rodando = true;
+      est.molhadas++;
+      est.pedidos_sorriso++;
     }
   }
 }
 
-// Função de callback do timer
+// Função de callback do timer: só conta o segundo, a contagem de 24 h fica no controle
 bool timer_callback(repeating_timer_t *rt) {
-  tempo_decorrido += 1000; // Incrementa 1 segundo (1000 ms)
-  if (tempo_decorrido >= INTERVALO_24H) {
-      cont_molhadas = 0;   // zera a quantidade de molhadas, para inicializar um novo
-      tempo_decorrido = 0; // Reinicia a contagem após 24 horas
-      flag_rega = 0;       //flag para o controle da rega 
-  }
+  segundos_rega++;
   return true; // Mantém o timer ativo
 }
 
@@ -133,7 +447,6 @@ bool timer_callback(repeating_timer_t *rt) {
 
 int main() {
     // Inicializações
-    PIO pio = pio0; 
     bool ok;
     ok = set_sys_clock_khz(128000, false);
 
@@ -143,7 +456,7 @@ int main() {
 
     //configurações da PIO
     uint offset = pio_add_program(pio, &ws2812b_program);
-    uint sm = pio_claim_unused_sm(pio, true);
+    sm = pio_claim_unused_sm(pio, true);
     ws2812b_program_init(pio, sm, offset, LED_PIN);
 
     // I2C Initialisation. Using it at 400Khz.
@@ -154,97 +467,807 @@ int main() {
     gpio_pull_up(I2C_SDA); // Pull up the data line
     gpio_pull_up(I2C_SCL); // Pull up the clock line
 
-    ssd1306_t ssd; // Inicializa a estrutura do display
-    ssd1306_init(&ssd, 128, 64, false, endereco, I2C_PORT); // Inicializa o display
-    ssd1306_config(&ssd); // Configura o display
-    ssd1306_send_data(&ssd); // Envia os dados para o display
+    adc_gpio_init(microfone);  // Configura GPIO28 como entrada ADC para o microfone
 
-    // Limpa o display. O display inicia com todos os pixels apagados.
-    ssd1306_fill(&ssd, false);
-    ssd1306_send_data(&ssd);
+    // Amostragem contínua em round-robin dos canais 0, 1 e 2 via FIFO + DMA,
+    // com amostras_por_segundo em cada canal (médias decimadas de 64 amostras)
+    adc_sampler_start((1u << 0) | (1u << 1) | (1u << 2), 3 * amostras_por_segundo, 64);
+    filter_init(&filtro_x, FILTRO_OS_LOG2, FILTRO_MEDIANA, FILTRO_EMA);
+    filter_init(&filtro_y, FILTRO_OS_LOG2, FILTRO_MEDIANA, FILTRO_EMA);
+    filter_init(&filtro_mic, FILTRO_OS_LOG2, FILTRO_MEDIANA, FILTRO_EMA);
+    adc_sampler_set_sink(1, filter_sink, &filtro_x);
+    adc_sampler_set_sink(0, filter_sink, &filtro_y);
+    audio_init(&som, audio_bands_8k);
+    adc_sampler_set_sink(2, microfone_sink, NULL);
+    leitura.som_q8 = leitura.som_pico_q8 = AUDIO_FLOOR_Q8;   // Silêncio até o primeiro bloco
+    for (int i = 0; i < SENSOR_BANDS; i++)
+      leitura.bandas_q8[i] = AUDIO_FLOOR_Q8;
+    for (int i = 0; i < SENSOR_COUNT; i++)
+      rollstats_init(&tendencias[i]);
+    irrigation_init(&rega, &rega_cfg);
+
+    // Tarefas em ordem de prioridade: período e prazo em ms
+    sched_init();
+    id_entrada   = sched_add_task("entrada",   tarefa_entrada,   NULL, 0, 20);
+    id_sensores  = sched_add_task("sensores",  tarefa_sensores,  NULL, 50, 10);
+    id_rega      = sched_add_task("rega",      tarefa_rega,      NULL, 100, 20);
+    id_controle  = sched_add_task("controle",  tarefa_controle,  NULL, 50, 10);
+    id_energia   = sched_add_task("energia",   tarefa_energia,   NULL, 500, 0);
+    id_relatorio = sched_add_task("relatorio", tarefa_relatorio, NULL, 10000, 0);
+    id_comandos  = sched_add_task("comandos",  tarefa_comandos,  NULL, 100, 0);
+    id_telemetria = sched_add_task("telemetria", tarefa_telemetria, NULL, 0, 0);
+    id_historico = sched_add_task("historico", tarefa_historico, NULL, 1000, 0);
+
+    // Botões por interrupção e debounce por alarme; cada evento da fila
+    // acorda a tarefa de entrada, que só roda quando há o que consumir
+    input_init(id_entrada, EV_ENTRADA);
+    for (int i = 0; i < (int)count_of(botoes); i++)
+      input_add_button(&botoes[i]);
+    input_add_axis(&eixo_seletor);
+    power_init(estados_energia, ENERGIA_ESTADOS, ENERGIA_ATIVO);
+    tlm_init(&telemetria, usb_escreve, NULL);
+
+    // Histórico da flash: recupera o log e os contadores antes de publicar o primeiro estado
+    flashlog_init();
+    restaura_contadores();
+    configura_rega(est.perfil);
+
+    // Telas e matriz de LEDs vão para o núcleo 1; o núcleo 0 fica com sensores e controle
+    seqlock_init(&estado_lock, &estado_copias[0], &estado_copias[1], sizeof(estado_t), &est);
+    spsc_init(&fila_estados, estados_buf, sizeof(estado_tela_t), FILA_ESTADOS);
+    multicore_launch_core1(nucleo1_main);
+
+    sched_run();
+}
 
-    uint16_t adc_value_x;
-    uint16_t adc_value_y;
-    
-    repeating_timer_t timer;
+// Botão B: passa as telas (segurado, o REPEAT continua passando)
+void button_b(){
+  est.x = 0;
+  // Pede ao núcleo 1 para limpar a tela
+  est.pedidos_limpeza++;
+  // Vai passando as telas
+  est.ap++;
+
+  //Depois da tela de tendências volta para a inicial.
+  if(est.ap == 8){
+    est.ap = 1;
+  }
+}
 
-    gpio_set_irq_enabled_with_callback(btnA, GPIO_IRQ_EDGE_FALL, true, &button_a_isr);
-    
-    adc_gpio_init(microfone);  // Configura GPIO28 como entrada ADC para o microfone
+// Botão SW: um evento por aperto, mesmo segurado (antes contava a cada 200 ms)
+void button_sw(){
+  est.cont_molhadas++;
+  // Permite que a rega automática seja feita somente 1 vez por dia
+  if(est.cont_molhadas == 1){ //se a planta for regada apenas 1 vez
+    if(!est.flag){
+      if(!timer_rega_ativo){ // um único timer, mesmo depois de virar o dia
+        add_repeating_timer_ms(1000, timer_callback, NULL, &timer); // ativa o temporizador o timer para 24h é 1000
+        timer_rega_ativo = true;
+      }
+      // Led verde indica a rega automática está ativada
+      pulso_led(VERDE, 1000);
+      est.flag_rega = 1;
+      est.ap = 6;
+    }
 
-     // Define o intervalo entre amostras (em microsegundos)
-     uint64_t intervalo_us = 1000000 / amostras_por_segundo;
-
-    while (true) {
-
-        adc_select_input(1); // Seleciona o ADC para eixo X(Temperatura). O pino 26 como entrada analógica
-        adc_value_x = adc_read();
-        adc_select_input(0); // Seleciona o ADC para eixo Y(Umidade). O pino 27 como entrada analógica
-        adc_value_y = adc_read();    
-        adc_select_input(2);          // Seleciona o canal 2 (GPIO28)
-        uint16_t mic_value = adc_read(); // Lê o ADC
-        uint16_t intensity = mic_value;
-        uint8_t pct_um = (100 - ((adc_value_y * 100) / 4095));
-        
-        //Verifica se o botão B não foi precisonado
-        if(!gpio_get(btnB)){
-          x = 0;
-          // Limpa a tela
-          ssd1306_fill(&ssd, false);
-          ssd1306_send_data(&ssd);
-          // Vai passando as telas
-          ap++;
-          
-          //Caso a tela seja a sétima volta para a inicial.
-          if(ap == 7){
-            ap = 1;
-          }
-          
-        }
+  }
+  // Com a rega automática em ON, o SW também libera o controlador depois de
+  // uma falha (reservatório reabastecido ou vaso conferido)
+  if(!est.flag && irrigation_fault(&rega)){
+    irrigation_clear(&rega);
+    pulso_led(VERDE, 1000);
+  }
+  //verifica se a rega automática está em OFF
+  if(est.flag == true){ //pressionada no off
+    pulso_led(RED, 1000);
+  }
+}
 
-        //Verifica se o botão SW não foi pressionado
-        if(!gpio_get(sw)){
-
-          cont_molhadas++;
-          // Permite que a rega automática seja feita somente 1 vez por dia
-          if(cont_molhadas == 1){ //se a planta for regada apenas 1 vez
-            if(!flag){
-              add_repeating_timer_ms(1000, timer_callback, NULL, &timer); // ativa o temporizador o timer para 24h é 1000
-              // Led verde indica a rega automática está ativada
-              gpio_put(VERDE, 1);
-              sleep_ms(1000);
-              gpio_put(VERDE, 0);
-              flag_rega = 1;
-              ap = 6;
-            }
-            
-          }
-          //verifica se a rega automática está em OFF
-          if(flag == true){ //pressionada no off
-            gpio_put(RED, 1);
-            sleep_ms(1000);
-            gpio_put(RED, 0);
-          }
-        }
-        if(x == 1){
-          flag_clear++;
-          if(flag_clear == 1){
-            ssd1306_fill(&ssd, false);
-            ssd1306_send_data(&ssd);
-          }
-          smile_face(&ssd, pio, sm);
-          printf("planta molhada: %d\n", molhadas);
-        }
-        if(flag_rega == 1){
-          rega_automatica(adc_value_x, adc_value_y, cont_molhadas);
-        }
-        
-        //Exibe a tela inicial
-        tela_inicial(&ssd, ap, adc_value_x, adc_value_y, intensity,  v);
-        
-        sleep_ms(195); // sleep para leitura do botão, debounce
+// Consome a fila do lib/input; só roda quando há evento, sem ler os pinos
+void tarefa_entrada(uint32_t eventos, void *ctx){
+  // Botão conta como atividade. Com a tela apagada o aperto só acorda, e o
+  // botão fica ignorado até soltar
+  static uint8_t ignorados = 0;
+  input_event_t ev;
+  while(input_pop(&ev)){
+    if(ev.type != INPUT_AXIS){
+      ultima_atividade = to_ms_since_boot(get_absolute_time());
+      if(est.energia != ENERGIA_ATIVO && ev.type == INPUT_PRESS){
+        muda_energia(ENERGIA_ATIVO);
+        ignorados |= 1u << ev.source;
+      }
+      if(ignorados & (1u << ev.source)){
+        if(ev.type == INPUT_RELEASE)
+          ignorados &= ~(1u << ev.source);
+        input_done(&ev);
+        continue;
+      }
+    }
+
+    if(ev.type == INPUT_AXIS){
+      zona_seletor = ev.value;   // Aplicada pelo controle, que conhece o alerta
+    }else if(ev.source == ENTRADA_A && ev.type == INPUT_PRESS){
+      button_a();
+    }else if(ev.source == ENTRADA_B && (ev.type == INPUT_PRESS || ev.type == INPUT_REPEAT)){
+      button_b();
+    }else if(ev.source == ENTRADA_SW && ev.type == INPUT_PRESS){
+      button_sw();
+    }
+    estado_publica();
+    input_done(&ev);
+  }
+}
+
+// O microfone alimenta dois consumidores: o filtro da luminosidade e a análise de áudio
+void microfone_sink(void *ctx, uint16_t amostra){
+  filter_sink(&filtro_mic, amostra);
+  audio_push(&som, amostra);
+}
+
+// Blocos prontos do microfone, com custo fixo cada, até AUDIO_ORCAMENTO_US.
+// Amostras perdidas pelo amostrador quebram o bloco em formação: recomeça.
+// Retorna true se algum bloco novo atualizou as leituras
+bool processa_audio(void){
+  static uint32_t perdidas = 0;
+  const sampler_core_t *core = adc_sampler_core();
+  if(core->skipped != perdidas){
+    perdidas = core->skipped;
+    audio_gap(&som);
+  }
+  uint32_t inicio = time_us_32();
+  uint32_t blocos = som.out.blocks;
+  while(audio_pending(&som)){
+    if(time_us_32() - inicio >= AUDIO_ORCAMENTO_US){
+      audio_adiados++;
+      break;
     }
+    uint32_t t0 = time_us_32();
+    audio_process(&som);
+    audio_bloco_us = time_us_32() - t0;
+    if(audio_bloco_us > audio_pior_us)
+      audio_pior_us = audio_bloco_us;
+  }
+  if(som.out.blocks == blocos)
+    return false;
+  leitura.som_q8 = som.out.rms_db_q8;
+  leitura.som_pico_q8 = som.out.peak_db_q8;
+  memcpy(leitura.bandas_q8, som.out.band_db_q8, sizeof(leitura.bandas_q8));
+  return true;
+}
+
+// Registros do lote para a telemetria: as leituras sempre, o áudio quando
+// houve bloco novo. Só copia bytes; a saída fica com a tarefa de telemetria
+void telemetria_sensores(bool audio_novo){
+  uint32_t agora = to_ms_since_boot(get_absolute_time());
+  uint8_t r[TLM_AUDIO_LEN], *p = r;
+  p = tlm_put16(p, leitura.temp_q8);
+  p = tlm_put16(p, leitura.umidade_q8);
+  p = tlm_put16(p, leitura.lumi_q8);
+  tlm_put16(p, leitura.som_q8);
+  tlm_record(&telemetria, TLM_SENSORS, agora, r, TLM_SENSORS_LEN);
+  if(audio_novo){
+    p = tlm_put16(r, leitura.som_pico_q8);
+    for(int i = 0; i < SENSOR_BANDS; i++)
+      p = tlm_put16(p, leitura.bandas_q8[i]);
+    tlm_record(&telemetria, TLM_AUDIO, agora, r, TLM_AUDIO_LEN);
+  }
+  sched_post(id_telemetria, EV_TELEMETRIA);
+}
+
+// Recolhe o que o DMA amostrou desde a última execução; nunca espera o ADC
+void tarefa_sensores(uint32_t eventos, void *ctx){
+  adc_sampler_poll(); // Cada amostra nova já passa pelos filtros do seu canal
+  adc_value_x = filter_value(&filtro_x);   // Canal 1: eixo X (Temperatura)
+  adc_value_y = filter_value(&filtro_y);   // Canal 0: eixo Y (Umidade)
+  intensity = filter_value(&filtro_mic);   // Canal 2 (GPIO28): microfone
+  input_axis_update(EIXO_X, adc_value_x);  // O seletor vira evento ao mudar de zona
+  bool audio_novo = processa_audio();
+
+  // Conversão única por lote: ninguém mais refaz as contas com os valores brutos
+  sensor_raw_t brutos = {{
+    [SENSOR_TEMP] = adc_value_x,
+    [SENSOR_UMIDADE] = adc_value_y,
+    [SENSOR_LUMI] = intensity,
+  }};
+  sensor_conv_run(&brutos, &leitura);
+
+  // Só entra nas estatísticas depois que os três filtros produziram a primeira
+  // saída, e só com saída nova (com o ADC parado entre janelas os valores repetem)
+  static uint32_t saidas_vistas = 0;
+  if(filtro_x.outputs && filtro_y.outputs && filtro_mic.outputs && filtro_mic.outputs != saidas_vistas){
+    saidas_vistas = filtro_mic.outputs;
+    uint32_t agora_s = time_us_64() / 1000000;
+    rollstats_add(&tendencias[SENSOR_TEMP], agora_s, leitura.temp_q8);
+    rollstats_add(&tendencias[SENSOR_UMIDADE], agora_s, leitura.umidade_q8);
+    rollstats_add(&tendencias[SENSOR_LUMI], agora_s, leitura.lumi_q8);
+    if(telemetria_ligada)
+      telemetria_sensores(audio_novo);
+  }
 }
+
+// Rega automática armada pelo SW e com o seletor em ON: o controlador decide
+// os pulsos pela umidade filtrada; aqui só o pino, o trace e o histórico
+void tarefa_rega(uint32_t eventos, void *ctx){
+  static uint8_t perfil_rega = 0;
+  if(est.perfil != perfil_rega){
+    perfil_rega = est.perfil;
+    configura_rega(perfil_rega);
+  }
+
+  // Quente demais, o ciclo não começa (evapora); um ciclo já iniciado termina
+  bool fresco = hyst_update(&temp_rega, Q8_INT(leitura.temp_q8));
+  bool habilitada = est.flag_rega == 1 && !est.flag && (rega.state != IRRIGATION_IDLE || fresco);
+  bool bomba = irrigation_update(&rega, to_ms_since_boot(get_absolute_time()), leitura.umidade_q8, habilitada);
+
+  if(bomba != est.bomba_ligada){
+    gpio_put(BLUE, bomba);
+    TRACE(TRACE_PUMP, bomba);
+    est.bomba_ligada = bomba;
+    if(bomba && rega.pulses == 1){
+      flashlog_record_t r = { .type = FLASHLOG_WATER, .v = { REGA_BOMBA } };
+      flashlog_append(&r);
+    }
+  }
+  if(irrigation_take_end(&rega)){
+    static const char *const fins[] = { "-", "faixa", "limite do ciclo", "limite do dia", "sem agua",
+                                        "transbordo", "interrompida" };
+    printf("rega: %s, %u pulsos, %lu ms de bomba\n", fins[rega.last_end], rega.pulses,
+           (unsigned long)rega.cycle_ms);
+    flashlog_record_t r = { .type = FLASHLOG_IRRIGATION, .v = {
+      rega.last_end, rega.pulses, (int32_t)rega.cycle_ms, (leitura.umidade_q8 * 10) >> 8,
+    } };
+    flashlog_append(&r);
+  }
+  est.rega_estado = rega.state;
+  estado_publica();
+}
+
+void configura_rega(uint8_t perfil){
+  const health_profile_t *p = &health_profiles[perfil];
+  rega_cfg = (irrigation_config_t){
+    .low_q8 = Q8(p->water_band[0]),
+    .high_q8 = Q8(p->water_band[1]),
+    .overflow_q8 = Q8(p->limit[HEALTH_SOIL_WET]),
+    .min_rise_q8 = REGA_SUBIDA_MIN,
+    .pulse_ms = REGA_PULSO_MS,
+    .soak_ms = REGA_INFILTRA_MS,
+    .dry_pulses = REGA_PULSOS_SECOS,
+    .cycle_max_ms = p->water_cycle_s * 1000u,
+    .day_max_ms = p->water_day_s * 1000u,
+    .rest_ms = REGA_DESCANSO_MS,
+  };
+}
+
+
+// Decide alertas e o seletor no ritmo do controle (independente do tempo de desenho)
+// e publica o estado para o núcleo 1
+void tarefa_controle(uint32_t eventos, void *ctx){
+  // Aviso do núcleo de renderização
+  uint32_t sorrisos = sorrisos_feitos;
+  if(sorrisos != sorrisos_vistos){
+    // Fim do sorriso: volta para a tela da rega automática
+    sorrisos_vistos = sorrisos;
+    sorriso_rodando = false;
+    est.ap = 1;
+    est.x = 0;
+    printf("planta molhada: %d\n", est.molhadas);
+    flashlog_record_t r = { .type = FLASHLOG_WATER, .v = { REGA_MANUAL } };
+    flashlog_append(&r);
+  }
+
+  // Segundos contados pela ISR do timer desde a última execução
+  uint32_t segundos = segundos_rega;
+  est.tempo_decorrido += (segundos - segundos_vistos) * 1000;
+  segundos_vistos = segundos;
+  if (est.tempo_decorrido >= INTERVALO_24H) {
+      est.cont_molhadas = 0;   // zera a quantidade de molhadas, para inicializar um novo
+      est.tempo_decorrido = 0; // Reinicia a contagem após 24 horas
+      irrigation_new_day(&rega); // Novo volume diário; a rega automática continua armada
+  }
+
+  //mapeamento dos sensores: valores já convertidos pela tarefa de sensores (fixos na tela de teste)
+  int pct_um = 60;
+  int lumi = 50;
+  if(est.ap != 0){
+    pct_um = Q8_INT(leitura.umidade_q8);
+    lumi = Q8_INT(leitura.lumi_q8);
+  }
+
+  // Resumos das janelas: combinados uma vez por segundo, a tela só copia
+  static uint32_t resumo_s = UINT32_MAX;
+  uint32_t agora_s = time_us_64() / 1000000;
+  if(agora_s != resumo_s){
+    resumo_s = agora_s;
+    for(int i = 0; i < SENSOR_COUNT; i++)
+      for(int j = 0; j < ROLLSTATS_WINDOWS; j++)
+        rollstats_get(&tendencias[i], j, agora_s, &resumo[i][j]);
+  }
+  avalia_saude(&saude);
+
+  // Atualiza as histereses sempre, para nenhuma ficar com estado velho
+  bool seca = hyst_update(&alerta_seca, pct_um);
+  bool luz_alta = hyst_update(&alerta_luz, lumi);
+  bool sel_on = zona_seletor == INPUT_ZONE_HIGH;
+  bool sel_off = zona_seletor == INPUT_ZONE_LOW;
+
+  //verifica se a umidade não está baixa nem a luminosidade muito alta
+  bool alerta = (seca && est.x != 1) || luz_alta;
+  // LED vermelho e buzzer também avisam da saúde grave no perfil escolhido e
+  // da falha da rega (a tela de alerta continua só para umidade e luz)
+  bool alarme = alerta || saude.level == HEALTH_SEVERE || irrigation_fault(&rega);
+  static bool z = false;
+  if(alarme){
+    uint32_t tempo_atual = to_ms_since_boot(get_absolute_time());
+    if(tempo_atual - tempo_anterior3 > 200){
+      z = !z;
+      tempo_anterior3 = tempo_atual;
+    }
+    // Emite um som de alerta em situações críticas: o padrão é iniciado uma vez e segue sozinho
+    if(!alerta_tocando){
+      tone_play_pattern(som_alerta, sizeof(som_alerta) / sizeof(som_alerta[0]), true);
+      alerta_tocando = true;
+      TRACE(TRACE_ALERT, 1);
+    }
+    gpio_put(RED, z);
+  }else{
+    gpio_put(RED, 0);
+    if(alerta_tocando){
+      tone_stop();
+      alerta_tocando = false;
+      TRACE(TRACE_ALERT, 0);
+    }
+  }
+  // Seletor da rega automática (só na tela de rega e fora do alerta)
+  if(!alerta && est.ap == 1){
+    if(sel_on){
+      est.flag = true;
+    }else if(sel_off){
+      est.flag = false;
+    }
+  }
+
+  estado_publica();
+  estado_tela_t e = {
+    .alerta = alerta,
+    .sel_on = sel_on,
+    .sel_off = sel_off,
+    .adc_x = adc_value_x,
+    .adc_y = adc_value_y,
+    .leitura = leitura,
+    .saude = saude,
+  };
+  memcpy(e.resumo, resumo, sizeof(resumo));
+  // Passa pelo seqlock como qualquer outro leitor: a tela recebe uma versão numerada
+  e.versao = estado_le(&e.sis);
+  spsc_push(&fila_estados, &e);
+  __sev();   // Acorda o núcleo 1 se estiver em WFE
+}
+
+// Política de energia: a inatividade dos botões apaga a tela e depois entra na
+// economia, que abre uma janela de amostragem a cada JANELA_PERIODO_MS. Um
+// ciclo de rega precisa da umidade depois de cada pulso: volta à amostragem
+// contínua (com a tela ainda apagada) até ele terminar
+void tarefa_energia(uint32_t eventos, void *ctx){
+  uint32_t agora = to_ms_since_boot(get_absolute_time());
+  uint32_t parado = agora - ultima_atividade;
+  bool rega_em_curso = rega.state == IRRIGATION_PULSE || rega.state == IRRIGATION_SOAK;
+
+  switch(est.energia){
+    case ENERGIA_ATIVO:
+      if(parado >= TELA_APAGA_MS && !sorriso_rodando)
+        muda_energia(ENERGIA_APAGADO);
+      break;
+    case ENERGIA_APAGADO:
+      if(parado >= ECONOMIA_MS && tela_apagada && !rega_em_curso)
+        muda_energia(ENERGIA_ECONOMIA);
+      break;
+    case ENERGIA_ECONOMIA:
+      if(rega_em_curso){
+        muda_energia(ENERGIA_APAGADO);
+      }else if(agora - inicio_janela >= JANELA_PERIODO_MS){
+        inicio_janela = agora;
+        muda_energia(ENERGIA_JANELA);
+      }
+      break;
+    case ENERGIA_JANELA:
+      if(rega_em_curso)
+        muda_energia(ENERGIA_APAGADO);
+      else if(agora - inicio_janela >= JANELA_MS)
+        muda_energia(ENERGIA_ECONOMIA);
+      break;
+  }
+  power_update();
+}
+
+// Troca o estado de energia mexendo só no que difere entre os dois: o clock
+// (e os divisores que dependem dele), a amostragem e o ritmo das tarefas
+void muda_energia(uint8_t novo){
+  uint8_t antes = est.energia;
+  if(novo == antes){
+    return;
+  }
+  bool clock_baixo = novo >= ENERGIA_JANELA;
+  if(clock_baixo != (antes >= ENERGIA_JANELA)){
+    // Desliga o PLL do sistema; USB e ADC ficam no PLL USB e o timer no cristal
+    if(clock_baixo)
+      set_sys_clock_48mhz();
+    else
+      set_sys_clock_khz(CLOCK_ATIVO_KHZ, false);
+    // O clk_peri segue o clk_sys: refaz o divisor do I2C e o da PIO da matriz
+    // (o PWM do buzzer é recalculado pelo tone.c a cada nota)
+    i2c_set_baudrate(I2C_PORT, 400 * 1000);
+    pio_sm_set_clkdiv(pio, sm, clock_get_hz(clk_sys) / 8000000.0f);
+    sched_set_period(id_rega, clock_baixo ? 1000 : 100);
+    sched_set_period(id_controle, clock_baixo ? 500 : 50);
+    sched_set_period(id_comandos, clock_baixo ? 500 : 100);
+  }
+  // Entre janelas o ADC para; nelas a tarefa de sensores volta aos 50 ms, já
+  // que o buffer do DMA dá a volta em ~170 ms
+  if(novo == ENERGIA_ECONOMIA){
+    adc_sampler_stop();
+    sched_set_period(id_sensores, 1000);
+  }else if(antes == ENERGIA_ECONOMIA){
+    adc_sampler_resume();
+    audio_gap(&som);   // O bloco em formação ficou antes da parada
+    sched_set_period(id_sensores, 50);
+  }
+  // As janelas se repetem a cada 30 s: só as outras trocas vão para o USB
+  if(novo != ENERGIA_JANELA && antes != ENERGIA_JANELA){
+    printf("energia: %s\n", estados_energia[novo].name);
+  }
+  if(novo == ENERGIA_ECONOMIA && antes != ENERGIA_JANELA){
+    inicio_janela = to_ms_since_boot(get_absolute_time());
+  }
+  est.energia = novo;
+  power_set_state(novo);
+  estado_publica();
+}
+
+void tarefa_relatorio(uint32_t eventos, void *ctx){
+  // Com a telemetria binária ligada o texto sai do caminho: o printf espera o
+  // host, e o registro de estado da telemetria já leva os contadores de perdas
+  if(telemetria_ligada)
+    return;
+  sched_print_stats();
+  printf("render (nucleo 1): %lu quadros, pior %lu us, estados descartados %lu\n",
+         (unsigned long)render_quadros, (unsigned long)render_pior_us, (unsigned long)fila_estados.dropped);
+  printf("estado v%lu: %lu leituras, %lu repeticoes (max %lu numa leitura)\n",
+         (unsigned long)seqlock_version(&estado_lock), (unsigned long)estado_lock.reads,
+         (unsigned long)estado_lock.retries, (unsigned long)estado_lock.max_retries);
+  input_print_stats();
+  uint32_t media_ua = power_average_ua();
+  printf("energia: %s, media %lu.%lu mA, autonomia %lu h\n", estados_energia[est.energia].name,
+         (unsigned long)(media_ua / 1000), (unsigned long)(media_ua % 1000 / 100),
+         (unsigned long)(media_ua ? (uint64_t)BATERIA_MAH * 1000 / media_ua : 0));
+}
+
+// Comandos de um caractere pelo USB:
+//   t  despeja o registro de eventos (decodificar com tools/trace_decode)
+//   l  descarta o que foi gravado até aqui
+//   h  lista o histórico da flash das últimas 24 h de operação
+//   e  resume as janelas de 1 min, 1 h e 24 h de cada sensor
+//   p  passa para o próximo perfil de planta e mostra a avaliação
+//   s  mostra a avaliação de saúde no perfil atual
+//   b  tempo, carga e autonomia projetada por estado de energia
+//   a  níveis e bandas do microfone e o custo da análise
+//   x  liga/desliga a telemetria binária (decodificar com tools/tlm_decode)
+// O despejo bloqueia enquanto o USB escoa o texto; só roda quando pedido
+void tarefa_comandos(uint32_t eventos, void *ctx){
+  int c;
+  while((c = getchar_timeout_us(0)) != PICO_ERROR_TIMEOUT){
+    if(c == 't'){
+      // Nomes para o argumento dos eventos "tarefa" e "render"
+      for(int id = 0; sched_task(id); id++)
+        printf("#N tarefa %d %s\n", id, sched_task(id)->name);
+      printf("#N render 0 tela\n#N render 1 matriz\n#N flash 0 programa\n#N flash 1 apaga\n");
+      trace_dump();
+    }else if(c == 'l'){
+      trace_clear();
+    }else if(c == 'h'){
+      imprime_historico(INTERVALO_24H / 1000);
+    }else if(c == 'e'){
+      imprime_estatisticas();
+    }else if(c == 'p'){
+      est.perfil = (est.perfil + 1) % health_profile_count;
+      estado_publica();
+      avalia_saude(&saude);
+      imprime_saude();
+    }else if(c == 's'){
+      imprime_saude();
+    }else if(c == 'b'){
+      power_print(BATERIA_MAH);
+    }else if(c == 'a'){
+      imprime_audio();
+    }else if(c == 'x'){
+      telemetria_ligada = !telemetria_ligada;
+      printf("telemetria %s\n", telemetria_ligada ? "ligada" : "desligada");
+      if(!telemetria_ligada){
+        tlm_close(&telemetria);   // O último quadro sai mesmo incompleto
+        sched_post(id_telemetria, EV_TELEMETRIA);
+      }
+    }
+  }
+}
+
+// Estado a cada TELEMETRIA_STATUS_MS e o anel para o USB, só o que o FIFO do
+// CDC aceita agora. Com o host sem ler, o anel enche e os quadros novos são
+// descartados e contados; nada aqui espera
+void tarefa_telemetria(uint32_t eventos, void *ctx){
+  static uint32_t proximo_status = 0;
+  uint32_t agora = to_ms_since_boot(get_absolute_time());
+  if(telemetria_ligada && (int32_t)(agora - proximo_status) >= 0){
+    uint8_t r[TLM_STATUS_LEN], *p = r;
+    *p++ = est.energia;
+    *p++ = est.bomba_ligada | (alerta_tocando << 1) | ((est.flag_rega == 1) << 2);
+    p = tlm_put32(p, telemetria.stats.dropped_frames);
+    p = tlm_put32(p, adc_sampler_core()->skipped);
+    tlm_put32(p, som.dropped);
+    tlm_record(&telemetria, TLM_STATUS, agora, r, TLM_STATUS_LEN);
+    proximo_status = agora + TELEMETRIA_STATUS_MS;
+  }
+  tlm_poll(&telemetria, agora);
+}
+
+// Um pedaço inteiro por chamada, no máximo o espaço livre do FIFO do CDC: o
+// driver USB do stdio faz um só tud_cdc_write e um tud_cdc_write_flush sob o
+// mesmo mutex do printf, sem a tradução de \n, e não chega a esperar. Sem
+// host conectado, nada sai
+size_t usb_escreve(void *ctx, const uint8_t *dados, size_t n){
+  if(!tud_cdc_connected())
+    return 0;
+  uint32_t livre = tud_cdc_write_available();
+  if(n > livre)
+    n = livre;
+  if(n)
+    stdio_usb.out_chars((const char *)dados, (int)n);
+  return n;
+}
+
+// Contadores do dia sobrevivem ao reset: volta ao último estado gravado e, se a
+// rega automática estava armada, retoma a contagem das 24 h de onde parou
+// (o histórico conta tempo de operação; o tempo desligado não entra)
+void restaura_contadores(void){
+  // O perfil da planta vem da última avaliação gravada
+  flashlog_record_t r;
+  if(flashlog_last(FLASHLOG_HEALTH, &r) && r.v[2] >= 0 && r.v[2] < health_profile_count)
+    est.perfil = perfil_gravado = r.v[2];
+
+  if(!flashlog_last(FLASHLOG_COUNTERS, &r))
+    return;
+  est.molhadas = r.v[0];
+  est.cont_molhadas = r.v[1];
+  est.flag_rega = r.v[2];
+  est.tempo_decorrido = (r.v[3] + (flashlog_now() - r.t_s)) * 1000;
+  contadores_gravados[0] = r.v[0];
+  contadores_gravados[1] = r.v[1];
+  contadores_gravados[2] = r.v[2];
+  if(est.cont_molhadas && !timer_rega_ativo){
+    add_repeating_timer_ms(1000, timer_callback, NULL, &timer);
+    timer_rega_ativo = true;
+  }
+}
+
+// Amostra dos sensores por minuto, contadores quando mudam (estes gravados na
+// hora, já que a restauração depende deles), a saúde quando muda a regra
+// violada ou o perfil, e uma operação de
+// flash por execução. É a tarefa de menor prioridade: programar uma página ou
+// apagar o setor à frente nunca atrasa as demais (o apagamento ainda para a
+// XIP dos dois núcleos por dezenas de ms, mas só aqui, com a tela já enviada)
+void tarefa_historico(uint32_t eventos, void *ctx){
+  static uint32_t proxima_amostra = 0;
+  uint32_t agora = flashlog_now();
+  if((int32_t)(agora - proxima_amostra) >= 0 && leitura.lote){
+    flashlog_record_t r = { .type = FLASHLOG_SAMPLE, .v = {
+      (leitura.temp_q8 * 10) >> 8,       // Décimos
+      (leitura.umidade_q8 * 10) >> 8,
+      (leitura.lumi_q8 * 10) >> 8,
+      (leitura.som_q8 * 10) >> 8,
+    } };
+    flashlog_append(&r);
+    proxima_amostra = agora + HISTORICO_AMOSTRA_S;
+  }
+
+  if(est.molhadas != contadores_gravados[0] || est.cont_molhadas != contadores_gravados[1] ||
+     est.flag_rega != contadores_gravados[2]){
+    flashlog_record_t r = { .type = FLASHLOG_COUNTERS, .v = {
+      est.molhadas, est.cont_molhadas, est.flag_rega, (int32_t)(est.tempo_decorrido / 1000),
+    } };
+    if(flashlog_append(&r)){
+      contadores_gravados[0] = est.molhadas;
+      contadores_gravados[1] = est.cont_molhadas;
+      contadores_gravados[2] = est.flag_rega;
+      flashlog_seal();   // Vai para a flash já na próxima execução, sem esperar a página encher
+    }
+  }
+
+  // No ritmo desta tarefa (1 s), e sobre médias de 1 min, a saúde não oscila no histórico
+  if(saude.violated != saude_gravada.violated || est.perfil != perfil_gravado){
+    flashlog_record_t r = { .type = FLASHLOG_HEALTH, .v = { saude.violated, saude.score, est.perfil } };
+    bool troca_perfil = est.perfil != perfil_gravado;
+    if(flashlog_append(&r)){
+      saude_gravada = saude;
+      perfil_gravado = est.perfil;
+      if(troca_perfil)
+        flashlog_seal();   // O perfil é restaurado na partida, como os contadores
+    }
+  }
+
+  flashlog_service();
+}
+
+static void imprime_registro(const flashlog_record_t *r, void *ctx){
+  static const char *const nomes[] = { "?", "amostra", "rega", "contadores", "partida", "saude", "ciclo_rega" };
+  printf("%lu,%s,%ld,%ld,%ld,%ld\n", (unsigned long)r->t_s, nomes[r->type], (long)r->v[0], (long)r->v[1],
+         (long)r->v[2], (long)r->v[3]);
+}
+
+void imprime_historico(uint32_t janela_s){
+  uint32_t agora = flashlog_now();
+  const flashlog_stats_t *st = flashlog_stats();
+  printf("# historico: partida %lu, %lu paginas gravadas, %lu setores apagados, %lu paginas ruins, %lu descartados\n",
+         (unsigned long)st->boots, (unsigned long)st->pages_written, (unsigned long)st->sectors_erased,
+         (unsigned long)st->bad_pages, (unsigned long)st->dropped);
+  printf("t_s,tipo,v0,v1,v2,v3\n");
+  size_t n = flashlog_query(agora > janela_s ? agora - janela_s : 0, agora, imprime_registro, NULL);
+  printf("# %u registros (mais antigo em t=%lu s)\n", (unsigned)n, (unsigned long)st->oldest_t_s);
+}
+
+// Valores em décimos, como no histórico; desvio padrão no lugar da variância
+void imprime_estatisticas(void){
+  static const char *const sensores[] = { "temperatura", "umidade", "luminosidade" };
+  uint32_t agora_s = time_us_64() / 1000000;
+  printf("sensor,janela_s,amostras,min,media,max,desvio\n");
+  for(int i = 0; i < SENSOR_COUNT; i++){
+    for(int j = 0; j < ROLLSTATS_WINDOWS; j++){
+      rollstats_summary_t r;
+      if(!rollstats_get(&tendencias[i], j, agora_s, &r))
+        continue;
+      printf("%s,%lu,%lu,%ld,%ld,%ld,%ld\n", sensores[i], (unsigned long)rollstats_window_s(j),
+             (unsigned long)r.count, (long)((r.min * 10) >> 8), (long)((r.mean * 10) >> 8),
+             (long)((r.max * 10) >> 8), (long)((rollstats_stddev(&r) * 10) >> 8));
+    }
+  }
+}
+
+// Níveis do último bloco em décimos de dBFS (0: seno de escala cheia)
+void imprime_audio(void){
+  printf("som,pico,b31_250,b250_1k,b1k_2k,b2k_4k\n%ld,%ld", (long)(leitura.som_q8 * 10 / 256),
+         (long)(leitura.som_pico_q8 * 10 / 256));
+  for(int i = 0; i < SENSOR_BANDS; i++)
+    printf(",%ld", (long)(leitura.bandas_q8[i] * 10 / 256));
+  printf("\naudio: %lu blocos, %lu descartados, %lu adiados, bloco %lu us (pior %lu us, orcamento %u us)\n",
+         (unsigned long)som.out.blocks, (unsigned long)som.dropped, (unsigned long)audio_adiados,
+         (unsigned long)audio_bloco_us, (unsigned long)audio_pior_us, AUDIO_ORCAMENTO_US);
+}
+
+// Saúde pelas regras do perfil atual, sobre as médias do último minuto (a
+// leitura isolada só até a primeira janela ter amostras)
+void avalia_saude(health_result_t *saude){
+  int32_t valores[SENSOR_COUNT] = { leitura.temp_q8, leitura.umidade_q8, leitura.lumi_q8 };
+  for(int i = 0; i < SENSOR_COUNT; i++){
+    if(resumo[i][ROLLSTATS_1MIN].count)
+      valores[i] = resumo[i][ROLLSTATS_1MIN].mean;
+  }
+  health_evaluate(&health_profiles[est.perfil], valores, saude);
+}
+
+void imprime_saude(void){
+  printf("perfil %s: %s (pontos %u)", health_profiles[est.perfil].name, health_level_name(saude.level),
+         saude.score);
+  for(int i = 0; i < HEALTH_RULE_COUNT; i++){
+    if(saude.violated & (1u << i))
+      printf(", %s", health_rule_name(i));
+  }
+  printf("\n");
+}
+
+// Inicializa o OLED no núcleo 1: a interrupção do DMA do display fica neste núcleo
+static void init_oled(void){
+  ssd1306_init(&ssd, 128, 64, false, endereco, I2C_PORT); // Inicializa o display
+  ssd1306_config(&ssd); // Configura o display
+  ssd1306_dma_init(&ssd); // Quadros passam a ser enviados por DMA, sem travar o loop
+  ssd1306_send_data(&ssd); // Envia os dados para o display
+  compositor_init(&compositor, &ssd);
+
+  // Limpa o display. O display inicia com todos os pixels apagados.
+  ssd1306_fill(&ssd, false);
+  ssd1306_send_data(&ssd);
+  // A partir daqui só as janelas alteradas de cada quadro são enviadas
+  ssd1306_set_flush_mode(&ssd, SSD1306_FLUSH_DIRTY);
+}
+
+// Laço do núcleo 1: pega o estado mais recente e desenha em cadência própria
+// (tela a cada 150 ms, matriz a cada 20 ms), dormindo em WFE entre um e outro
+void nucleo1_main(void){
+  // Este núcleo aceita ser pausado enquanto o núcleo 0 grava a flash. A pausa
+  // combina pela FIFO do SIO e descarta o que não for dela: os avisos ao
+  // núcleo 0 vão por variáveis (sorrisos_feitos, tela_apagada), nunca pela FIFO
+  flash_safe_execute_core_init();
+  init_oled();
+
+  // Alarmes de latch da matriz disparam neste núcleo, junto com quem compõe os quadros
+  alarm_pool_t *alarmes = alarm_pool_create_with_unused_hardware_alarm(4);
+  ws2812b_init(&matriz, pio, sm, LED_COUNT);
+  ws2812b_set_alarm_pool(&matriz, alarmes);
+  led_anim_init(&animacao, &matriz);
+
+  estado_tela_t e = {0};
+  estado_tela_t novo;
+  bool tem_estado = false;
+  uint64_t prox_anim = time_us_64();
+  uint64_t prox_tela = prox_anim;
+
+  while(true){
+    if(spsc_drain_latest(&fila_estados, &novo)){
+      e = novo;
+      tem_estado = true;
+    }
+
+    // Fora do modo ativo: apaga o OLED (a RAM dele guarda o quadro) e a
+    // matriz, avisa o núcleo 0 e só acorda com um estado novo publicado
+    if(tem_estado && e.sis.energia != ENERGIA_ATIVO){
+      if(!tela_apagada){
+        ssd1306_flush_wait(&ssd);
+        ssd1306_command(&ssd, SET_DISP | 0x00);
+        led_anim_stop(&animacao);
+        while(ws2812b_busy(&matriz))
+          tight_loop_contents();
+        tela_apagada = true;
+      }
+      __wfe();
+      continue;
+    }
+    if(tela_apagada){
+      tela_apagada = false;
+      ssd1306_command(&ssd, SET_DISP | 0x01);
+      prox_anim = prox_tela = time_us_64();
+    }
+
+    uint64_t agora = time_us_64();
+    if(agora >= prox_anim){
+      TRACE(TRACE_RENDER_BEGIN, 1);
+      render_animacao(&e);
+      TRACE(TRACE_RENDER_END, 1);
+      prox_anim += 20000;
+      if(prox_anim <= agora)
+        prox_anim = agora + 20000;
+    }
+    if(tem_estado && agora >= prox_tela){
+      TRACE(TRACE_RENDER_BEGIN, 0);
+      render_tela(&ssd, &e);
+      TRACE(TRACE_RENDER_END, 0);
+      uint32_t duracao = time_us_64() - agora;
+      if(duracao > render_pior_us)
+        render_pior_us = duracao;
+      render_quadros++;
+      prox_tela += 150000;
+      if(prox_tela <= agora)
+        prox_tela = agora + 150000;
+    }
+
+    uint64_t prox = prox_anim < prox_tela ? prox_anim : prox_tela;
+    best_effort_wfe_or_timeout(from_us_since_boot(prox));
+  }
+}
+
+// Trata os pedidos de limpeza (botões A e B) antes de desenhar
+void render_tela(ssd1306_t *ssd, const estado_tela_t *e){
+  static uint32_t limpeza_vista = 0;
+
+  if(e->sis.pedidos_limpeza != limpeza_vista){
+    limpeza_vista = e->sis.pedidos_limpeza;
+    compositor_release(&compositor);
+    ssd1306_fill(ssd, false);
+    ssd1306_send_data(ssd);
+  }
+  // Enquanto a animação roda a tela fica apagada, como antes
+  if(e->sis.x){
+    return;
+  }
+  //Exibe a tela inicial
+  tela_inicial(ssd, e);
+}
+
 //Função que controla o teste do joystick
 void teste(ssd1306_t *ssd, uint16_t adc_value_x, uint16_t adc_value_y){
     char buffer[10];  // Buffer para conversão de número em string
@@ -276,154 +1299,114 @@ void teste(ssd1306_t *ssd, uint16_t adc_value_x, uint16_t adc_value_y){
 
 
 
-void tela_inicial(ssd1306_t *ssd, uint8_t ap, uint16_t adc_value_x, uint16_t adc_value_y, uint16_t luminosidade, bool k) {
-    char buffer[10];  // Buffer para conversão de número em string
-
-    //mapeamento dos sensores: adc_x, adc_y e microfone
-    uint8_t pct_temp = 40;
-    uint8_t temp = 32;
-    uint8_t pct_um = 60;
-    uint8_t lumi = 50;
+void tela_inicial(ssd1306_t *ssd, const estado_tela_t *e) {
+    uint8_t ap = e->sis.ap;
+    const sensor_readings_t *leitura = &e->leitura;
+    //mapeamento dos sensores: valores já convertidos pela tarefa de sensores (fixos na tela de teste)
+    int temp = 32;
+    int pct_um = 60;
+    int lumi = 50;
 
     if(ap != 0){
-      pct_temp = (adc_value_x * 100) / 4095;
-      temp = (pct_temp * 64) / 100;
-      pct_um = (100 - ((adc_value_y * 100) / 4095) - 1);
-      lumi = luminosidade/255;
+      temp = Q8_INT(leitura->temp_q8);
+      pct_um = Q8_INT(leitura->umidade_q8);
+      lumi = Q8_INT(leitura->lumi_q8);
     }
 
-    sleep_ms(150);
-    
-    // Como o microfone é impreciso para efeito de demonstração usa-se um valor mínimo de luminosidade para garatnir o funcionamento
-    if(lumi < 50){
-       lumi += 50; 
-    }
-    problemas = 0;
-    
-    //verifica se a umidade não está baixa nem a luminosidade muito alta
-    if((pct_um < 30 && x != 1) || lumi > 80){  
-      uint32_t tempo_atual = to_ms_since_boot(get_absolute_time());
-      lumi_temp(ssd, adc_value_x, adc_value_y, k);
-      if(tempo_atual - tempo_anterior3 > 200){
-        z = !z;
-        tempo_anterior3 = tempo_atual;
-      }
-      play_sound(1000, 500);
-      gpio_put(RED, z);
-      gpio_put(buzzer, z);
+    // Alerta decidido pelo núcleo 0; aqui só o desenho
+    if(e->alerta){
+      compositor_release(&compositor);
+      lumi_temp(ssd, leitura, v);
     }else{
-      gpio_put(RED, 0);
-      gpio_put(buzzer, 0);
-      ssd1306_fill(ssd, false);
-      if (ap == 2)
+      if (ap >= 2 && ap <= 5)
       {
-        ssd1306_draw_string(ssd, "DADOS COLETADOS", 7, 6);
-        ssd1306_vline(ssd, 57, 32, 64, true);
-        ssd1306_rect(ssd, 0, 0, 128, 18, true, false);
-        ssd1306_rect(ssd, 0, 0, 128, 32, true, false);
-        ssd1306_rect(ssd, 0, 0, 128, 64, true, false);
-        ssd1306_draw_string(ssd, "<temperatura>", 14, 21);
-        ssd1306_draw_string(ssd, "ideal:", 7, 34);
-        ssd1306_draw_string(ssd, "20-35c", 63, 34);
-        ssd1306_hline(ssd, 0, 128, 47, true);
-        ssd1306_draw_string(ssd, "atual:", 7, 52);
-
-        sprintf(buffer, "%d", temp); // Converte para string
-        ssd1306_draw_string(ssd, buffer, 63, 52);
-        ssd1306_draw_string(ssd, "c", 80, 52);
-
-        ssd1306_send_data(ssd);
-      }
-      else if (ap == 3)
-      {
-        ssd1306_draw_string(ssd, "DADOS COLETADOS", 7, 6);
-        ssd1306_vline(ssd, 57, 32, 64, true);
-        ssd1306_rect(ssd, 0, 0, 128, 18, true, false);
-        ssd1306_rect(ssd, 0, 0, 128, 64, true, false);
-        ssd1306_rect(ssd, 0, 0, 128, 32, true, false);
-        ssd1306_draw_string(ssd, "<luminosidade>", 10, 21);
-        ssd1306_draw_string(ssd, "ideal:", 7, 34);
-        ssd1306_hline(ssd, 0, 128, 47, true);
-        ssd1306_draw_string(ssd, "50-70%", 63, 34);
-        ssd1306_draw_string(ssd, "atual:", 7, 52);
-        ssd1306_draw_string(ssd, "%", 80, 52);
-
-        sprintf(buffer, "%d", lumi); // Converte para string
-        ssd1306_draw_string(ssd, buffer, 63, 52);
-   
-        
-        //ssd1306_draw_string(ssd, "%", 80, 52);
+        // Telas de dados: o fundo vem do cache e só os valores alterados são redesenhados
+        leituras.temp = temp;
+        leituras.lumi = lumi;
+        leituras.umidade = pct_um;
+        // Saúde já avaliada pelo núcleo 0: aqui só os textos
+        if (ap == 5){
+          leituras.status = health_level_name(e->saude.level);
+          leituras.problema = "";
+          for (int i = 0; i < HEALTH_RULE_COUNT; i++) {
+            if (e->saude.violated & (1u << i)) {
+              leituras.problema = health_rule_name(i);   // A primeira, na ordem das regras
+              break;
+            }
+          }
+          leituras.perfil = health_profiles[e->sis.perfil].name;
+        }
+        compositor_show(&compositor, &telas_dados[ap - 2]);
         ssd1306_send_data(ssd);
       }
-      else if (ap == 4)
+      else
       {
-        ssd1306_draw_string(ssd, "DADOS COLETADOS", 7, 6);
-        ssd1306_rect(ssd, 0, 0, 128, 18, true, false);
-        ssd1306_vline(ssd, 57, 32, 64, true);
-        ssd1306_rect(ssd, 0, 0, 128, 64, true, false);
-        ssd1306_rect(ssd, 0, 0, 128, 32, true, false);
-        ssd1306_draw_string(ssd, "<umidade>", 26, 21);
-        ssd1306_draw_string(ssd, "ideal:", 6, 34);
-        ssd1306_draw_string(ssd, "atual:", 7, 52);
-        ssd1306_draw_string(ssd, "20-30%", 63, 34);
-        ssd1306_hline(ssd, 0, 128, 47, true);
-
-        sprintf(buffer, "%d", pct_um); // Converte para string
-        ssd1306_draw_string(ssd, buffer, 63, 52);
-        ssd1306_draw_string(ssd, "%", 80, 52);
-        ssd1306_send_data(ssd);
-      }else if(ap == 5){
-        ssd1306_draw_string(ssd, "PAINEL DE SAUDE", 3, 6);
-        ssd1306_rect(ssd, 0, 0, 128, 18, true, false);
-        ssd1306_rect(ssd, 0, 0, 128, 64, true, false);
-        const char* status_saude = avaliarSaude(lumi, temp, pct_um);
-        // Exibe o status da saúde da planta
-        ssd1306_draw_string(ssd, "Status:", 10, 25);
-        ssd1306_draw_string(ssd, status_saude, 10, 34);
-        ssd1306_send_data(ssd);
-      }else if(ap == 1){
-        ssd1306_draw_string(ssd, "REGA AUTOMATICA", 3, 6);
-        ssd1306_draw_string(ssd, "ON", 32, 34);
-        ssd1306_draw_string(ssd, "OFF", 78, 34);
-        if(adc_value_x > 3080){
-          flag = true;
-        }else if(adc_value_x < 1000){
-          flag = false;
-        }else{
-          if(flag){
-            ssd1306_rect(ssd, 25, 74, 30, 22, true, false);
-          }else{
-            ssd1306_rect(ssd, 25, 24, 30, 22, true, false);
+        compositor_release(&compositor);
+        ssd1306_fill(ssd, false);
+        if(ap == 1){
+          ssd1306_draw_string(ssd, "REGA AUTOMATICA", 3, 6);
+          ssd1306_draw_string(ssd, "ON", 32, 34);
+          ssd1306_draw_string(ssd, "OFF", 78, 34);
+          // Fora das zonas de troca, marca a opção atual
+          if(!e->sel_on && !e->sel_off){
+            if(e->sis.flag){
+              ssd1306_rect(ssd, 25, 74, 30, 22, true, false);
+            }else{
+              ssd1306_rect(ssd, 25, 24, 30, 22, true, false);
+            }
           }
+          // Situação do controlador (falhas esperam o SW)
+          if(e->sis.rega_estado == IRRIGATION_FAULT_DRY){
+            ssd1306_draw_string(ssd, "SEM AGUA", 32, 52);
+          }else if(e->sis.rega_estado == IRRIGATION_FAULT_OVERFLOW){
+            ssd1306_draw_string(ssd, "TRANSBORDO", 24, 52);
+          }else if(e->sis.rega_estado != IRRIGATION_IDLE){
+            ssd1306_draw_string(ssd, "regando", 36, 52);
+          }
+          
+          ssd1306_send_data(ssd);
+        }else if(ap == 6){
+          ssd1306_fill(ssd, false);
+          ssd1306_send_data(ssd);
+        }else if(ap == 7){
+          tela_tendencias(ssd, e);
+        }else if(ap == 0){
+          teste(ssd, e->adc_x, e->adc_y);
         }
-        
-        ssd1306_send_data(ssd);
-      }else if(ap == 6){
-        ssd1306_fill(ssd, false);
-        ssd1306_send_data(ssd);
-      }else if(ap == 0){
-        teste(ssd,adc_value_x, adc_value_y);
       }
     }
 }
 
-void rega_automatica(int adc_value_x, int adc_value_y, int molhada){
-  uint8_t pct_temp = (adc_value_x * 100) / 4095;
-  uint8_t temp = (pct_temp * 64) / 100;
-  uint8_t umi = (100 - ((adc_value_y * 100) / 4095) - 1);
-  uint8_t lumi = 17;   // parametro pré definido como 17 para simular um horário favorável ex: 8h da manhã
-  if(molhada == 1 && flag == false && flag_rega == 1){
-    if(umi){  // verifica se a umidade não está no mínimo
-      if(lumi >= 15 && lumi <= 20){ //presumindo que a planta esteja em um local pouco insolarado as 8h
-        if(temp < 25){  //evita molhar quando estiver quente
-          gpio_put(BLUE, 1);
-          sleep_ms(4000);
-          gpio_put(BLUE, 0);
-          flag_rega = 0;
-        }
-      }
+// Mínimo, média e máximo de cada sensor na janela escolhida com o botão A; o
+// sinal no fim compara a média do último minuto com a da última hora
+void tela_tendencias(ssd1306_t *ssd, const estado_tela_t *e){
+  static const char *const janelas[] = { "1 min", "1 h", "24 h" };
+  static const char rotulos[SENSOR_COUNT] = { 'T', 'U', 'L' };
+  char buffer[40];   // Pior caso: três int de 11 caracteres
+  uint8_t j = e->sis.janela_tendencia;
+
+  ssd1306_rect(ssd, 0, 0, 128, 64, true, false);
+  snprintf(buffer, sizeof buffer, "TENDENCIA %s", janelas[j]);
+  ssd1306_draw_string(ssd, buffer, 3, 4);
+  ssd1306_hline(ssd, 0, 127, 14, true);
+  ssd1306_draw_string(ssd, "  min med max", 4, 18);
+  for(int i = 0; i < SENSOR_COUNT; i++){
+    const rollstats_summary_t *r = &e->resumo[i][j];
+    const rollstats_summary_t *m = &e->resumo[i][ROLLSTATS_1MIN];
+    const rollstats_summary_t *h = &e->resumo[i][ROLLSTATS_1H];
+    if(!r->count){
+      snprintf(buffer, sizeof buffer, "%c  --  --  --", rotulos[i]);
+    }else{
+      char sinal = '=';
+      if(m->count && h->count && m->mean - h->mean > Q8(1))
+        sinal = '+';
+      else if(m->count && h->count && h->mean - m->mean > Q8(1))
+        sinal = '-';
+      snprintf(buffer, sizeof buffer, "%c%4d%4d%4d %c", rotulos[i], Q8_INT(r->min), Q8_INT(r->mean), Q8_INT(r->max), sinal);
     }
+    ssd1306_draw_string(ssd, buffer, 4, 28 + 10 * i);
   }
+  ssd1306_send_data(ssd);
 }
 
 // Desenho da árvore
@@ -493,69 +1476,23 @@ void draw_tree(ssd1306_t *ssd) {
 // Inicializa os dipositivos
 void init_disp(){
   // inicialização 
-  gpio_init(btnA);
-  gpio_init(btnB);
   gpio_init(RED);
   gpio_init(VERDE);
   gpio_init(BLUE);
-  gpio_init(buzzer);
-  gpio_init(sw);
 
-  // Setando a direção
-  gpio_set_dir(btnA, GPIO_IN);
-  gpio_set_dir(btnB, GPIO_IN);
-  gpio_set_dir(sw, GPIO_IN);
+  // Setando a direção (os botões são configurados pelo lib/input)
   gpio_set_dir(RED, GPIO_OUT);
   gpio_set_dir(VERDE, GPIO_OUT);
   gpio_set_dir(BLUE, GPIO_OUT);
-  gpio_set_dir(buzzer, GPIO_OUT);
 
-  gpio_pull_up(btnA);
-  gpio_pull_up(btnB);
-  gpio_pull_up(sw);
-
-  gpio_put(buzzer, 0);
-}
-
-// Função para avaliar a saúde da planta
-const char* avaliarSaude(int luz, int temp, int umidade) {
-  
-  
-  if (luz < LUZ_MIN) {
-      problemas++;
-  } else if (luz > LUZ_MAX) {
-      problemas++;
-  }
-  
-  if (temp < TEMP_MIN) {
-      problemas++;
-  } else if (temp > TEMP_MAX) {
-      problemas++;
-  }
-  
-  if (umidade < UMIDADE_MIN) {
-      problemas++;
-  } else if (umidade > UMIDADE_MAX) {
-      problemas++;
-  }
-  // conta a quantidade de problemas, isto é, parametros fora da margem idela e retorna um status de saúde
-  if (problemas == 0) {
-      return "saudavel";
-  } else if (problemas == 1) {
-      return "leve estresse";
-  } else if (problemas == 2) {
-      return "medio estresse";
-  } else {
-      return "grave estresse";
-  }
+  tone_init(buzzer); // Buzzer passa a ser um canal PWM, começa em silêncio
 }
 
-void lumi_temp(ssd1306_t *ssd, uint16_t adc_value_x, uint16_t adc_value_y, bool v){
+void lumi_temp(ssd1306_t *ssd, const sensor_readings_t *leitura, bool v){
   
-  uint8_t pct_temp = (adc_value_x * 100) / 4095;
-  uint8_t pct_um = (100 - ((adc_value_y * 100) / 4095));
+  int pct_um = Q8_INT(leitura->umidade_q8);
 
-  if(pct_um < 10 ){
+  if(hyst_update(&umidade_critica, pct_um)){
     regar(ssd, v);
   }
 }
@@ -567,88 +1504,80 @@ void init_ADC(){
   adc_gpio_init(JOYSTICK_Y_PIN);  
 }
 
-// Emite um som de alerma em situações críticas, exemplo: Luminosidade alta ou a quando a planta estiver com sede.
-void play_sound(uint frequency, uint duration_ms) {
-  uint delay = 1000000 / (2 * frequency); // Calcula o atraso (microsegundos) para a frequência
-  uint cycles = frequency * duration_ms / 1000; // Número de ciclos para a duração
-
-  for (uint i = 0; i < cycles; i++) {
-      gpio_put(buzzer, 1); // Liga o buzzer
-      sleep_us(delay);         // Espera metade do período
-      gpio_put(buzzer, 0); // Desliga o buzzer
-      sleep_us(delay);         // Espera a outra metade
-  }
-}
-
-// Estrutura com os dados de cor e luminozidade para um led
-typedef struct{
-  uint8_t R;
-  uint8_t G;
-  uint8_t B;
-} led;
-
-// Array que armazena os dados dos 25 leds
-led matriz_led[LED_COUNT]; 
-
-// Função que junta 3 bytes com informações de cores e mais 1 byte vazio para temporização
-uint32_t valor_rgb(uint8_t B, uint8_t R, uint8_t G){
-return (G << 24) | (R << 16) | (B << 8);
+// Acende um LED e agenda o desligamento, no lugar de gpio_put + sleep_ms
+int64_t apaga_led_callback(alarm_id_t id, void *user_data) {
+  gpio_put((uint)(uintptr_t)user_data, 0);
+  return 0;
 }
 
-// Função que configura um led específico
-void set_led(uint8_t indice, uint8_t r, uint8_t g, uint8_t b){
-  if(indice < 25){
-  matriz_led[indice].R = r;
-  matriz_led[indice].G = g;
-  matriz_led[indice].B = b;
-  }
+void pulso_led(uint gpio, uint32_t duracao_ms) {
+  gpio_put(gpio, 1);
+  add_alarm_in_ms(duracao_ms, apaga_led_callback, (void *)(uintptr_t)gpio, true);
 }
 
-// Função de limpar o array de leds
-void clear_leds(){
-  for(uint8_t i = 0; i < LED_COUNT; i++){
-      matriz_led[i].R = 0;
-      matriz_led[i].B = 0;
-      matriz_led[i].G = 0;
-  }
+// Animações da matriz em quadros-chave (índices dos LEDs da matriz 5x5)
+#define OLHOS (ANIM_LED(18) | ANIM_LED(16))
+#define SORRISO (ANIM_LED(9) | ANIM_LED(1) | ANIM_LED(2) | ANIM_LED(3) | ANIM_LED(5))
+#define BORDA (ANIM_ROW(0) | ANIM_ROW(4) | ANIM_LED(5) | ANIM_LED(9) | ANIM_LED(10) | ANIM_LED(14) | ANIM_LED(15) | ANIM_LED(19))
+#define VERDE_SORRISO 166   // Depois da gama fica perto do nível 100 usado antes
+
+const anim_key_t chaves_sorriso[] = {
+  ANIM_KEY(OLHOS, 0, VERDE_SORRISO, 0, 80, 500),                    // Acende os olhos
+  ANIM_KEY(OLHOS | ANIM_LED(9), 0, VERDE_SORRISO, 0, 60, 100),      // Acende o sorriso progressivamente
+  ANIM_KEY(OLHOS | ANIM_LED(9) | ANIM_LED(1), 0, VERDE_SORRISO, 0, 60, 100),
+  ANIM_KEY(OLHOS | ANIM_LED(9) | ANIM_LED(1) | ANIM_LED(2), 0, VERDE_SORRISO, 0, 60, 100),
+  ANIM_KEY(OLHOS | ANIM_LED(9) | ANIM_LED(1) | ANIM_LED(2) | ANIM_LED(3), 0, VERDE_SORRISO, 0, 60, 100),
+  ANIM_KEY(OLHOS | SORRISO, 0, VERDE_SORRISO, 0, 60, 1100),
+  ANIM_KEY(ANIM_LED(16) | SORRISO, 0, VERDE_SORRISO, 0, 80, 700),   // Pisca o olho direito
+  ANIM_KEY(OLHOS | SORRISO, 0, VERDE_SORRISO, 0, 80, 500),
+};
+
+// Alerta: borda vermelha pulsando no ritmo dos bipes
+const anim_key_t chaves_alerta[] = {
+  ANIM_KEY(BORDA, 200, 0, 0, 100, 200),
+  ANIM_KEY(0, 0, 0, 0, 100, 200),
+};
+
+// Rega: água azul subindo linha a linha enquanto a bomba estiver ligada
+const anim_key_t chaves_rega[] = {
+  ANIM_KEY(ANIM_ROW(0), 0, 0, 200, 150, 300),
+  ANIM_KEY(ANIM_ROW(0) | ANIM_ROW(1), 0, 0, 200, 150, 300),
+  ANIM_KEY(ANIM_ROW(0) | ANIM_ROW(1) | ANIM_ROW(2), 0, 0, 200, 150, 300),
+  ANIM_KEY(ANIM_ROW(0) | ANIM_ROW(1) | ANIM_ROW(2) | ANIM_ROW(3), 0, 0, 200, 150, 300),
+  ANIM_KEY(ANIM_ALL, 0, 0, 200, 150, 300),
+  ANIM_KEY(0, 0, 0, 0, 300, 400),
+};
+
+const anim_clip_t clipe_sorriso = ANIM_CLIP(chaves_sorriso, false);
+const anim_clip_t clipe_alerta = ANIM_CLIP(chaves_alerta, true);
+const anim_clip_t clipe_rega = ANIM_CLIP(chaves_rega, true);
+
+// Fim do sorriso: avisa o núcleo 0, dono do estado das telas. Um contador e
+// não uma mensagem: o aviso não se perde nem espera espaço numa fila
+void sorriso_terminou(const anim_clip_t *clip, void *user) {
+  sorrisos_feitos++;
 }
 
-// Função que envia os dados do array para os leds via PIO
-void print_leds(PIO pio, uint sm){
-  uint32_t valor;
-  for(uint8_t i = 0; i < LED_COUNT; i++){
-      valor = valor_rgb(matriz_led[i].B, matriz_led[i].R,matriz_led[i].G);
-      pio_sm_put_blocking(pio, sm, valor);
+// Avança a animação a cada tick; o sorriso tem prioridade, e fora dele a matriz
+// mostra o estado do sistema (alerta antes da rega)
+void render_animacao(const estado_tela_t *e) {
+  static uint32_t sorriso_visto = 0;
+  if (e->sis.pedidos_sorriso != sorriso_visto) {
+    sorriso_visto = e->sis.pedidos_sorriso;
+    if (led_anim_playing(&animacao) != &clipe_sorriso)
+      led_anim_play(&animacao, &clipe_sorriso, sorriso_terminou, NULL);
   }
-}
 
-void smile_face(ssd1306_t *ssd, PIO pio, uint sm) {
-  molhadas++;
-  sleep_ms(10);
-  // Acende os olhos
-  set_led(18, 0, 100, 0); 
-  set_led(16, 0, 100, 0); 
-  print_leds(pio, sm);
-  sleep_ms(500); 
-  // Acende o sorriso progressivamente
-  int smile[5] = {9, 1, 2, 3, 5};
-  for(int i = 0; i < 5; i++) {
-      set_led(smile[i], 0, 100, 0);
-      print_leds(pio, sm);
-      sleep_ms(100); 
+  const anim_clip_t *atual = led_anim_playing(&animacao);
+  if (atual != &clipe_sorriso) {
+    const anim_clip_t *fundo = e->alerta ? &clipe_alerta : (e->sis.bomba_ligada ? &clipe_rega : NULL);
+    if (fundo != atual) {
+      if (fundo)
+        led_anim_play(&animacao, fundo, NULL, NULL);
+      else
+        led_anim_stop(&animacao);
+    }
   }
-  sleep_ms(1000); 
-  // Pisca o olho direito
-  set_led(18, 0, 0, 0); 
-  print_leds(pio, sm);
-  sleep_ms(700); 
-  set_led(18, 0, 100, 0); 
-  print_leds(pio, sm);
-
-  sleep_ms(500);
-  clear_leds();
-  print_leds(pio, sm);
 
-  ap = 1;
-  x = 0;
-}
\ No newline at end of file
+  led_anim_tick(&animacao, to_ms_since_boot(get_absolute_time()));
+}
@@ -0,0 +1,195 @@
+#include <stdlib.h>
+#include <string.h>
+#include "bench.h"
+
+#if PICO_ON_DEVICE
+#include "hardware/clocks.h"
+#include "hardware/timer.h"
+#include "hardware/structs/systick.h"
+#else
+#include <time.h>
+#endif
+
+// ---------------------------------------------------------------------------
+// Relógio
+// ---------------------------------------------------------------------------
+
+#if PICO_ON_DEVICE
+
+static uint32_t cycles_per_us;
+
+// SysTick livre, contando para baixo no clock do processador
+void bench_clock_init(void) {
+  systick_hw->csr = 0;
+  systick_hw->rvr = 0x00FFFFFF;
+  systick_hw->cvr = 0;
+  systick_hw->csr = 0x5;   // ENABLE | CLKSOURCE (clk_sys)
+  cycles_per_us = clock_get_hz(clk_sys) / 1000000;
+}
+
+bench_stamp_t bench_stamp(void) {
+  bench_stamp_t s = { systick_hw->cvr, time_us_64() };
+  return s;
+}
+
+// O SysTick dá a volta a cada 2^24 ciclos (131 ms a 128 MHz): em medidas
+// longas vale o timer de 1 us, convertido para ciclos
+uint32_t bench_elapsed(bench_stamp_t start) {
+  uint32_t now = systick_hw->cvr;
+  uint64_t us = time_us_64() - start.us;
+  if (us * cycles_per_us >= 0x00800000)
+    return us * cycles_per_us > UINT32_MAX ? UINT32_MAX : (uint32_t)(us * cycles_per_us);
+  return (start.tick - now) & 0x00FFFFFF;
+}
+
+#else
+
+void bench_clock_init(void) {}
+
+bench_stamp_t bench_stamp(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  bench_stamp_t s = { (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec };
+  return s;
+}
+
+uint32_t bench_elapsed(bench_stamp_t start) {
+  uint64_t ns = bench_stamp().ns - start.ns;
+  return ns > UINT32_MAX ? UINT32_MAX : (uint32_t)ns;
+}
+
+#endif
+
+// ---------------------------------------------------------------------------
+// Amostras e percentis
+// ---------------------------------------------------------------------------
+
+void bench_case_begin(bench_case_t *c, const char *name) {
+  c->name = name;
+  c->n = 0;
+  c->flushes = c->bytes = c->crc = 0;
+}
+
+void bench_case_add(bench_case_t *c, uint32_t sample) {
+  if (c->n < BENCH_MAX_SAMPLES)
+    c->samples[c->n++] = sample;
+}
+
+static int cmp_u32(const void *a, const void *b) {
+  uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+  return x < y ? -1 : x > y;
+}
+
+// Percentis pelo posto mais próximo sobre uma cópia ordenada
+void bench_case_summary(const bench_case_t *c, bench_summary_t *s) {
+  memset(s, 0, sizeof(*s));
+  if (!c->n)
+    return;
+  static uint32_t sorted[BENCH_MAX_SAMPLES];
+  memcpy(sorted, c->samples, c->n * sizeof(uint32_t));
+  qsort(sorted, c->n, sizeof(uint32_t), cmp_u32);
+  uint64_t sum = 0;
+  for (uint32_t i = 0; i < c->n; ++i)
+    sum += sorted[i];
+  s->min = sorted[0];
+  s->max = sorted[c->n - 1];
+  s->p50 = sorted[(c->n - 1) * 50 / 100];
+  s->p90 = sorted[(c->n - 1) * 90 / 100];
+  s->p99 = sorted[(c->n - 1) * 99 / 100];
+  s->mean = (uint32_t)(sum / c->n);
+}
+
+// CRC-32 (polinômio refletido 0xEDB88320), bit a bit: só roda fora da medida
+uint32_t bench_crc32(const uint8_t *data, size_t len) {
+  uint32_t crc = 0xFFFFFFFFu;
+  for (size_t i = 0; i < len; ++i) {
+    crc ^= data[i];
+    for (int b = 0; b < 8; ++b)
+      crc = (crc >> 1) ^ (0xEDB88320u & -(crc & 1));
+  }
+  return ~crc;
+}
+
+// ---------------------------------------------------------------------------
+// Saída
+// ---------------------------------------------------------------------------
+
+void bench_write_header(FILE *f, uint32_t clk_hz) {
+  fprintf(f, "# bitdog_bench unidade=%s clk_sys=%lu\n", BENCH_UNIT, (unsigned long)clk_hz);
+  fprintf(f, "caso,n,min,p50,p90,p99,max,media,envios,bytes_por_envio,crc\n");
+}
+
+void bench_write_case(FILE *f, const bench_case_t *c) {
+  bench_summary_t s;
+  bench_case_summary(c, &s);
+  fprintf(f, "%s,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%08lx\n", c->name, (unsigned long)c->n,
+          (unsigned long)s.min, (unsigned long)s.p50, (unsigned long)s.p90, (unsigned long)s.p99,
+          (unsigned long)s.max, (unsigned long)s.mean, (unsigned long)c->flushes,
+          (unsigned long)(c->flushes ? c->bytes / c->flushes : 0), (unsigned long)c->crc);
+}
+
+#if !PICO_ON_DEVICE
+
+#define BENCH_MAX_CASES 64
+
+typedef struct {
+  char name[32];
+  unsigned long p50, bytes, crc;
+} bench_row_t;
+
+// Lê as linhas de dados de uma saída; ignora comentários, cabeçalho e lixo
+// (a saída do RP2040 chega pelo USB misturada com outras mensagens)
+static size_t bench_read(const char *path, bench_row_t *rows) {
+  FILE *f = fopen(path, "r");
+  if (!f) {
+    fprintf(stderr, "bench: nao abriu %s\n", path);
+    return 0;
+  }
+  char line[256];
+  size_t n = 0;
+  while (n < BENCH_MAX_CASES && fgets(line, sizeof(line), f)) {
+    unsigned long v[9];
+    bench_row_t *r = &rows[n];
+    if (sscanf(line, "%31[^,],%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lx", r->name, &v[0], &v[1], &v[2],
+               &v[3], &v[4], &v[5], &v[6], &v[7], &r->bytes, &r->crc) != 11)
+      continue;
+    r->p50 = v[2];
+    n++;
+  }
+  fclose(f);
+  return n;
+}
+
+bool bench_compare(const char *base_path, const char *new_path, unsigned limit_pct) {
+  static bench_row_t base[BENCH_MAX_CASES], cur[BENCH_MAX_CASES];
+  size_t nb = bench_read(base_path, base);
+  size_t nc = bench_read(new_path, cur);
+  if (!nb || !nc)
+    return false;
+
+  bool ok = true;
+  printf("%-22s %10s %10s %8s %10s %s\n", "caso", "p50 base", "p50 novo", "delta", "bytes", "desenho");
+  for (size_t i = 0; i < nc; ++i) {
+    const bench_row_t *c = &cur[i];
+    const bench_row_t *b = NULL;
+    for (size_t j = 0; j < nb && !b; ++j)
+      if (!strcmp(base[j].name, c->name))
+        b = &base[j];
+    if (!b) {
+      printf("%-22s %10s %10lu %8s %10lu novo\n", c->name, "-", c->p50, "-", c->bytes);
+      continue;
+    }
+    double delta = b->p50 ? 100.0 * ((double)c->p50 - (double)b->p50) / (double)b->p50 : 0;
+    bool slower = delta > (double)limit_pct;
+    bool bytes_changed = c->bytes != b->bytes;
+    bool drawing_changed = c->crc != b->crc;
+    printf("%-22s %10lu %10lu %+7.1f%% %10lu %s%s%s\n", c->name, b->p50, c->p50, delta, c->bytes,
+           drawing_changed ? "DIFERENTE" : "igual", bytes_changed ? " (bytes mudaram)" : "",
+           slower ? " (mais lento)" : "");
+    if (slower || bytes_changed || drawing_changed)
+      ok = false;
+  }
+  return ok;
+}
+
+#endif
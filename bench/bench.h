@@ -0,0 +1,59 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include "pico.h"
+
+// Amostras guardadas por caso (as excedentes são descartadas)
+#define BENCH_MAX_SAMPLES 512
+
+// Relógio do benchmark: ciclos do SysTick no RP2040, nanossegundos no PC
+#if PICO_ON_DEVICE
+#define BENCH_UNIT "ciclos"
+typedef struct {
+  uint32_t tick;
+  uint64_t us;
+} bench_stamp_t;
+#else
+#define BENCH_UNIT "ns"
+typedef struct {
+  uint64_t ns;
+} bench_stamp_t;
+#endif
+
+typedef struct {
+  const char *name;
+  uint32_t samples[BENCH_MAX_SAMPLES];
+  uint32_t n;
+  uint32_t flushes;        // Envios ao display durante o caso
+  uint32_t bytes;          // Bytes postos no barramento nesses envios
+  uint32_t crc;            // CRC-32 do quadro ao fim: muda se o desenho mudou
+} bench_case_t;
+
+typedef struct {
+  uint32_t min, p50, p90, p99, max, mean;
+} bench_summary_t;
+
+void bench_clock_init(void);
+bench_stamp_t bench_stamp(void);
+uint32_t bench_elapsed(bench_stamp_t start);
+
+void bench_case_begin(bench_case_t *c, const char *name);
+void bench_case_add(bench_case_t *c, uint32_t sample);
+void bench_case_summary(const bench_case_t *c, bench_summary_t *s);
+uint32_t bench_crc32(const uint8_t *data, size_t len);
+
+// Saída em CSV, uma linha por caso; linhas com '#' são comentários
+void bench_write_header(FILE *f, uint32_t clk_hz);
+void bench_write_case(FILE *f, const bench_case_t *c);
+
+#if !PICO_ON_DEVICE
+// Compara duas saídas (a de referência e a nova). Retorna false se algum caso
+// mudou de desenho (CRC), de bytes enviados ou piorou a mediana além de limit_pct
+bool bench_compare(const char *base_path, const char *new_path, unsigned limit_pct);
+#endif
+
+#endif
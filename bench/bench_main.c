@@ -0,0 +1,233 @@
+#include <string.h>
+#include "bench.h"
+
+// O firmware é um arquivo só: incluí-lo dá acesso às telas, ao display e aos
+// tipos de estado sem exportar nada. A main dele é renomeada e não roda aqui.
+#define main firmware_main
+#include "Projeto_Integrado.c"
+#undef main
+
+#if !PICO_ON_DEVICE
+#include <getopt.h>
+#include "sim.h"
+#endif
+
+// ---------------------------------------------------------------------------
+// Casos: primitivas de desenho, caminhos de envio e as telas do firmware
+// ---------------------------------------------------------------------------
+
+typedef struct {
+  const char *name;
+  void (*prep)(uint32_t i);     // Fora da medida: prepara a iteração i
+  void (*op)(uint32_t i);       // Medido
+  int8_t ap;                    // Tela (telas apenas; -1 nas primitivas)
+  bool alerta;
+} bench_def_t;
+
+static uint32_t iteracoes = 200;
+static bench_case_t casos[24];
+static size_t n_casos;
+
+static estado_tela_t tela;
+static const bench_def_t *caso_atual;
+
+static void op_vazio(uint32_t i) {}
+static void op_fill(uint32_t i) { ssd1306_fill(&ssd, i & 1); }
+static void op_rect_borda(uint32_t i) { ssd1306_rect(&ssd, 0, 0, 128, 64, true, false); }
+static void op_rect_cheio(uint32_t i) { ssd1306_rect(&ssd, 8, 16, 64, 40, i & 1, true); }
+static void op_string(uint32_t i) { ssd1306_draw_string(&ssd, "DADOS COLETADOS", 7, 6); }
+static void op_line(uint32_t i) { ssd1306_line(&ssd, 0, (i * 7) & 63, 127, 63 - ((i * 7) & 63), true); }
+static void op_envio(uint32_t i) { ssd1306_send_data(&ssd); }
+
+static void prep_envio_cheio(uint32_t i) {
+  ssd1306_set_flush_mode(&ssd, SSD1306_FLUSH_FULL);
+  ssd1306_fill(&ssd, i & 1);
+}
+
+// Um campo de dois dígitos muda a cada quadro, como nas telas de dados
+static void prep_envio_parcial(uint32_t i) {
+  char buffer[4];
+  ssd1306_set_flush_mode(&ssd, SSD1306_FLUSH_DIRTY);
+  sprintf(buffer, "%02u", (unsigned)(i % 100));
+  ssd1306_draw_string(&ssd, buffer, 63, 52);
+}
+
+// Estado da tela: as leituras mudam a cada 4 quadros, então parte dos quadros
+// redesenha campos e parte sai sem nada para enviar, como no firmware
+static void prep_tela(uint32_t i) {
+  uint32_t k = i / 4;
+  memset(&tela, 0, sizeof(tela));
+  tela.sis.ap = caso_atual->ap;
+  tela.sis.flag = (i / 16) & 1;
+  tela.alerta = caso_atual->alerta;
+  tela.adc_x = (i * 97) % 4096;
+  tela.adc_y = (i * 53) % 4096;
+  tela.leitura.temp_q8 = Q8(20 + k % 15);
+  tela.leitura.umidade_q8 = caso_atual->alerta ? Q8(5) : Q8(20 + k % 30);
+  tela.leitura.lumi_q8 = Q8(50 + k % 20);
+  cont2 = 0;   // Tela de teste já fora da contagem regressiva
+  // Resumos das janelas em torno da leitura atual, para a saúde e as tendências
+  tela.sis.janela_tendencia = k % ROLLSTATS_WINDOWS;
+  const int32_t atual[SENSOR_COUNT] = { tela.leitura.temp_q8, tela.leitura.umidade_q8, tela.leitura.lumi_q8 };
+  for (int s = 0; s < SENSOR_COUNT; ++s)
+    for (int j = 0; j < ROLLSTATS_WINDOWS; ++j)
+      tela.resumo[s][j] = (rollstats_summary_t){ 100, atual[s] - Q8(3 + j), atual[s] + Q8(4 + j), atual[s] - Q8(j), Q8(2) * Q8(2) };
+  tela.sis.perfil = k % health_profile_count;
+  health_evaluate(&health_profiles[tela.sis.perfil], atual, &tela.saude);
+}
+
+static void op_tela(uint32_t i) { tela_inicial(&ssd, &tela); }
+
+static const bench_def_t suite[] = {
+  { "relogio",        NULL,               op_vazio,      -1, false },
+  { "fill",           NULL,               op_fill,       -1, false },
+  { "rect_borda",     NULL,               op_rect_borda, -1, false },
+  { "rect_cheio",     NULL,               op_rect_cheio, -1, false },
+  { "draw_string",    NULL,               op_string,     -1, false },
+  { "line",           NULL,               op_line,       -1, false },
+  { "envio_cheio",    prep_envio_cheio,   op_envio,      -1, false },
+  { "envio_parcial",  prep_envio_parcial, op_envio,      -1, false },
+  { "tela_0",         prep_tela,          op_tela,        0, false },
+  { "tela_1",         prep_tela,          op_tela,        1, false },
+  { "tela_2",         prep_tela,          op_tela,        2, false },
+  { "tela_3",         prep_tela,          op_tela,        3, false },
+  { "tela_4",         prep_tela,          op_tela,        4, false },
+  { "tela_5",         prep_tela,          op_tela,        5, false },
+  { "tela_6",         prep_tela,          op_tela,        6, false },
+  { "tela_7",         prep_tela,          op_tela,        7, false },
+  { "tela_alerta",    prep_tela,          op_tela,        2, true },
+};
+
+// Cada tela começa como no firmware ao trocar de tela: cache liberado e display limpo
+static void entra_na_tela(void) {
+  compositor_release(&compositor);
+  ssd1306_set_flush_mode(&ssd, SSD1306_FLUSH_DIRTY);
+  ssd1306_fill(&ssd, false);
+  ssd1306_send_data(&ssd);
+  ssd1306_flush_wait(&ssd);
+}
+
+static void roda_caso(const bench_def_t *d) {
+  bench_case_t *c = &casos[n_casos++];
+  bench_case_begin(c, d->name);
+  caso_atual = d;
+  if (d->ap >= 0)
+    entra_na_tela();
+  uint32_t envios = ssd.flushes;
+  uint32_t bytes = ssd.flush_bytes;
+
+  for (uint32_t i = 0; i < iteracoes; ++i) {
+    if (d->prep)
+      d->prep(i);
+    bench_stamp_t t = bench_stamp();
+    d->op(i);
+    bench_case_add(c, bench_elapsed(t));
+    // O DMA termina fora da medida: a próxima iteração não espera pela anterior
+    ssd1306_flush_wait(&ssd);
+  }
+  c->flushes = ssd.flushes - envios;
+  c->bytes = ssd.flush_bytes - bytes;
+  c->crc = bench_crc32(ssd.ram_buffer, ssd.bufsize);
+}
+
+// Mesma preparação do display que o firmware faz no boot
+static void roda_suite(void) {
+  i2c_init(I2C_PORT, 400 * 1000);
+  gpio_set_function(I2C_SDA, GPIO_FUNC_I2C);
+  gpio_set_function(I2C_SCL, GPIO_FUNC_I2C);
+  gpio_pull_up(I2C_SDA);
+  gpio_pull_up(I2C_SCL);
+  init_oled();
+  bench_clock_init();
+
+  n_casos = 0;
+  for (size_t k = 0; k < sizeof(suite) / sizeof(suite[0]); ++k)
+    roda_caso(&suite[k]);
+}
+
+static void escreve(FILE *f) {
+  bench_write_header(f, clock_get_hz(clk_sys));
+  for (size_t k = 0; k < n_casos; ++k)
+    bench_write_case(f, &casos[k]);
+}
+
+#if PICO_ON_DEVICE
+
+// No RP2040 o resultado sai pelo USB; copie as linhas para um arquivo e
+// compare no PC com: bitdog_bench -C base.csv novo.csv
+int main() {
+  set_sys_clock_khz(128000, false);   // Mesmo clock do firmware
+  stdio_init_all();
+  sleep_ms(3000);                     // Tempo para o monitor serial conectar
+  roda_suite();
+  escreve(stdout);
+  while (true)
+    sleep_ms(1000);
+}
+
+#else
+
+static void nucleo0(void) {
+  set_sys_clock_khz(128000, false);
+  roda_suite();
+}
+
+static void uso(const char *prog) {
+  fprintf(stderr,
+          "uso: %s [-n iteracoes] [-o saida.csv] [-c base.csv] [-l limite_pct]\n"
+          "     %s -C base.csv novo.csv [-l limite_pct]\n"
+          "  -c  compara o resultado com uma execução anterior (sai com 1 se regrediu)\n"
+          "  -C  só compara duas saídas já gravadas (por exemplo, as do RP2040)\n"
+          "  -l  piora tolerada na mediana, em %% (padrão 10)\n",
+          prog, prog);
+}
+
+int main(int argc, char **argv) {
+  const char *saida = NULL, *base = NULL;
+  bool so_compara = false;
+  unsigned limite = 10;
+  int opt;
+  while ((opt = getopt(argc, argv, "n:o:c:l:Ch")) != -1) {
+    switch (opt) {
+      case 'n': iteracoes = (uint32_t)atoi(optarg); break;
+      case 'o': saida = optarg; break;
+      case 'c': base = optarg; break;
+      case 'l': limite = (unsigned)atoi(optarg); break;
+      case 'C': so_compara = true; break;
+      default: uso(argv[0]); return opt == 'h' ? 0 : 2;
+    }
+  }
+  if (so_compara) {
+    if (optind + 2 > argc) {
+      uso(argv[0]);
+      return 2;
+    }
+    return bench_compare(argv[optind], argv[optind + 1], limite) ? 0 : 1;
+  }
+  if (iteracoes == 0 || iteracoes > BENCH_MAX_SAMPLES)
+    iteracoes = BENCH_MAX_SAMPLES;
+
+  // O display e o DMA são os da simulação; o tempo medido é o do processador do PC
+  sim_periph_init();
+  sim_start(nucleo0);
+  sim_run(SIM_FOREVER - 1);
+
+  escreve(stdout);
+  if (saida) {
+    FILE *f = fopen(saida, "w");
+    if (!f) {
+      fprintf(stderr, "bench: nao criou %s\n", saida);
+      return 1;
+    }
+    escreve(f);
+    fclose(f);
+    if (base)
+      return bench_compare(base, saida, limite) ? 0 : 1;
+  } else if (base) {
+    fprintf(stderr, "bench: -c precisa de -o\n");
+    return 2;
+  }
+  return 0;
+}
+
+#endif
@@ -0,0 +1,130 @@
+#include "adc_sampler.h"
+#include "hardware/adc.h"
+#include "hardware/dma.h"
+#include "hardware/clocks.h"
+#include "trace.h"
+
+// Contagem programada no DMA; o escritor é o próprio DMA, então a quantidade
+// já produzida sai direto do registrador TRANS_COUNT
+#define ADC_SAMPLER_COUNT 0xFFFFFFFFu
+
+static uint16_t raw_ring[ADC_SAMPLER_RAW_LEN] __attribute__((aligned(1u << ADC_SAMPLER_RAW_BITS)));
+static sampler_core_t core;
+static int dma_channel = -1;
+static uint32_t consumed;           // Amostras do DMA já repassadas ao núcleo
+static uint8_t active_mask;
+static bool running;
+
+static void adc_sampler_arm(void) {
+  adc_run(false);
+  adc_fifo_drain();
+  // O round-robin começa pela menor entrada ativa, casando com o núcleo
+  for (uint8_t input = 0; input < SAMPLER_MAX_INPUTS; ++input) {
+    if (active_mask & (1u << input)) {
+      adc_select_input(input);
+      break;
+    }
+  }
+  consumed = 0;
+  core.position = 0;
+
+  dma_channel_config c = dma_channel_get_default_config(dma_channel);
+  channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+  channel_config_set_read_increment(&c, false);
+  channel_config_set_write_increment(&c, true);
+  channel_config_set_ring(&c, true, ADC_SAMPLER_RAW_BITS);
+  channel_config_set_dreq(&c, DREQ_ADC);
+  dma_channel_configure(dma_channel, &c, raw_ring, &adc_hw->fifo, ADC_SAMPLER_COUNT, true);
+  adc_run(true);
+  running = true;
+}
+
+static void adc_sampler_setup(void) {
+  adc_set_round_robin(active_mask);
+  adc_fifo_setup(true, true, 1, false, false);
+}
+
+// Amostragem contínua das entradas em input_mask, à taxa total aggregate_rate_hz
+// (dividida igualmente entre as entradas), via FIFO do ADC + DMA
+void adc_sampler_start(uint8_t input_mask, uint32_t aggregate_rate_hz, uint16_t decimation) {
+  active_mask = input_mask & ((1u << SAMPLER_MAX_INPUTS) - 1);
+  sampler_core_init(&core, active_mask, decimation);
+
+  adc_sampler_setup();
+  // Período de conversão = (1 + div) ciclos do clk_adc (mínimo de 96 ciclos)
+  adc_set_clkdiv((float)clock_get_hz(clk_adc) / aggregate_rate_hz - 1.0f);
+
+  if (dma_channel < 0)
+    dma_channel = dma_claim_unused_channel(true);
+  adc_sampler_arm();
+}
+
+void adc_sampler_stop(void) {
+  running = false;
+  adc_run(false);
+  if (dma_channel >= 0)
+    dma_channel_abort(dma_channel);
+  adc_set_round_robin(0);
+  adc_fifo_setup(false, false, 0, false, false);
+  adc_fifo_drain();
+}
+
+// Retoma depois de adc_sampler_stop com a mesma configuração, mantendo os
+// consumidores; os blocos de decimação incompletos da parada são descartados
+// para não misturar amostras de antes e de depois do intervalo
+void adc_sampler_resume(void) {
+  if (running || dma_channel < 0)
+    return;
+  for (uint8_t input = 0; input < SAMPLER_MAX_INPUTS; ++input) {
+    core.ch[input].dec_acc = 0;
+    core.ch[input].dec_n = 0;
+  }
+  adc_sampler_setup();
+  adc_sampler_arm();
+}
+
+bool adc_sampler_running(void) {
+  return running;
+}
+
+// Repassa ao núcleo o que o DMA escreveu desde a última chamada. Nunca bloqueia;
+// se o consumidor atrasou mais que o buffer, descarta o excesso mantendo o ciclo.
+void adc_sampler_poll(void) {
+  if (!running)
+    return;
+  uint32_t produced = ADC_SAMPLER_COUNT - dma_channel_hw_addr(dma_channel)->transfer_count;
+  uint32_t pending = produced - consumed;
+
+  // Margem de meio buffer para não ler a região que o DMA está sobrescrevendo
+  if (pending > ADC_SAMPLER_RAW_LEN / 2) {
+    uint32_t lost = pending - ADC_SAMPLER_RAW_LEN / 2;
+    sampler_core_skip(&core, lost);
+    consumed += lost;
+    pending -= lost;
+    TRACE(TRACE_ADC_LOST, lost > UINT16_MAX ? UINT16_MAX : lost);
+  }
+  TRACE(TRACE_ADC_BATCH, pending);
+
+  while (pending) {
+    uint32_t index = consumed & (ADC_SAMPLER_RAW_LEN - 1);
+    uint32_t chunk = ADC_SAMPLER_RAW_LEN - index;
+    if (chunk > pending)
+      chunk = pending;
+    sampler_core_push(&core, &raw_ring[index], chunk);
+    consumed += chunk;
+    pending -= chunk;
+  }
+
+  // Contagem esgotada (dias de operação contínua): reinicia do começo do ciclo
+  if (!dma_channel_is_busy(dma_channel))
+    adc_sampler_arm();
+}
+
+const sampler_core_t *adc_sampler_core(void) {
+  return &core;
+}
+
+// Consumidores por amostra rodam dentro de adc_sampler_poll; ligar após adc_sampler_start
+void adc_sampler_set_sink(uint8_t input, sampler_sink_t sink, void *ctx) {
+  sampler_core_set_sink(&core, input, sink, ctx);
+}
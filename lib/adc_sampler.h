@@ -0,0 +1,19 @@
+#ifndef ADC_SAMPLER_H
+#define ADC_SAMPLER_H
+
+#include "pico/stdlib.h"
+#include "sampler_core.h"
+
+// Buffer circular bruto preenchido pelo DMA (potência de 2, alinhado ao tamanho)
+#define ADC_SAMPLER_RAW_BITS 13                       // 8 KB
+#define ADC_SAMPLER_RAW_LEN  ((1u << ADC_SAMPLER_RAW_BITS) / sizeof(uint16_t))
+
+void adc_sampler_start(uint8_t input_mask, uint32_t aggregate_rate_hz, uint16_t decimation);
+void adc_sampler_stop(void);
+void adc_sampler_resume(void);
+bool adc_sampler_running(void);
+void adc_sampler_poll(void);
+const sampler_core_t *adc_sampler_core(void);
+void adc_sampler_set_sink(uint8_t input, sampler_sink_t sink, void *ctx);
+
+#endif
@@ -0,0 +1,183 @@
+#include <math.h>
+#include "audio.h"
+
+// Bandas para 8 kHz (31,25 Hz por bin): graves, voz, médios e agudos até Nyquist
+const audio_band_t audio_bands_8k[AUDIO_BANDS] = {
+  { 1, 7 },       // 31-250 Hz
+  { 8, 31 },      // 250 Hz-1 kHz
+  { 32, 63 },     // 1-2 kHz
+  { 64, 127 },    // 2-4 kHz
+};
+
+// Referências dos níveis: seno de amplitude 2048 contagens. No RMS, a energia
+// média por amostra (2048² / 2); no pico, 2048². Nas bandas, a soma dos bins
+// positivos desse seno depois do ganho de entrada (<< 3: amplitude 16384), da
+// janela de Hann (energia 3/8) e da escala 1/N da FFT: 3 * 16384² / 32
+#define REF_RMS  (2048u * 2048u / 2)
+#define REF_PEAK (2048u * 2048u)
+#define REF_BAND (3ull * 16384 * 16384 / 32)
+#define INPUT_SHIFT 3
+
+// Tabelas comuns a todas as instâncias, montadas uma vez em audio_init (o
+// ponto flutuante fica só aqui; o processamento é todo inteiro)
+static int16_t hann[AUDIO_BLOCK];
+static int16_t tw_cos[AUDIO_BLOCK / 2], tw_sin[AUDIO_BLOCK / 2];
+static bool tables_ready;
+
+static int16_t q15(float v) {
+  int32_t q = (int32_t)lroundf(v * 32768.0f);
+  return q > INT16_MAX ? INT16_MAX : q < INT16_MIN ? INT16_MIN : (int16_t)q;
+}
+
+static void build_tables(void) {
+  const float step = 6.28318530718f / AUDIO_BLOCK;
+  for (uint32_t n = 0; n < AUDIO_BLOCK; ++n)
+    hann[n] = q15(0.5f - 0.5f * cosf(step * n));
+  for (uint32_t k = 0; k < AUDIO_BLOCK / 2; ++k) {
+    tw_cos[k] = q15(cosf(step * k));
+    tw_sin[k] = q15(-sinf(step * k));
+  }
+  tables_ready = true;
+}
+
+void audio_init(audio_t *a, const audio_band_t *bands) {
+  if (!tables_ready)
+    build_tables();
+  a->head = a->tail = 0;
+  a->fill = 0;
+  a->dropped = 0;
+  a->bands = bands ? bands : audio_bands_8k;
+  a->out = (audio_features_t){ .rms_db_q8 = AUDIO_FLOOR_Q8, .peak_db_q8 = AUDIO_FLOOR_Q8 };
+  for (uint32_t i = 0; i < AUDIO_BANDS; ++i)
+    a->out.band_db_q8[i] = AUDIO_FLOOR_Q8;
+}
+
+// Com a fila cheia o bloco recém-completado é descartado e a mesma posição
+// recomeça: os prontos nunca são sobrescritos enquanto esperam
+void audio_push(audio_t *a, uint16_t sample) {
+  a->blocks[a->head % AUDIO_QUEUE][a->fill] = sample;
+  if (++a->fill < AUDIO_BLOCK)
+    return;
+  a->fill = 0;
+  if (a->head + 1 - a->tail < AUDIO_QUEUE)
+    a->head++;
+  else
+    a->dropped++;
+}
+
+void audio_sink(void *ctx, uint16_t sample) {
+  audio_push(ctx, sample);
+}
+
+// Amostras perdidas ou ADC parado: o bloco em formação não é mais contínuo
+void audio_gap(audio_t *a) {
+  a->fill = 0;
+}
+
+// log2 em Q8: parte inteira pela posição do bit mais alto, fração por
+// quadrados sucessivos da mantissa (um bit por quadrado)
+static int32_t log2_q8(uint64_t x) {
+  int32_t msb = 63 - __builtin_clzll(x);
+  uint32_t m = msb > 15 ? (uint32_t)(x >> (msb - 15)) : (uint32_t)(x << (15 - msb));   // [1, 2) em Q15
+  int32_t frac = 0;
+  for (int bit = 7; bit >= 0; --bit) {
+    m = (m * m) >> 15;
+    if (m >= (2u << 15)) {
+      m >>= 1;
+      frac |= 1 << bit;
+    }
+  }
+  return (msb << 8) | frac;
+}
+
+// 10 * log10(energy / reference) em Q8 (10 * log10(2) ~ 771 / 256)
+int32_t audio_db_q8(uint64_t energy, uint64_t reference) {
+  if (!energy || !reference)
+    return AUDIO_FLOOR_Q8;
+  int32_t db = ((log2_q8(energy) - log2_q8(reference)) * 771) >> 8;
+  return db < AUDIO_FLOOR_Q8 ? AUDIO_FLOOR_Q8 : db;
+}
+
+static uint32_t isqrt32(uint32_t x) {
+  uint32_t r = 0;
+  for (uint32_t bit = 1u << 30; bit; bit >>= 2) {
+    if (x >= r + bit) {
+      x -= r + bit;
+      r = (r >> 1) + bit;
+    } else {
+      r >>= 1;
+    }
+  }
+  return r;
+}
+
+// FFT radix-2 no lugar, dizimação no tempo. Cada estágio divide por 2: sem
+// saturação com qualquer entrada em Q15 e saída já escalada por 1/N
+static void fft(int16_t *re, int16_t *im) {
+  for (uint32_t i = 1, j = 0; i < AUDIO_BLOCK; ++i) {
+    uint32_t bit = AUDIO_BLOCK >> 1;
+    for (; j & bit; bit >>= 1)
+      j ^= bit;
+    j |= bit;
+    if (i < j) {
+      int16_t t = re[i]; re[i] = re[j]; re[j] = t;
+      t = im[i]; im[i] = im[j]; im[j] = t;
+    }
+  }
+  for (uint32_t half = 1, stride = AUDIO_BLOCK / 2; half < AUDIO_BLOCK; half <<= 1, stride >>= 1) {
+    for (uint32_t k = 0; k < half; ++k) {
+      int32_t wr = tw_cos[k * stride], wi = tw_sin[k * stride];
+      for (uint32_t i = k; i < AUDIO_BLOCK; i += 2 * half) {
+        uint32_t j = i + half;
+        int32_t tr = (wr * re[j] - wi * im[j]) >> 15;
+        int32_t ti = (wr * im[j] + wi * re[j]) >> 15;
+        re[j] = (int16_t)((re[i] - tr) >> 1);
+        im[j] = (int16_t)((im[i] - ti) >> 1);
+        re[i] = (int16_t)((re[i] + tr) >> 1);
+        im[i] = (int16_t)((im[i] + ti) >> 1);
+      }
+    }
+  }
+}
+
+// Processa o bloco pronto mais antigo; false se não havia nenhum. Custo fixo
+// por bloco (não depende do sinal), para caber num orçamento por execução
+bool audio_process(audio_t *a) {
+  if (a->head == a->tail)
+    return false;
+  const uint16_t *x = a->blocks[a->tail % AUDIO_QUEUE];
+
+  // Nível DC pela média do próprio bloco (o microfone fica em torno do meio)
+  uint32_t sum = 0;
+  for (uint32_t n = 0; n < AUDIO_BLOCK; ++n)
+    sum += x[n];
+  int32_t mean = (int32_t)(sum >> AUDIO_BLOCK_LOG2);
+
+  uint32_t energy = 0, peak = 0;
+  for (uint32_t n = 0; n < AUDIO_BLOCK; ++n) {
+    int32_t d = (int32_t)x[n] - mean;
+    uint32_t mag = d < 0 ? -d : d;
+    energy += mag * mag;   // Até 256 * 4095²: cabe em 32 bits
+    if (mag > peak)
+      peak = mag;
+    a->re[n] = (int16_t)(((d * (1 << INPUT_SHIFT)) * hann[n]) >> 15);
+    a->im[n] = 0;
+  }
+  a->tail++;   // A posição volta para audio_push; daqui em diante só re/im
+
+  fft(a->re, a->im);
+
+  for (uint32_t b = 0; b < AUDIO_BANDS; ++b) {
+    uint64_t e = 0;
+    for (uint32_t k = a->bands[b].first_bin; k <= a->bands[b].last_bin && k < AUDIO_BLOCK / 2; ++k)
+      e += (uint32_t)(a->re[k] * a->re[k]) + (uint32_t)(a->im[k] * a->im[k]);
+    a->out.band_db_q8[b] = audio_db_q8(e, REF_BAND);
+  }
+  uint32_t mean_energy = energy >> AUDIO_BLOCK_LOG2;
+  a->out.rms = (uint16_t)isqrt32(mean_energy);
+  a->out.peak = (uint16_t)peak;
+  a->out.rms_db_q8 = audio_db_q8(mean_energy, REF_RMS);
+  a->out.peak_db_q8 = audio_db_q8((uint64_t)peak * peak, REF_PEAK);
+  a->out.blocks++;
+  return true;
+}
@@ -0,0 +1,61 @@
+#ifndef AUDIO_H
+#define AUDIO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Extração de características do microfone em blocos de AUDIO_BLOCK amostras
+// (32 ms a 8 kHz): nível RMS e pico do bloco e a energia de AUDIO_BANDS bandas
+// por uma FFT radix-2 de ponto fixo (Q15, janela de Hann, escala 1/2 por
+// estágio). Sem dependência de hardware: audio_push() recebe as amostras de
+// 12 bits (do amostrador ou de um WAV no PC) e audio_process() calcula um
+// bloco por chamada, com custo fixo, para quem chama controlar o orçamento.
+//
+// Níveis em dBFS (Q8): 0 dB é o seno de amplitude 2048 contagens (escala
+// cheia do ADC em torno do meio); bandas em relação à energia desse seno.
+
+#define AUDIO_BLOCK_LOG2 8
+#define AUDIO_BLOCK      (1u << AUDIO_BLOCK_LOG2)
+#define AUDIO_QUEUE      4                 // Um bloco em formação + até 3 prontos
+#define AUDIO_BANDS      4
+#define AUDIO_FLOOR_Q8   (-100 * 256)      // Nível de um bloco ou banda sem energia
+
+typedef struct {
+  uint16_t first_bin, last_bin;            // Bins inclusivos (largura fs / AUDIO_BLOCK)
+} audio_band_t;
+
+// Resultado do último bloco processado
+typedef struct {
+  uint16_t rms;                            // Contagens, sem o nível DC
+  uint16_t peak;
+  int32_t rms_db_q8;
+  int32_t peak_db_q8;
+  int32_t band_db_q8[AUDIO_BANDS];
+  uint32_t blocks;                         // Blocos processados
+} audio_features_t;
+
+typedef struct {
+  uint16_t blocks[AUDIO_QUEUE][AUDIO_BLOCK];
+  uint32_t head, tail;                     // Blocos completos escritos e consumidos
+  uint16_t fill;                           // Amostras no bloco em formação
+  uint32_t dropped;                        // Blocos perdidos com a fila cheia
+  const audio_band_t *bands;
+  int16_t re[AUDIO_BLOCK], im[AUDIO_BLOCK];   // Área de trabalho da FFT
+  audio_features_t out;
+} audio_t;
+
+extern const audio_band_t audio_bands_8k[AUDIO_BANDS];
+
+void audio_init(audio_t *a, const audio_band_t *bands);
+void audio_push(audio_t *a, uint16_t sample);
+void audio_sink(void *ctx, uint16_t sample);
+void audio_gap(audio_t *a);
+bool audio_process(audio_t *a);
+
+static inline uint32_t audio_pending(const audio_t *a) {
+  return a->head - a->tail;
+}
+
+int32_t audio_db_q8(uint64_t energy, uint64_t reference);
+
+#endif
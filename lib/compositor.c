@@ -0,0 +1,99 @@
+#include <stdio.h>
+#include <string.h>
+#include "compositor.h"
+
+void compositor_init(compositor_t *comp, ssd1306_t *ssd) {
+  comp->ssd = ssd;
+  comp->current = NULL;
+}
+
+static void compositor_draw_layer(ssd1306_t *ssd, const compositor_layer_t *layer) {
+  switch (layer->op) {
+    case LAYER_TEXT:
+      ssd1306_draw_string(ssd, layer->text, layer->x, layer->y);
+      break;
+    case LAYER_RECT:
+      ssd1306_rect(ssd, layer->y, layer->x, layer->w, layer->h, true, false);
+      break;
+    case LAYER_FILLED_RECT:
+      ssd1306_fill_rect(ssd, layer->y, layer->x, layer->w, layer->h, true);
+      break;
+    case LAYER_HLINE:
+      ssd1306_hline(ssd, layer->x, layer->w, layer->y, true);
+      break;
+    case LAYER_VLINE:
+      ssd1306_vline(ssd, layer->x, layer->y, layer->h, true);
+      break;
+  }
+}
+
+// Rasteriza as camadas estáticas uma única vez e guarda o resultado
+static void compositor_build_background(compositor_t *comp, compositor_screen_t *screen) {
+  ssd1306_t *ssd = comp->ssd;
+  ssd1306_fill(ssd, false);
+  for (uint8_t i = 0; i < screen->layer_count; ++i)
+    compositor_draw_layer(ssd, &screen->layers[i]);
+  screen->background = malloc(ssd->bufsize);
+  if (screen->background)
+    memcpy(screen->background, ssd->ram_buffer, ssd->bufsize);
+}
+
+static bool compositor_field_changed(const compositor_field_t *field) {
+  if (!field->valid)
+    return true;
+  if (field->value)
+    return *field->value != field->last_value;
+  return *field->text != field->last_text;
+}
+
+static void compositor_draw_field(compositor_t *comp, const compositor_screen_t *screen, compositor_field_t *field) {
+  ssd1306_t *ssd = comp->ssd;
+  char buffer[17];
+  uint8_t x1 = field->x + field->chars * 8 - 1;
+
+  // Devolve o fundo sob o campo antes de escrever o novo valor
+  if (screen->background)
+    ssd1306_copy_area(ssd, screen->background, field->x, field->y, x1, field->y + 7);
+  else
+    ssd1306_fill_rect(ssd, field->y, field->x, field->chars * 8, 8, false);
+
+  if (field->value) {
+    field->last_value = *field->value;
+    snprintf(buffer, sizeof(buffer), "%d", field->last_value);
+  } else {
+    field->last_text = *field->text;
+    snprintf(buffer, sizeof(buffer), "%s", field->last_text ? field->last_text : "");
+  }
+  if (strlen(buffer) > field->chars)
+    buffer[field->chars] = '\0';
+  ssd1306_draw_string(ssd, buffer, field->x, field->y);
+  field->valid = true;
+}
+
+// Coloca a tela no ram_buffer: na troca de tela copia o fundo em cache; em
+// seguida redesenha só os campos cujo valor vinculado mudou
+void compositor_show(compositor_t *comp, compositor_screen_t *screen) {
+  ssd1306_t *ssd = comp->ssd;
+  if (comp->current != screen) {
+    if (!screen->background)
+      compositor_build_background(comp, screen);
+    if (screen->background) {
+      memcpy(&ssd->ram_buffer[1], &screen->background[1], ssd->bufsize - 1);
+      ssd1306_mark_dirty(ssd, 0, 0, ssd->width - 1, ssd->height - 1);
+    }
+    for (uint8_t i = 0; i < screen->field_count; ++i)
+      screen->fields[i].valid = false;
+    comp->current = screen;
+  }
+
+  for (uint8_t i = 0; i < screen->field_count; ++i) {
+    compositor_field_t *field = &screen->fields[i];
+    if (compositor_field_changed(field))
+      compositor_draw_field(comp, screen, field);
+  }
+}
+
+// Avisa que o ram_buffer foi desenhado por fora do compositor
+void compositor_release(compositor_t *comp) {
+  comp->current = NULL;
+}
@@ -0,0 +1,60 @@
+#ifndef COMPOSITOR_H
+#define COMPOSITOR_H
+
+#include "ssd1306.h"
+
+// Elementos estáticos de uma tela, rasterizados uma única vez no fundo
+typedef enum {
+  LAYER_TEXT,
+  LAYER_RECT,
+  LAYER_FILLED_RECT,
+  LAYER_HLINE,
+  LAYER_VLINE
+} compositor_op_t;
+
+typedef struct {
+  compositor_op_t op;
+  uint8_t x, y;       // Texto/retângulo: canto superior esquerdo; linhas: início
+  uint8_t w, h;       // Retângulo: tamanho; hline: x final em w; vline: y final em h
+  const char *text;
+} compositor_layer_t;
+
+#define LAYER_TEXT_AT(x, y, s)            { LAYER_TEXT, (x), (y), 0, 0, (s) }
+#define LAYER_RECT_AT(top, left, w, h)    { LAYER_RECT, (left), (top), (w), (h), NULL }
+#define LAYER_HLINE_AT(x0, x1, y)         { LAYER_HLINE, (x0), (y), (x1), 0, NULL }
+#define LAYER_VLINE_AT(x, y0, y1)         { LAYER_VLINE, (x), (y0), 0, (y1), NULL }
+
+// Campo dinâmico vinculado a um valor: só é redesenhado quando o valor muda
+typedef struct {
+  uint8_t x, y, chars;        // Posição e largura máxima em caracteres
+  const int *value;           // Valor inteiro vinculado (ou NULL)
+  const char *const *text;    // Texto vinculado (ou NULL)
+  int last_value;
+  const char *last_text;
+  bool valid;
+} compositor_field_t;
+
+#define FIELD_INT_AT(x, y, chars, ptr)   { (x), (y), (chars), (ptr), NULL, 0, NULL, false }
+#define FIELD_TEXT_AT(x, y, chars, ptr)  { (x), (y), (chars), NULL, (ptr), 0, NULL, false }
+
+typedef struct {
+  const compositor_layer_t *layers;
+  uint8_t layer_count;
+  compositor_field_t *fields;
+  uint8_t field_count;
+  uint8_t *background;        // Fundo já rasterizado (alocado no primeiro uso)
+} compositor_screen_t;
+
+#define SCREEN_OF(layers, fields) \
+  { (layers), sizeof(layers) / sizeof((layers)[0]), (fields), sizeof(fields) / sizeof((fields)[0]), NULL }
+
+typedef struct {
+  ssd1306_t *ssd;
+  compositor_screen_t *current;   // Tela cujo fundo está no ram_buffer (NULL se outra coisa foi desenhada)
+} compositor_t;
+
+void compositor_init(compositor_t *comp, ssd1306_t *ssd);
+void compositor_show(compositor_t *comp, compositor_screen_t *screen);
+void compositor_release(compositor_t *comp);
+
+#endif
@@ -0,0 +1,94 @@
+#include "filters.h"
+
+void filter_init(filter_chain_t *f, uint8_t os_log2, uint8_t median_taps, uint8_t ema_shift) {
+  f->os_log2 = os_log2;
+  f->median_taps = (median_taps >= 5) ? 5 : (median_taps >= 3 ? 3 : 1);
+  f->ema_shift = ema_shift;
+  f->os_acc = 0;
+  f->os_n = 0;
+  f->med_idx = 0;
+  f->med_fill = 0;
+  f->ema = 0;
+  f->primed = false;
+  f->out = 0;
+  f->outputs = 0;
+}
+
+#define SORT2(a, b) do { if ((a) > (b)) { uint16_t t_ = (a); (a) = (b); (b) = t_; } } while (0)
+
+// Redes de ordenação fixas: custo constante, sem laços dependentes de dados
+static uint16_t median3(const uint16_t *v) {
+  uint16_t a = v[0], b = v[1], c = v[2];
+  SORT2(a, b);
+  SORT2(b, c);
+  SORT2(a, b);
+  return b;
+}
+
+static uint16_t median5(const uint16_t *v) {
+  uint16_t a = v[0], b = v[1], c = v[2], d = v[3], e = v[4];
+  SORT2(a, b);
+  SORT2(d, e);
+  SORT2(a, d);
+  SORT2(b, e);
+  SORT2(c, d);
+  SORT2(b, c);
+  SORT2(c, d);
+  return (b > c) ? b : c;
+}
+
+// Entrega uma amostra bruta; retorna true quando uma nova saída foi produzida
+bool filter_push(filter_chain_t *f, uint16_t sample) {
+  f->os_acc += sample;
+  if (++f->os_n < (1u << f->os_log2))
+    return false;
+  uint16_t value = f->os_acc >> f->os_log2;
+  f->os_acc = 0;
+  f->os_n = 0;
+
+  if (f->median_taps > 1) {
+    f->med[f->med_idx] = value;
+    if (++f->med_idx == f->median_taps)
+      f->med_idx = 0;
+    if (f->med_fill < f->median_taps)
+      f->med_fill++;
+    // Até a janela encher, a mediana ainda não é confiável: passa o valor direto
+    if (f->med_fill == f->median_taps)
+      value = (f->median_taps == 5) ? median5(f->med) : median3(f->med);
+  }
+
+  if (f->ema_shift) {
+    int32_t x = (int32_t)value << FILTER_EMA_FRAC;
+    if (!f->primed) {
+      f->ema = x;
+      f->primed = true;
+    } else {
+      f->ema += (x - f->ema) >> f->ema_shift;
+    }
+    value = (f->ema + (1 << (FILTER_EMA_FRAC - 1))) >> FILTER_EMA_FRAC;
+  }
+
+  f->out = value;
+  f->outputs++;
+  return true;
+}
+
+// Adaptador para ligar a cadeia direto na saída do amostrador
+void filter_sink(void *ctx, uint16_t sample) {
+  filter_push((filter_chain_t *)ctx, sample);
+}
+
+bool hyst_update(hysteresis_t *h, int32_t value) {
+  if (h->dir == HYST_ABOVE) {
+    if (!h->active && value > h->on)
+      h->active = true;
+    else if (h->active && value < h->off)
+      h->active = false;
+  } else {
+    if (!h->active && value < h->on)
+      h->active = true;
+    else if (h->active && value > h->off)
+      h->active = false;
+  }
+  return h->active;
+}
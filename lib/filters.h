@@ -0,0 +1,56 @@
+#ifndef FILTERS_H
+#define FILTERS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Cadeia de filtros por canal, O(1) por amostra e sem heap:
+// sobreamostragem (média de 2^n amostras) -> mediana de 3 ou 5 -> EMA inteira
+
+#define FILTER_MEDIAN_MAX 5
+#define FILTER_EMA_FRAC   4         // Bits fracionários guardados no estado da EMA
+
+typedef struct {
+  uint8_t os_log2;                  // Amostras por saída = 2^os_log2
+  uint8_t median_taps;              // 1 (desligada), 3 ou 5
+  uint8_t ema_shift;                // Peso da nova amostra = 1 / 2^ema_shift (0 desliga)
+
+  uint32_t os_acc;
+  uint16_t os_n;
+  uint16_t med[FILTER_MEDIAN_MAX];
+  uint8_t med_idx;
+  uint8_t med_fill;
+  int32_t ema;                      // Estado da EMA com FILTER_EMA_FRAC bits extras
+  bool primed;
+
+  uint16_t out;
+  uint32_t outputs;                 // Quantas saídas a cadeia já produziu
+} filter_chain_t;
+
+void filter_init(filter_chain_t *f, uint8_t os_log2, uint8_t median_taps, uint8_t ema_shift);
+bool filter_push(filter_chain_t *f, uint16_t sample);
+void filter_sink(void *ctx, uint16_t sample);
+
+static inline uint16_t filter_value(const filter_chain_t *f) {
+  return f->out;
+}
+
+// Limiar com histerese: ativa ao cruzar 'on' e só desativa ao voltar além de 'off'
+typedef enum {
+  HYST_ABOVE,                       // Ativo quando valor > on; libera quando valor < off (off < on)
+  HYST_BELOW                        // Ativo quando valor < on; libera quando valor > off (off > on)
+} hyst_dir_t;
+
+typedef struct {
+  hyst_dir_t dir;
+  int32_t on;
+  int32_t off;
+  bool active;
+} hysteresis_t;
+
+#define HYST_ABOVE_INIT(on, off) { HYST_ABOVE, (on), (off), false }
+#define HYST_BELOW_INIT(on, off) { HYST_BELOW, (on), (off), false }
+
+bool hyst_update(hysteresis_t *h, int32_t value);
+
+#endif
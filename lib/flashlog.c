@@ -0,0 +1,483 @@
+#include <string.h>
+#include "flashlog.h"
+#include "pico/flash.h"
+#include "hardware/timer.h"
+#include "trace.h"
+
+// ---------------------------------------------------------------------------
+// Formato
+//
+// Cada página de 256 bytes é independente: cabeçalho com número de sequência
+// (cresce para sempre), tempo do primeiro registro e CRC, seguido dos
+// registros. Um registro é uma etiqueta (tipo), o intervalo desde o registro
+// anterior (varint) e os valores em varint zigzag; nas amostras os valores são
+// a diferença para a amostra anterior da mesma página. Uma amostra típica
+// ocupa 6 bytes, e uma página guarda umas 40.
+// ---------------------------------------------------------------------------
+
+#define FLASHLOG_MAGIC      0x4C49       // Novo a cada mudança de formato
+#define FLASHLOG_PAYLOAD    (FLASH_PAGE_SIZE - 16)
+#define FLASHLOG_MAX_RECORD (2 + 5 + FLASHLOG_VALUES * 5)
+#define FLASHLOG_NONE       0xFFFFFFFFu
+#define PAGES_PER_SECTOR    (FLASH_SECTOR_SIZE / FLASH_PAGE_SIZE)
+
+typedef struct {
+  uint16_t magic;
+  uint16_t len;                    // Bytes de registros
+  uint32_t seq;
+  uint32_t t0;                     // Tempo do primeiro registro
+  uint32_t crc;                    // CRC-32 do cabeçalho (sem este campo) e dos registros
+  uint8_t payload[FLASHLOG_PAYLOAD];
+} flashlog_page_t;
+
+_Static_assert(sizeof(flashlog_page_t) == FLASH_PAGE_SIZE, "página do log fora do tamanho");
+
+// Quantos valores cada tipo grava
+static const uint8_t value_count[] = {
+  [FLASHLOG_SAMPLE] = 4,
+  [FLASHLOG_WATER] = 1,
+  [FLASHLOG_COUNTERS] = 4,
+  [FLASHLOG_BOOT] = 1,
+  [FLASHLOG_HEALTH] = 3,
+  [FLASHLOG_IRRIGATION] = 4,
+};
+
+static flashlog_page_t page;       // Em montagem (só RAM)
+static flashlog_page_t ready;      // Fechada, esperando flashlog_service()
+static bool ready_full;
+static uint32_t prev_t;            // Contexto das diferenças dentro da página
+static int32_t prev_sample[FLASHLOG_VALUES];
+
+static uint32_t next_seq;
+static uint32_t write_page;
+static uint32_t erased_sector = FLASHLOG_NONE;     // Setor à frente já apagado
+static uint32_t sector_t0[FLASHLOG_SECTORS];       // Índice: tempo da 1a página válida
+static uint32_t time_base;
+static flashlog_stats_t stats;
+
+// ---------------------------------------------------------------------------
+// CRC-32 com tabela de 16 entradas (4 bits por passo)
+// ---------------------------------------------------------------------------
+
+static const uint32_t crc_nibble[16] = {
+  0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+  0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+};
+
+static uint32_t crc32_update(uint32_t crc, const uint8_t *data, size_t len) {
+  while (len--) {
+    crc ^= *data++;
+    crc = (crc >> 4) ^ crc_nibble[crc & 0x0F];
+    crc = (crc >> 4) ^ crc_nibble[crc & 0x0F];
+  }
+  return crc;
+}
+
+static uint32_t page_crc(const flashlog_page_t *pg) {
+  uint32_t crc = crc32_update(0xFFFFFFFFu, (const uint8_t *)pg, offsetof(flashlog_page_t, crc));
+  return ~crc32_update(crc, pg->payload, pg->len);
+}
+
+// ---------------------------------------------------------------------------
+// Leitura pela XIP
+// ---------------------------------------------------------------------------
+
+static inline const flashlog_page_t *flash_page(uint32_t p) {
+  return (const flashlog_page_t *)(XIP_BASE + FLASHLOG_OFFSET + p * FLASH_PAGE_SIZE);
+}
+
+static bool page_valid(const flashlog_page_t *pg) {
+  return pg->magic == FLASHLOG_MAGIC && pg->len <= FLASHLOG_PAYLOAD && pg->crc == page_crc(pg);
+}
+
+static bool blank(const void *addr, size_t len) {
+  const uint32_t *w = addr;
+  for (size_t i = 0; i < len / 4; ++i)
+    if (w[i] != 0xFFFFFFFFu)
+      return false;
+  return true;
+}
+
+static bool sector_blank(uint32_t s) {
+  return blank((const void *)(XIP_BASE + FLASHLOG_OFFSET + s * FLASH_SECTOR_SIZE), FLASH_SECTOR_SIZE);
+}
+
+static inline uint32_t sector_of(uint32_t p) {
+  return p / PAGES_PER_SECTOR;
+}
+
+// Setor que a escrita ocupa a seguir: o atual, se ela está no começo dele
+static uint32_t sector_ahead(void) {
+  uint32_t s = sector_of(write_page);
+  return write_page % PAGES_PER_SECTOR == 0 ? s : (s + 1) % FLASHLOG_SECTORS;
+}
+
+// ---------------------------------------------------------------------------
+// Codificação
+// ---------------------------------------------------------------------------
+
+static size_t put_varint(uint8_t *out, uint32_t v) {
+  size_t n = 0;
+  while (v >= 0x80) {
+    out[n++] = (uint8_t)(v | 0x80);
+    v >>= 7;
+  }
+  out[n++] = (uint8_t)v;
+  return n;
+}
+
+static size_t get_varint(const uint8_t *in, size_t len, uint32_t *v) {
+  *v = 0;
+  for (size_t n = 0; n < len && n < 5; ++n) {
+    *v |= (uint32_t)(in[n] & 0x7F) << (7 * n);
+    if (!(in[n] & 0x80))
+      return n + 1;
+  }
+  return 0;
+}
+
+static inline uint32_t zigzag(int32_t v) {
+  return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static inline int32_t unzigzag(uint32_t v) {
+  return (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+}
+
+static size_t encode(const flashlog_record_t *r, uint8_t *out) {
+  size_t n = 0;
+  out[n++] = r->type;
+  n += put_varint(&out[n], r->t_s - prev_t);
+  for (uint8_t i = 0; i < value_count[r->type]; ++i) {
+    int32_t v = r->type == FLASHLOG_SAMPLE ? r->v[i] - prev_sample[i] : r->v[i];
+    n += put_varint(&out[n], zigzag(v));
+  }
+  return n;
+}
+
+// Percorre os registros de uma página; para no primeiro byte que não faz sentido
+static size_t page_decode(const flashlog_page_t *pg, flashlog_visit_fn visit, void *ctx) {
+  flashlog_record_t r = { 0 };
+  int32_t sample[FLASHLOG_VALUES] = { 0 };
+  uint32_t t = pg->t0;
+  size_t pos = 0, count = 0;
+  while (pos < pg->len) {
+    uint8_t type = pg->payload[pos++];
+    if (type < FLASHLOG_SAMPLE || type > FLASHLOG_IRRIGATION)
+      break;
+    uint32_t v;
+    size_t n = get_varint(&pg->payload[pos], pg->len - pos, &v);
+    if (!n)
+      break;
+    pos += n;
+    t += v;
+    memset(&r, 0, sizeof(r));
+    r.type = type;
+    r.t_s = t;
+    for (uint8_t i = 0; i < value_count[type] && n; ++i) {
+      n = get_varint(&pg->payload[pos], pg->len - pos, &v);
+      pos += n;
+      r.v[i] = unzigzag(v);
+      if (type == FLASHLOG_SAMPLE)
+        r.v[i] = sample[i] += r.v[i];
+    }
+    if (!n)
+      break;
+    visit(&r, ctx);
+    count++;
+  }
+  return count;
+}
+
+// ---------------------------------------------------------------------------
+// Gravação
+// ---------------------------------------------------------------------------
+
+typedef struct {
+  uint32_t offset;
+  const void *data;
+} flash_op_t;
+
+static void do_erase(void *param) {
+  const flash_op_t *op = param;
+  flash_range_erase(op->offset, FLASH_SECTOR_SIZE);
+}
+
+static void do_program(void *param) {
+  const flash_op_t *op = param;
+  flash_range_program(op->offset, op->data, FLASH_PAGE_SIZE);
+}
+
+// Com a XIP desligada nenhum dos núcleos pode ler da flash: flash_safe_execute
+// segura o outro núcleo e desliga as interrupções enquanto a operação dura.
+// A pausa do outro núcleo passa pela FIFO do SIO e consome o que houver nela,
+// então a aplicação não pode usar a FIFO para as próprias mensagens
+static bool erase_sector(uint32_t s) {
+  flash_op_t op = { FLASHLOG_OFFSET + s * FLASH_SECTOR_SIZE, NULL };
+  sector_t0[s] = FLASHLOG_NONE;
+  TRACE(TRACE_FLASH_BEGIN, 1);
+  int rc = flash_safe_execute(do_erase, &op, 100);
+  TRACE(TRACE_FLASH_END, 1);
+  if (rc != PICO_OK)
+    return false;
+  erased_sector = s;
+  stats.sectors_erased++;
+  return true;
+}
+
+static bool program_page(uint32_t p, const flashlog_page_t *pg) {
+  flash_op_t op = { FLASHLOG_OFFSET + p * FLASH_PAGE_SIZE, pg };
+  TRACE(TRACE_FLASH_BEGIN, 0);
+  int rc = flash_safe_execute(do_program, &op, 100);
+  TRACE(TRACE_FLASH_END, 0);
+  return rc == PICO_OK;
+}
+
+static void start_page(uint32_t t) {
+  memset(&page, 0xFF, sizeof(page));
+  page.len = 0;
+  page.t0 = t;
+  prev_t = t;
+  memset(prev_sample, 0, sizeof(prev_sample));
+}
+
+// Fecha a página em montagem e a põe na fila de programação (um lugar só)
+static bool seal(void) {
+  if (page.len == 0)
+    return true;
+  if (ready_full)
+    return false;
+  page.magic = FLASHLOG_MAGIC;
+  page.seq = next_seq++;
+  page.crc = page_crc(&page);
+  ready = page;
+  ready_full = true;
+  page.len = 0;
+  return true;
+}
+
+void flashlog_seal(void) {
+  seal();
+}
+
+bool flashlog_append(flashlog_record_t *r) {
+  uint8_t buf[FLASHLOG_MAX_RECORD];
+  r->t_s = flashlog_now();
+  if (page.len == 0)
+    start_page(r->t_s);
+  size_t n = encode(r, buf);
+  if (page.len + n > FLASHLOG_PAYLOAD) {
+    if (!seal()) {
+      stats.dropped++;
+      return false;
+    }
+    start_page(r->t_s);
+    n = encode(r, buf);
+  }
+  memcpy(&page.payload[page.len], buf, n);
+  page.len += n;
+  prev_t = r->t_s;
+  if (r->type == FLASHLOG_SAMPLE)
+    memcpy(prev_sample, r->v, sizeof(prev_sample));
+  return true;
+}
+
+// Uma operação de flash por chamada, fora do caminho quente: programa a página
+// fechada ou, sem nada na fila, apaga o próximo setor antes de ele ser preciso
+bool flashlog_service(void) {
+  if (ready_full) {
+    uint32_t s = sector_of(write_page);
+    if (write_page % PAGES_PER_SECTOR == 0 && erased_sector != s)
+      return erase_sector(s);   // Só logo após a partida, sem setor preparado
+    const flashlog_page_t *dst = flash_page(write_page);
+    if (blank(dst, FLASH_PAGE_SIZE)) {
+      if (!program_page(write_page, &ready))
+        return false;
+      if (!page_valid(dst)) {
+        stats.bad_pages++;     // Fica na fila e vai para a página seguinte
+      } else {
+        if (sector_t0[s] == FLASHLOG_NONE)
+          sector_t0[s] = ready.t0;
+        ready_full = false;
+        stats.pages_written++;
+      }
+    } else {
+      stats.bad_pages++;       // Restos de uma gravação cortada
+    }
+    write_page = (write_page + 1) % FLASHLOG_PAGES;
+    return true;
+  }
+
+  uint32_t ahead = sector_ahead();
+  if (erased_sector == ahead)
+    return false;
+  if (sector_blank(ahead)) {
+    erased_sector = ahead;     // Já está apagado: poupa um ciclo de desgaste
+    return false;
+  }
+  return erase_sector(ahead);
+}
+
+// ---------------------------------------------------------------------------
+// Recuperação na partida
+// ---------------------------------------------------------------------------
+
+typedef struct {
+  uint8_t type;                    // 0: qualquer tipo
+  bool found;
+  flashlog_record_t rec;
+} last_ctx_t;
+
+static void keep_last(const flashlog_record_t *r, void *ctx) {
+  last_ctx_t *c = ctx;
+  if (!c->type || r->type == c->type) {
+    c->rec = *r;
+    c->found = true;
+  }
+}
+
+void flashlog_init(void) {
+  uint32_t head = FLASHLOG_NONE, head_seq = 0;
+  memset(&stats, 0, sizeof(stats));
+  for (uint32_t s = 0; s < FLASHLOG_SECTORS; ++s)
+    sector_t0[s] = FLASHLOG_NONE;
+
+  // Varre os cabeçalhos: a página válida de maior sequência é a última gravada
+  for (uint32_t p = 0; p < FLASHLOG_PAGES; ++p) {
+    const flashlog_page_t *pg = flash_page(p);
+    if (pg->magic == 0xFFFF)
+      continue;
+    if (!page_valid(pg)) {
+      stats.bad_pages++;
+      continue;
+    }
+    if (sector_t0[sector_of(p)] == FLASHLOG_NONE)
+      sector_t0[sector_of(p)] = pg->t0;
+    if (head == FLASHLOG_NONE || (int32_t)(pg->seq - head_seq) > 0) {
+      head = p;
+      head_seq = pg->seq;
+    }
+  }
+
+  last_ctx_t last = { 0 };
+  if (head == FLASHLOG_NONE) {
+    next_seq = 1;
+    write_page = 0;
+  } else {
+    next_seq = head_seq + 1;
+    write_page = (head + 1) % FLASHLOG_PAGES;
+    page_decode(flash_page(head), keep_last, &last);
+    // Páginas não apagadas depois da última válida são restos de um corte
+    // (as de cabeçalho legível já foram contadas na varredura)
+    while (write_page % PAGES_PER_SECTOR != 0 && !blank(flash_page(write_page), FLASH_PAGE_SIZE)) {
+      if (flash_page(write_page)->magic == 0xFFFF)
+        stats.bad_pages++;
+      write_page = (write_page + 1) % FLASHLOG_PAGES;
+    }
+  }
+  uint32_t ahead = sector_ahead();
+  erased_sector = sector_blank(ahead) ? ahead : FLASHLOG_NONE;
+
+  // O relógio do log continua de onde parou
+  time_base = last.found ? last.rec.t_s + 1 : 0;
+  ready_full = false;
+  page.len = 0;
+
+  flashlog_record_t boot = { .type = FLASHLOG_BOOT };
+  stats.boots = flashlog_last(FLASHLOG_BOOT, &boot) ? (uint32_t)boot.v[0] + 1 : 1;
+  boot = (flashlog_record_t){ .type = FLASHLOG_BOOT, .v = { (int32_t)stats.boots } };
+  flashlog_append(&boot);
+}
+
+uint32_t flashlog_now(void) {
+  return time_base + (uint32_t)(time_us_64() / 1000000);
+}
+
+// ---------------------------------------------------------------------------
+// Consultas
+// ---------------------------------------------------------------------------
+
+// Último registro do tipo pedido, das páginas em RAM para as mais antigas
+bool flashlog_last(flashlog_type_t type, flashlog_record_t *out) {
+  last_ctx_t c = { .type = type };
+  if (page.len)
+    page_decode(&page, keep_last, &c);
+  if (!c.found && ready_full)
+    page_decode(&ready, keep_last, &c);
+  for (uint32_t k = 1; k <= FLASHLOG_PAGES && !c.found; ++k) {
+    const flashlog_page_t *pg = flash_page((write_page + FLASHLOG_PAGES - k) % FLASHLOG_PAGES);
+    if (pg->magic == FLASHLOG_MAGIC && page_valid(pg))
+      page_decode(pg, keep_last, &c);
+  }
+  if (c.found)
+    *out = c.rec;
+  return c.found;
+}
+
+typedef struct {
+  uint32_t from_s, to_s;
+  flashlog_visit_fn visit;
+  void *ctx;
+  size_t count;
+} range_ctx_t;
+
+static void visit_range(const flashlog_record_t *r, void *ctx) {
+  range_ctx_t *c = ctx;
+  if (r->t_s >= c->from_s && r->t_s <= c->to_s) {
+    c->visit(r, c->ctx);
+    c->count++;
+  }
+}
+
+// Setor mais antigo na ordem do anel: o primeiro com dados depois do atual
+static uint32_t oldest_sector(void) {
+  uint32_t current = sector_of(write_page);
+  for (uint32_t i = 1; i <= FLASHLOG_SECTORS; ++i) {
+    uint32_t s = (current + i) % FLASHLOG_SECTORS;
+    if (sector_t0[s] != FLASHLOG_NONE)
+      return s;
+  }
+  return current;
+}
+
+// Registros com from_s <= t <= to_s, em ordem. O índice por setor leva direto
+// ao último setor que começa antes de from_s; dali em diante só as páginas
+// necessárias são lidas, até a primeira que começa depois de to_s
+size_t flashlog_query(uint32_t from_s, uint32_t to_s, flashlog_visit_fn visit, void *ctx) {
+  range_ctx_t c = { from_s, to_s, visit, ctx, 0 };
+  uint32_t first = oldest_sector();
+  uint32_t current = sector_of(write_page);
+  uint32_t start = first;
+  for (uint32_t s = first;; s = (s + 1) % FLASHLOG_SECTORS) {
+    if (sector_t0[s] != FLASHLOG_NONE && sector_t0[s] <= from_s)
+      start = s;
+    if (s == current)
+      break;
+  }
+
+  // Páginas da flash, do setor inicial até a posição de escrita
+  uint32_t p = start * PAGES_PER_SECTOR;
+  if (start == current && sector_t0[start] == FLASHLOG_NONE)
+    p = write_page;
+  for (; p != write_page; p = (p + 1) % FLASHLOG_PAGES) {
+    const flashlog_page_t *pg = flash_page(p);
+    if (pg->magic != FLASHLOG_MAGIC || !page_valid(pg))
+      continue;
+    if (pg->t0 > to_s)
+      return c.count;
+    page_decode(pg, visit_range, &c);
+  }
+  // E as que ainda estão em RAM
+  if (ready_full && ready.t0 <= to_s)
+    page_decode(&ready, visit_range, &c);
+  if (page.len && page.t0 <= to_s)
+    page_decode(&page, visit_range, &c);
+  return c.count;
+}
+
+const flashlog_stats_t *flashlog_stats(void) {
+  uint32_t s = oldest_sector();
+  stats.write_page = write_page;
+  stats.oldest_t_s = sector_t0[s] != FLASHLOG_NONE ? sector_t0[s] : page.t0;
+  return &stats;
+}
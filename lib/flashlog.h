@@ -0,0 +1,62 @@
+#ifndef FLASHLOG_H
+#define FLASHLOG_H
+
+#include "pico/stdlib.h"
+#include "hardware/flash.h"
+
+// Histórico persistente num trecho reservado no fim da flash QSPI.
+//
+// O log é circular sobre FLASHLOG_SECTORS setores, então todos os setores são
+// apagados no mesmo ritmo (nivelamento de desgaste) e o mais antigo é o que se
+// perde. Os registros vão primeiro para uma página em RAM; quando ela enche,
+// é fechada com CRC e programada inteira (256 bytes) por flashlog_service(),
+// que também apaga com antecedência o setor seguinte. flashlog_append() nunca
+// toca a flash. Uma página cortada no meio por falta de energia falha no CRC e
+// é ignorada na próxima partida.
+//
+// A placa não tem RTC: o tempo do log é o de operação, em segundos, somado
+// entre as partidas (o tempo desligado não conta).
+
+#define FLASHLOG_SECTORS   64                                   // 256 KB
+#define FLASHLOG_SIZE      (FLASHLOG_SECTORS * FLASH_SECTOR_SIZE)
+#define FLASHLOG_OFFSET    (PICO_FLASH_SIZE_BYTES - FLASHLOG_SIZE)
+#define FLASHLOG_PAGES     (FLASHLOG_SIZE / FLASH_PAGE_SIZE)
+#define FLASHLOG_VALUES    4
+
+typedef enum {
+  FLASHLOG_SAMPLE = 1,             // v: temperatura, umidade, luminosidade, som em dBFS (décimos)
+  FLASHLOG_WATER,                  // v[0]: origem da rega (ver o firmware)
+  FLASHLOG_COUNTERS,               // v: contadores do firmware a restaurar
+  FLASHLOG_BOOT,                   // v[0]: número da partida
+  FLASHLOG_HEALTH,                 // v: regras violadas (máscara), pontuação, perfil
+  FLASHLOG_IRRIGATION,             // v: fim do ciclo de rega, pulsos, ms de bomba, umidade (décimos)
+} flashlog_type_t;
+
+typedef struct {
+  uint8_t type;
+  uint32_t t_s;                    // Segundos de operação
+  int32_t v[FLASHLOG_VALUES];
+} flashlog_record_t;
+
+typedef struct {
+  uint32_t boots;
+  uint32_t pages_written;          // Desde a partida
+  uint32_t sectors_erased;
+  uint32_t bad_pages;              // Páginas cortadas ou corrompidas encontradas
+  uint32_t dropped;                // Registros recusados com a página cheia na fila
+  uint32_t write_page;             // Próxima página a programar (índice na região)
+  uint32_t oldest_t_s;
+} flashlog_stats_t;
+
+typedef void (*flashlog_visit_fn)(const flashlog_record_t *r, void *ctx);
+
+void flashlog_init(void);
+uint32_t flashlog_now(void);
+bool flashlog_append(flashlog_record_t *r);
+void flashlog_seal(void);
+bool flashlog_service(void);
+bool flashlog_last(flashlog_type_t type, flashlog_record_t *out);
+size_t flashlog_query(uint32_t from_s, uint32_t to_s, flashlog_visit_fn visit, void *ctx);
+const flashlog_stats_t *flashlog_stats(void);
+
+#endif
@@ -88,3 +88,20 @@ static uint8_t font[] = {
     0x00,0x00,0x00,0x60,0x60,0x00,0x00,0x00,  // .
     0x00,0x40,0x20,0x10,0x08,0x04,0x00,0x00,  // /
 };
+
+// Índice (em glifos) de cada caractere ASCII dentro de font[], montado em tempo
+// de compilação. Caracteres sem glifo apontam para o glifo 0 (vazio).
+#define FONT_RUN1(c, g)  [(c)] = (g)
+#define FONT_RUN2(c, g)  FONT_RUN1(c, g), FONT_RUN1((c) + 1, (g) + 1)
+#define FONT_RUN4(c, g)  FONT_RUN2(c, g), FONT_RUN2((c) + 2, (g) + 2)
+#define FONT_RUN8(c, g)  FONT_RUN4(c, g), FONT_RUN4((c) + 4, (g) + 4)
+#define FONT_RUN16(c, g) FONT_RUN8(c, g), FONT_RUN8((c) + 8, (g) + 8)
+
+static const uint8_t font_glyph[128] = {
+  FONT_RUN8('0', 1), FONT_RUN2('8', 9),                         // 0-9
+  FONT_RUN16('A', 11), FONT_RUN8('Q', 27), FONT_RUN2('Y', 35),  // A-Z
+  FONT_RUN16('a', 37), FONT_RUN8('q', 53), FONT_RUN2('y', 61),  // a-z
+  FONT_RUN4(':', 63), FONT_RUN2('>', 67),                       // : ; < = > ?
+  FONT_RUN8('!', 69), FONT_RUN4(')', 77), FONT_RUN2('-', 81),   // ! a /
+  FONT_RUN1('/', 83),
+};
@@ -0,0 +1,57 @@
+#include "health.h"
+
+// Sensor e sentido de cada regra: abaixo do limite ou acima dele
+static const struct {
+  uint8_t sensor;
+  bool above;
+  const char *name;
+} rules[HEALTH_RULE_COUNT] = {
+  [HEALTH_LIGHT_LOW]  = { SENSOR_LUMI,    false, "pouca luz" },
+  [HEALTH_LIGHT_HIGH] = { SENSOR_LUMI,    true,  "luz demais" },
+  [HEALTH_TEMP_LOW]   = { SENSOR_TEMP,    false, "frio" },
+  [HEALTH_TEMP_HIGH]  = { SENSOR_TEMP,    true,  "calor" },
+  [HEALTH_SOIL_DRY]   = { SENSOR_UMIDADE, false, "solo seco" },
+  [HEALTH_SOIL_WET]   = { SENSOR_UMIDADE, true,  "encharcado" },
+};
+
+// Ordem das regras: luz baixa/alta, temperatura baixa/alta, umidade baixa/alta;
+// depois a faixa da rega e os segundos de bomba por ciclo e por dia.
+// O perfil padrão reproduz os limites e a contagem de problemas de antes
+const health_profile_t health_profiles[] = {
+  { "padrao",     { 50, 90, 20, 35, 10, 50 }, { 1, 1, 1, 1, 1, 1 }, { 25, 35 }, 8, 24 },
+  { "suculenta",  { 60, 100, 10, 38, 5, 35 }, { 1, 1, 2, 1, 1, 3 }, { 10, 20 }, 4, 8 },    // Encharcar apodrece a raiz
+  { "samambaia",  { 20, 60, 16, 28, 40, 80 }, { 1, 2, 1, 2, 3, 1 }, { 50, 65 }, 10, 40 },  // Seca e sol direto queimam
+  { "horta",      { 60, 95, 18, 30, 30, 70 }, { 2, 1, 1, 2, 2, 1 }, { 40, 55 }, 10, 40 },
+};
+const uint8_t health_profile_count = sizeof(health_profiles) / sizeof(health_profiles[0]);
+
+static const char *const level_names[] = {
+  [HEALTH_OK] = "saudavel",
+  [HEALTH_MILD] = "leve estresse",
+  [HEALTH_MEDIUM] = "medio estresse",
+  [HEALTH_SEVERE] = "grave estresse",
+};
+
+// Uma passada pelas regras; só lê o perfil e as leituras (Q8), pode ser
+// chamada de qualquer núcleo ou tarefa
+void health_evaluate(const health_profile_t *p, const int32_t value_q8[SENSOR_COUNT], health_result_t *out) {
+  uint8_t violated = 0, score = 0;
+  for (uint8_t i = 0; i < HEALTH_RULE_COUNT; ++i) {
+    int v = Q8_INT(value_q8[rules[i].sensor]);   // Inteiros, como os limites
+    if (rules[i].above ? v > p->limit[i] : v < p->limit[i]) {
+      violated |= 1u << i;
+      score += p->severity[i];
+    }
+  }
+  out->violated = violated;
+  out->score = score;
+  out->level = score >= HEALTH_SEVERE ? HEALTH_SEVERE : score;
+}
+
+const char *health_level_name(health_level_t level) {
+  return level <= HEALTH_SEVERE ? level_names[level] : "?";
+}
+
+const char *health_rule_name(health_rule_id_t rule) {
+  return rule < HEALTH_RULE_COUNT ? rules[rule].name : "?";
+}
@@ -0,0 +1,54 @@
+#ifndef HEALTH_H
+#define HEALTH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sensor_conv.h"
+
+// Avaliação da saúde da planta por tabela. As regras (sensor e sentido) são
+// fixas; cada perfil de espécie traz o limite e a severidade de cada uma (e
+// a faixa e os volumes da rega automática, usados com lib/irrigation).
+// health_evaluate() passa uma vez pelas regras sobre uma foto das leituras e
+// não guarda estado: o resultado (máscara das regras violadas e pontuação)
+// serve à tela, ao alerta e ao histórico sem nova avaliação.
+
+typedef enum {
+  HEALTH_LIGHT_LOW,
+  HEALTH_LIGHT_HIGH,
+  HEALTH_TEMP_LOW,
+  HEALTH_TEMP_HIGH,
+  HEALTH_SOIL_DRY,
+  HEALTH_SOIL_WET,
+  HEALTH_RULE_COUNT
+} health_rule_id_t;
+
+typedef enum {
+  HEALTH_OK,
+  HEALTH_MILD,
+  HEALTH_MEDIUM,
+  HEALTH_SEVERE,
+} health_level_t;
+
+typedef struct {
+  const char *name;                        // Até 10 caracteres (cabe na tela)
+  int8_t limit[HEALTH_RULE_COUNT];         // Unidades inteiras do sensor da regra
+  uint8_t severity[HEALTH_RULE_COUNT];     // Peso na pontuação, 1 a 3
+  uint8_t water_band[2];                   // Faixa alvo da rega automática (% de umidade)
+  uint8_t water_cycle_s;                   // Bomba por ciclo de rega (limite de volume)
+  uint8_t water_day_s;                     // Bomba por dia
+} health_profile_t;
+
+typedef struct {
+  uint8_t violated;                        // Bit (1 << health_rule_id_t) por regra violada
+  uint8_t score;                           // Soma das severidades violadas
+  uint8_t level;                           // health_level_t
+} health_result_t;
+
+extern const health_profile_t health_profiles[];
+extern const uint8_t health_profile_count;
+
+void health_evaluate(const health_profile_t *p, const int32_t value_q8[SENSOR_COUNT], health_result_t *out);
+const char *health_level_name(health_level_t level);
+const char *health_rule_name(health_rule_id_t rule);
+
+#endif
@@ -0,0 +1,187 @@
+#include <stdio.h>
+#include "input.h"
+#include "scheduler.h"
+#include "spsc.h"
+#include "trace.h"
+#include "hardware/gpio.h"
+#include "hardware/sync.h"
+#include "hardware/timer.h"
+
+typedef struct {
+  input_button_cfg_t cfg;
+  volatile bool pressed;           // Nível depois do debounce
+  bool settling;                   // Alarme de debounce armado
+  alarm_id_t alarm;                // Debounce ou, segurado, LONG/REPEAT
+  uint32_t edge_us;                // Primeira borda da rajada atual
+  uint16_t repeats;
+} button_t;
+
+typedef struct {
+  input_axis_cfg_t cfg;
+  volatile uint8_t zone;
+} axis_t;
+
+static button_t buttons[INPUT_MAX_BUTTONS];
+static uint8_t button_count;
+static axis_t axes[INPUT_MAX_AXES];
+static uint8_t axis_count;
+static int8_t button_of_gpio[32];
+
+SPSC_STORAGE(queue_buf, input_event_t, INPUT_QUEUE_LEN);
+static spsc_queue_t queue;
+static int consumer = SCHED_NO_TASK;
+static uint32_t consumer_events;
+static input_stats_t stats;
+
+void input_init(int task, uint32_t task_events) {
+  spsc_init(&queue, queue_buf, sizeof(input_event_t), INPUT_QUEUE_LEN);
+  consumer = task;
+  consumer_events = task_events;
+  button_count = axis_count = 0;
+  for (uint i = 0; i < count_of(button_of_gpio); ++i)
+    button_of_gpio[i] = -1;
+  stats = (input_stats_t){ 0 };
+}
+
+// Produtores: os callbacks de GPIO e de alarme (mesma prioridade no núcleo 0,
+// um não interrompe o outro) e input_axis_update, que entra com as
+// interrupções desligadas. A fila segue com um produtor por vez
+static void emit(uint8_t type, uint8_t source, uint16_t value, uint32_t t_us) {
+  input_event_t e = { type, source, value, t_us };
+  if (!spsc_push(&queue, &e)) {
+    stats.dropped++;
+    return;
+  }
+  stats.events[type]++;
+  TRACE(TRACE_INPUT, (source << 4) | type);
+  sched_post(consumer, consumer_events);
+}
+
+// Segurado: primeiro o LONG, depois um REPEAT a cada repeat_ms, no ritmo do
+// horário previsto (o retorno negativo não acumula o atraso do callback)
+static int64_t hold_cb(alarm_id_t id, void *user_data) {
+  button_t *b = user_data;
+  if (!b->pressed) {
+    b->alarm = 0;
+    return 0;
+  }
+  emit(b->repeats ? INPUT_REPEAT : INPUT_LONG, b - buttons, b->repeats, time_us_32());
+  b->repeats++;
+  if (!b->cfg.repeat_ms) {
+    b->alarm = 0;
+    return 0;
+  }
+  return -(int64_t)b->cfg.repeat_ms * 1000;
+}
+
+// Fim do debounce: vale o nível de agora. Uma rajada que voltou ao nível
+// anterior (ruído, toque curto demais) não gera nada
+static int64_t debounce_cb(alarm_id_t id, void *user_data) {
+  button_t *b = user_data;
+  b->alarm = 0;
+  b->settling = false;
+  bool pressed = !gpio_get(b->cfg.gpio);
+  if (pressed == b->pressed)
+    return 0;
+  b->pressed = pressed;
+  emit(pressed ? INPUT_PRESS : INPUT_RELEASE, b - buttons, 0, b->edge_us);
+  if (pressed && b->cfg.long_ms) {
+    b->repeats = 0;
+    uint32_t wait_ms = b->cfg.long_ms > INPUT_DEBOUNCE_MS ? b->cfg.long_ms - INPUT_DEBOUNCE_MS : 1;
+    b->alarm = add_alarm_in_ms(wait_ms, hold_cb, b, true);
+  }
+  return 0;
+}
+
+// Toda borda reinicia a espera; a primeira da rajada carimba o evento
+static void input_gpio_irq(uint gpio, uint32_t event_mask) {
+  TRACE(TRACE_ISR_GPIO, gpio);
+  if (gpio >= count_of(button_of_gpio) || button_of_gpio[gpio] < 0)
+    return;
+  button_t *b = &buttons[button_of_gpio[gpio]];
+  if (!b->settling) {
+    b->settling = true;
+    b->edge_us = time_us_32();
+  } else {
+    stats.bounces++;
+  }
+  if (b->alarm)
+    cancel_alarm(b->alarm);   // Também encerra o LONG/REPEAT de quem soltou
+  b->alarm = add_alarm_in_ms(INPUT_DEBOUNCE_MS, debounce_cb, b, true);
+}
+
+int input_add_button(const input_button_cfg_t *cfg) {
+  if (button_count >= INPUT_MAX_BUTTONS || cfg->gpio >= count_of(button_of_gpio))
+    return -1;
+  button_t *b = &buttons[button_count];
+  *b = (button_t){ .cfg = *cfg };
+  gpio_init(cfg->gpio);
+  gpio_set_dir(cfg->gpio, GPIO_IN);
+  gpio_pull_up(cfg->gpio);
+  b->pressed = !gpio_get(cfg->gpio);
+  button_of_gpio[cfg->gpio] = button_count;
+  gpio_set_irq_enabled_with_callback(cfg->gpio, GPIO_IRQ_EDGE_FALL | GPIO_IRQ_EDGE_RISE, true, &input_gpio_irq);
+  return button_count++;
+}
+
+int input_add_axis(const input_axis_cfg_t *cfg) {
+  if (axis_count >= INPUT_MAX_AXES)
+    return -1;
+  axes[axis_count] = (axis_t){ .cfg = *cfg, .zone = INPUT_ZONE_CENTER };
+  return axis_count++;
+}
+
+// Chamada por quem lê o eixo (tarefa, não ISR), a cada valor novo
+void input_axis_update(int axis, uint16_t value) {
+  if (axis < 0 || axis >= axis_count)
+    return;
+  axis_t *a = &axes[axis];
+  bool low = hyst_update(&a->cfg.low, value);
+  bool high = hyst_update(&a->cfg.high, value);
+  uint8_t zone = high ? INPUT_ZONE_HIGH : low ? INPUT_ZONE_LOW : INPUT_ZONE_CENTER;
+  if (zone == a->zone)
+    return;
+  a->zone = zone;
+  uint32_t irq_state = save_and_disable_interrupts();
+  emit(INPUT_AXIS, axis, zone, time_us_32());
+  restore_interrupts(irq_state);
+}
+
+bool input_pop(input_event_t *e) {
+  return spsc_pop(&queue, e);
+}
+
+bool input_held(int button) {
+  return button >= 0 && button < button_count && buttons[button].pressed;
+}
+
+input_zone_t input_axis_zone(int axis) {
+  return axis >= 0 && axis < axis_count ? axes[axis].zone : INPUT_ZONE_CENTER;
+}
+
+// Fim da reação ao evento: latência desde a origem (inclui o debounce)
+void input_done(const input_event_t *e) {
+  uint32_t latency = time_us_32() - e->t_us;
+  stats.reactions[e->type]++;
+  stats.latency_sum_us[e->type] += latency;
+  if (latency > stats.latency_max_us[e->type])
+    stats.latency_max_us[e->type] = latency;
+  TRACE(TRACE_INPUT_DONE, (e->source << 4) | e->type);
+}
+
+const input_stats_t *input_stats(void) {
+  return &stats;
+}
+
+void input_print_stats(void) {
+  static const char *const names[INPUT_TYPES] = { "aperta", "solta", "longo", "repete", "eixo" };
+  printf("entrada: %lu repiques, %lu descartados\n", (unsigned long)stats.bounces, (unsigned long)stats.dropped);
+  printf("evento   gerados reacoes media(us)  pior(us)\n");
+  for (uint i = 0; i < INPUT_TYPES; ++i) {
+    if (!stats.events[i])
+      continue;
+    uint32_t n = stats.reactions[i];
+    printf("%-8s %7lu %7lu %9lu %9lu\n", names[i], (unsigned long)stats.events[i], (unsigned long)n,
+           (unsigned long)(n ? stats.latency_sum_us[i] / n : 0), (unsigned long)stats.latency_max_us[i]);
+  }
+}
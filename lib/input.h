@@ -0,0 +1,76 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+#include "pico/stdlib.h"
+#include "filters.h"
+
+// Entrada por interrupção. Cada borda de um botão (re)arma um alarme de
+// debounce; com o nível estável por INPUT_DEBOUNCE_MS o alarme gera PRESS ou
+// RELEASE. Segurado, o botão gera LONG depois de long_ms e REPEAT a cada
+// repeat_ms. Eixos analógicos entram por input_axis_update (quem lê o ADC
+// chama) e geram AXIS ao mudar de zona, com histerese nas duas pontas.
+//
+// Os eventos vão para uma fila SPSC e a tarefa consumidora é acordada por
+// sched_post. Cada evento leva o instante da primeira borda (ou da leitura
+// do eixo); input_done() ao fim da reação mede a latência de ponta a ponta.
+// Instala o callback de GPIO do núcleo 0: não usar junto com sched_bind_gpio.
+
+#define INPUT_MAX_BUTTONS 4
+#define INPUT_MAX_AXES    2
+#define INPUT_QUEUE_LEN   16           // Potência de 2
+#define INPUT_DEBOUNCE_MS 20
+
+typedef enum {
+  INPUT_PRESS,
+  INPUT_RELEASE,
+  INPUT_LONG,
+  INPUT_REPEAT,
+  INPUT_AXIS,
+  INPUT_TYPES
+} input_type_t;
+
+typedef enum {
+  INPUT_ZONE_LOW,
+  INPUT_ZONE_CENTER,
+  INPUT_ZONE_HIGH,
+} input_zone_t;
+
+typedef struct {
+  uint8_t type;                    // input_type_t
+  uint8_t source;                  // Botão ou eixo, na ordem do cadastro
+  uint16_t value;                  // AXIS: input_zone_t; REPEAT: repetições até aqui
+  uint32_t t_us;                   // Origem do evento (time_us_32)
+} input_event_t;
+
+typedef struct {
+  uint gpio;                       // Ativo em nível baixo, com pull-up
+  uint16_t long_ms;                // 0: sem LONG nem REPEAT
+  uint16_t repeat_ms;              // 0: só o LONG
+} input_button_cfg_t;
+
+typedef struct {
+  hysteresis_t low;                // HYST_BELOW: zona baixa
+  hysteresis_t high;               // HYST_ABOVE: zona alta
+} input_axis_cfg_t;
+
+typedef struct {
+  uint32_t events[INPUT_TYPES];    // Enfileirados por tipo
+  uint32_t dropped;                // Fila cheia
+  uint32_t bounces;                // Bordas a mais dentro do debounce
+  uint32_t reactions[INPUT_TYPES]; // input_done por tipo
+  uint32_t latency_max_us[INPUT_TYPES];
+  uint64_t latency_sum_us[INPUT_TYPES];
+} input_stats_t;
+
+void input_init(int task, uint32_t task_events);
+int input_add_button(const input_button_cfg_t *cfg);
+int input_add_axis(const input_axis_cfg_t *cfg);
+void input_axis_update(int axis, uint16_t value);
+bool input_pop(input_event_t *e);
+bool input_held(int button);
+input_zone_t input_axis_zone(int axis);
+void input_done(const input_event_t *e);
+const input_stats_t *input_stats(void);
+void input_print_stats(void);
+
+#endif
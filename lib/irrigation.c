@@ -0,0 +1,128 @@
+#include "irrigation.h"
+
+void irrigation_init(irrigation_t *c, const irrigation_config_t *cfg) {
+  c->cfg = cfg;
+  c->state = IRRIGATION_IDLE;
+  c->last_end = IRRIGATION_END_NONE;
+  c->cycle_ended = false;
+  c->no_response = 0;
+  c->t_state = 0;
+  c->before_q8 = 0;
+  c->pulses = 0;
+  c->cycle_ms = 0;
+  c->day_ms = 0;
+}
+
+static void set_state(irrigation_t *c, irrigation_state_t state, uint32_t now_ms) {
+  c->state = state;
+  c->t_state = now_ms;
+}
+
+static void start_pulse(irrigation_t *c, uint32_t now_ms, int32_t moisture_q8) {
+  c->before_q8 = moisture_q8;
+  c->pulses++;
+  set_state(c, IRRIGATION_PULSE, now_ms);
+}
+
+// Fecha o ciclo; as falhas deixam o controlador parado até irrigation_clear()
+static void end_cycle(irrigation_t *c, irrigation_end_t why, uint32_t now_ms) {
+  irrigation_state_t next = IRRIGATION_IDLE;
+  if (why == IRRIGATION_END_DRY)
+    next = IRRIGATION_FAULT_DRY;
+  else if (why == IRRIGATION_END_OVERFLOW)
+    next = IRRIGATION_FAULT_OVERFLOW;
+  set_state(c, next, now_ms);
+  c->last_end = why;
+  c->cycle_ended = true;
+}
+
+// Chamada periodicamente com a umidade filtrada; retorna se a bomba deve
+// ficar ligada. 'enabled' em false interrompe o ciclo em andamento
+bool irrigation_update(irrigation_t *c, uint32_t now_ms, int32_t moisture_q8, bool enabled) {
+  const irrigation_config_t *cfg = c->cfg;
+  uint32_t elapsed = now_ms - c->t_state;
+  int32_t target = (cfg->low_q8 + cfg->high_q8) / 2;
+
+  if (c->state == IRRIGATION_PULSE || c->state == IRRIGATION_SOAK) {
+    if (!enabled) {
+      if (c->state == IRRIGATION_PULSE) {
+        c->cycle_ms += elapsed;
+        c->day_ms += elapsed;
+      }
+      end_cycle(c, IRRIGATION_END_STOPPED, now_ms);
+      return false;
+    }
+    if (moisture_q8 > cfg->overflow_q8) {
+      end_cycle(c, IRRIGATION_END_OVERFLOW, now_ms);
+      return false;
+    }
+  }
+
+  switch (c->state) {
+    case IRRIGATION_IDLE:
+      if (!enabled || moisture_q8 >= cfg->low_q8)
+        break;
+      if (c->last_end != IRRIGATION_END_NONE && elapsed < cfg->rest_ms)
+        break;
+      if (c->day_ms + cfg->pulse_ms > cfg->day_max_ms)
+        break;                   // Volume do dia esgotado: espera irrigation_new_day()
+      c->pulses = 0;
+      c->cycle_ms = 0;
+      c->no_response = 0;
+      start_pulse(c, now_ms, moisture_q8);
+      break;
+
+    case IRRIGATION_PULSE:
+      if (elapsed >= cfg->pulse_ms) {
+        c->cycle_ms += elapsed;
+        c->day_ms += elapsed;
+        set_state(c, IRRIGATION_SOAK, now_ms);
+      }
+      break;
+
+    case IRRIGATION_SOAK:
+      if (elapsed < cfg->soak_ms)
+        break;
+      // A umidade só é comparada depois da infiltração: medir durante o pulso
+      // veria o solo ainda seco e mandaria mais água do que o necessário
+      if (moisture_q8 - c->before_q8 < cfg->min_rise_q8)
+        c->no_response++;
+      else
+        c->no_response = 0;
+
+      if (moisture_q8 >= target)
+        end_cycle(c, IRRIGATION_END_TARGET, now_ms);
+      else if (c->no_response >= cfg->dry_pulses)
+        end_cycle(c, IRRIGATION_END_DRY, now_ms);
+      else if (c->cycle_ms + cfg->pulse_ms > cfg->cycle_max_ms)
+        end_cycle(c, IRRIGATION_END_CYCLE_LIMIT, now_ms);
+      else if (c->day_ms + cfg->pulse_ms > cfg->day_max_ms)
+        end_cycle(c, IRRIGATION_END_DAY_LIMIT, now_ms);
+      else
+        start_pulse(c, now_ms, moisture_q8);
+      break;
+
+    default:
+      break;
+  }
+  return irrigation_pump(c);
+}
+
+// Libera o controlador depois de uma falha (quem chama decide quando: o
+// usuário conferiu o reservatório ou o vaso)
+void irrigation_clear(irrigation_t *c) {
+  if (irrigation_fault(c))
+    c->state = IRRIGATION_IDLE;
+  c->no_response = 0;
+}
+
+void irrigation_new_day(irrigation_t *c) {
+  c->day_ms = 0;
+}
+
+// True uma vez por ciclo encerrado (last_end diz como), para registrar o fim
+bool irrigation_take_end(irrigation_t *c) {
+  bool ended = c->cycle_ended;
+  c->cycle_ended = false;
+  return ended;
+}
@@ -0,0 +1,75 @@
+#ifndef IRRIGATION_H
+#define IRRIGATION_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Rega em malha fechada: a bomba liga em pulsos curtos e, depois de cada um,
+// espera a água infiltrar (soak) antes de comparar a umidade com a de antes
+// do pulso. O ciclo começa abaixo da faixa alvo e para ao chegar no meio
+// dela. Proteções: limite de bomba por ciclo e por dia (o volume, já que a
+// placa não mede vazão), pulsos sem resposta seguidos (bomba a seco ou
+// sensor solto) e umidade acima do limite de encharcamento (transbordo).
+//
+// Só lógica: recebe o tempo e a umidade filtrada e devolve o estado da bomba,
+// sem tocar em GPIO; quem chama liga o pino e registra os eventos.
+
+typedef struct {
+  int32_t low_q8, high_q8;         // Faixa alvo de umidade (%, Q8)
+  int32_t overflow_q8;             // Acima disto com o ciclo ativo: transbordo
+  int32_t min_rise_q8;             // Subida mínima esperada depois de um pulso
+  uint16_t pulse_ms;
+  uint16_t soak_ms;
+  uint8_t dry_pulses;              // Pulsos seguidos sem subir até acusar falta de água
+  uint32_t cycle_max_ms;           // Bomba ligada por ciclo
+  uint32_t day_max_ms;             // Bomba ligada por dia
+  uint32_t rest_ms;                // Espera entre o fim de um ciclo e o próximo
+} irrigation_config_t;
+
+typedef enum {
+  IRRIGATION_IDLE,
+  IRRIGATION_PULSE,                // Bomba ligada
+  IRRIGATION_SOAK,                 // Bomba desligada, esperando infiltrar
+  IRRIGATION_FAULT_DRY,            // Pulsos sem resposta: parada até irrigation_clear()
+  IRRIGATION_FAULT_OVERFLOW,       // Solo encharcou durante o ciclo: idem
+} irrigation_state_t;
+
+// Como terminou o último ciclo
+typedef enum {
+  IRRIGATION_END_NONE,
+  IRRIGATION_END_TARGET,           // Chegou na faixa
+  IRRIGATION_END_CYCLE_LIMIT,      // Esgotou o volume do ciclo
+  IRRIGATION_END_DAY_LIMIT,        // Esgotou o volume do dia
+  IRRIGATION_END_DRY,
+  IRRIGATION_END_OVERFLOW,
+  IRRIGATION_END_STOPPED,          // Desarmada no meio do ciclo
+} irrigation_end_t;
+
+typedef struct {
+  const irrigation_config_t *cfg;
+  uint8_t state;                   // irrigation_state_t
+  uint8_t last_end;                // irrigation_end_t
+  bool cycle_ended;                // Fim de ciclo ainda não lido por irrigation_take_end()
+  uint8_t no_response;
+  uint32_t t_state;                // Entrada no estado atual (ms)
+  int32_t before_q8;               // Umidade no início do pulso
+  uint16_t pulses;                 // Pulsos no ciclo atual
+  uint32_t cycle_ms;               // Bomba ligada no ciclo atual
+  uint32_t day_ms;                 // Bomba ligada desde o último irrigation_new_day()
+} irrigation_t;
+
+void irrigation_init(irrigation_t *c, const irrigation_config_t *cfg);
+bool irrigation_update(irrigation_t *c, uint32_t now_ms, int32_t moisture_q8, bool enabled);
+void irrigation_clear(irrigation_t *c);
+void irrigation_new_day(irrigation_t *c);
+bool irrigation_take_end(irrigation_t *c);
+
+static inline bool irrigation_pump(const irrigation_t *c) {
+  return c->state == IRRIGATION_PULSE;
+}
+
+static inline bool irrigation_fault(const irrigation_t *c) {
+  return c->state >= IRRIGATION_FAULT_DRY;
+}
+
+#endif
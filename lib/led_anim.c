@@ -0,0 +1,117 @@
+#include <string.h>
+#include "led_anim.h"
+
+// Correção de gama 2.2 (valor linear -> nível do LED)
+static const uint8_t gamma8[256] = {
+    0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   1,
+    1,   1,   1,   1,   1,   1,   1,   1,   1,   2,   2,   2,   2,   2,   2,   2,
+    3,   3,   3,   3,   3,   4,   4,   4,   4,   5,   5,   5,   5,   6,   6,   6,
+    6,   7,   7,   7,   8,   8,   8,   9,   9,   9,  10,  10,  11,  11,  11,  12,
+   12,  13,  13,  13,  14,  14,  15,  15,  16,  16,  17,  17,  18,  18,  19,  19,
+   20,  20,  21,  22,  22,  23,  23,  24,  25,  25,  26,  26,  27,  28,  28,  29,
+   30,  30,  31,  32,  33,  33,  34,  35,  35,  36,  37,  38,  39,  39,  40,  41,
+   42,  43,  43,  44,  45,  46,  47,  48,  49,  49,  50,  51,  52,  53,  54,  55,
+   56,  57,  58,  59,  60,  61,  62,  63,  64,  65,  66,  67,  68,  69,  70,  71,
+   73,  74,  75,  76,  77,  78,  79,  81,  82,  83,  84,  85,  87,  88,  89,  90,
+   91,  93,  94,  95,  97,  98,  99, 100, 102, 103, 105, 106, 107, 109, 110, 111,
+  113, 114, 116, 117, 119, 120, 121, 123, 124, 126, 127, 129, 130, 132, 133, 135,
+  137, 138, 140, 141, 143, 145, 146, 148, 149, 151, 153, 154, 156, 158, 159, 161,
+  163, 165, 166, 168, 170, 172, 173, 175, 177, 179, 181, 182, 184, 186, 188, 190,
+  192, 194, 196, 197, 199, 201, 203, 205, 207, 209, 211, 213, 215, 217, 219, 221,
+  223, 225, 227, 229, 231, 234, 236, 238, 240, 242, 244, 246, 248, 251, 253, 255,
+};
+
+void led_anim_init(led_anim_t *anim, ws2812b_t *strip) {
+  memset(anim, 0, sizeof(*anim));
+  anim->strip = strip;
+  led_anim_set_brightness(anim, 255, 255, 255);
+}
+
+// Recalcula as tabelas de saída: gama seguida do brilho máximo de cada canal
+void led_anim_set_brightness(led_anim_t *anim, uint8_t r, uint8_t g, uint8_t b) {
+  const uint8_t scale[3] = { r, g, b };
+  for (int c = 0; c < 3; ++c)
+    for (int v = 0; v < 256; ++v)
+      anim->lut[c][v] = (gamma8[v] * scale[c] + 127) / 255;
+}
+
+static void led_anim_target(const anim_key_t *k, uint8_t i, uint8_t out[3]) {
+  bool on = k->mask & ANIM_LED(i);
+  out[0] = on ? k->r : 0;
+  out[1] = on ? k->g : 0;
+  out[2] = on ? k->b : 0;
+}
+
+// Desenha a chave atual no instante 'elapsed' e publica o quadro
+static void led_anim_render(led_anim_t *anim, const anim_key_t *k, uint32_t elapsed) {
+  uint32_t t = (k->fade_ms && elapsed < k->fade_ms) ? (elapsed << 8) / k->fade_ms : 256;
+  for (uint8_t i = 0; i < anim->strip->n_leds; ++i) {
+    uint8_t to[3];
+    led_anim_target(k, i, to);
+    for (int c = 0; c < 3; ++c) {
+      int32_t from = anim->from[i][c];
+      anim->cur[i][c] = from + (((int32_t)to[c] - from) * (int32_t)t >> 8);
+    }
+    ws2812b_set(anim->strip, i, anim->lut[0][anim->cur[i][0]], anim->lut[1][anim->cur[i][1]],
+                anim->lut[2][anim->cur[i][2]]);
+  }
+  ws2812b_show(anim->strip);
+  anim->settled = (t == 256);
+}
+
+// Começa o clipe a partir das cores que estão na matriz; o tempo conta do próximo tick
+void led_anim_play(led_anim_t *anim, const anim_clip_t *clip, anim_done_fn_t done, void *user) {
+  memcpy(anim->from, anim->cur, sizeof(anim->from));
+  anim->clip = (clip && clip->n_keys) ? clip : NULL;
+  anim->key = 0;
+  anim->settled = false;
+  anim->started = false;
+  anim->done = done;
+  anim->user = user;
+}
+
+// Interrompe sem chamar o término e apaga a matriz
+void led_anim_stop(led_anim_t *anim) {
+  anim->clip = NULL;
+  memset(anim->cur, 0, sizeof(anim->cur));
+  ws2812b_clear(anim->strip);
+  ws2812b_show(anim->strip);
+}
+
+// Avança o clipe até now_ms; só publica quadro quando algo mudou.
+// Retorna true enquanto houver clipe tocando.
+bool led_anim_tick(led_anim_t *anim, uint32_t now_ms) {
+  const anim_clip_t *clip = anim->clip;
+  if (!clip)
+    return false;
+  if (!anim->started) {
+    anim->started = true;
+    anim->key_start_ms = now_ms;
+  }
+
+  const anim_key_t *k = &clip->keys[anim->key];
+  uint32_t elapsed = now_ms - anim->key_start_ms;
+  // Com atraso, pula chaves vencidas; no máximo uma volta por tick
+  for (uint8_t skipped = 0; elapsed >= k->duration_ms && skipped < clip->n_keys; ++skipped) {
+    for (uint8_t i = 0; i < anim->strip->n_leds; ++i)
+      led_anim_target(k, i, anim->from[i]);
+    anim->key_start_ms += k->duration_ms;
+    anim->settled = false;
+    if (++anim->key == clip->n_keys) {
+      if (!clip->loop) {
+        anim_done_fn_t done = anim->done;
+        led_anim_stop(anim);
+        if (done)
+          done(clip, anim->user);
+        return anim->clip != NULL;     // O término pode ter encadeado outro clipe
+      }
+      anim->key = 0;
+    }
+    k = &clip->keys[anim->key];
+    elapsed = now_ms - anim->key_start_ms;
+  }
+
+  if (!anim->settled)
+    led_anim_render(anim, k, elapsed);
+  return true;
+}
@@ -0,0 +1,60 @@
+#ifndef LED_ANIM_H
+#define LED_ANIM_H
+
+#include "pico/stdlib.h"
+#include "ws2812b.h"
+
+// Animações da matriz 5x5 descritas por quadros-chave: cada chave acende um
+// conjunto de LEDs (máscara de 25 bits) com uma cor, com transição (fade) a
+// partir do estado anterior. As tabelas são const e ficam na flash.
+
+#define ANIM_LED(i)   (1u << (i))
+#define ANIM_ROW(r)   (0x1Fu << (5 * (r)))    // Linha r (0 = linha de baixo)
+#define ANIM_ALL      0x1FFFFFFu
+
+typedef struct {
+  uint32_t mask;                   // LEDs acesos nesta chave (os demais apagam)
+  uint8_t r, g, b;                 // Cor linear, antes da correção de gama
+  uint16_t fade_ms;                // Duração da transição a partir da chave anterior
+  uint16_t duration_ms;            // Duração total da chave (inclui o fade)
+} anim_key_t;
+
+#define ANIM_KEY(mask, r, g, b, fade_ms, duration_ms) { (mask), (r), (g), (b), (fade_ms), (duration_ms) }
+
+typedef struct {
+  const anim_key_t *keys;
+  uint8_t n_keys;
+  bool loop;
+} anim_clip_t;
+
+#define ANIM_CLIP(keys, loop) { (keys), sizeof(keys) / sizeof((keys)[0]), (loop) }
+
+typedef void (*anim_done_fn_t)(const anim_clip_t *clip, void *user);
+
+typedef struct {
+  ws2812b_t *strip;
+  uint8_t lut[3][256];             // Gama + brilho por canal (R, G, B)
+
+  const anim_clip_t *clip;
+  uint8_t key;
+  uint32_t key_start_ms;
+  bool settled;                    // Chave atual já desenhada com a cor final
+  bool started;                    // key_start_ms ainda não foi fixado pelo primeiro tick
+  anim_done_fn_t done;
+  void *user;
+
+  uint8_t from[WS2812B_MAX_LEDS][3];   // Cor no início da transição
+  uint8_t cur[WS2812B_MAX_LEDS][3];    // Última cor desenhada
+} led_anim_t;
+
+void led_anim_init(led_anim_t *anim, ws2812b_t *strip);
+void led_anim_set_brightness(led_anim_t *anim, uint8_t r, uint8_t g, uint8_t b);
+void led_anim_play(led_anim_t *anim, const anim_clip_t *clip, anim_done_fn_t done, void *user);
+void led_anim_stop(led_anim_t *anim);
+bool led_anim_tick(led_anim_t *anim, uint32_t now_ms);
+
+static inline const anim_clip_t *led_anim_playing(const led_anim_t *anim) {
+  return anim->clip;
+}
+
+#endif
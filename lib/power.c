@@ -0,0 +1,101 @@
+#include <stdio.h>
+#include "power.h"
+#include "scheduler.h"
+
+static const power_state_desc_t *descs;
+static uint8_t n_states;
+static uint8_t current;
+static power_account_t accounts[POWER_MAX_STATES];
+static uint64_t mark_us, mark_busy_us;   // Até onde a conta já foi fechada
+
+void power_init(const power_state_desc_t *states, uint8_t count, uint8_t initial) {
+  descs = states;
+  n_states = count < POWER_MAX_STATES ? count : POWER_MAX_STATES;
+  for (uint8_t i = 0; i < POWER_MAX_STATES; ++i)
+    accounts[i] = (power_account_t){ 0 };
+  current = initial < n_states ? initial : 0;
+  accounts[current].entries = 1;
+  mark_us = time_us_64();
+  mark_busy_us = sched_busy_us();
+}
+
+// Lança no estado atual o tempo desde o último fechamento. Chamar ao menos
+// a cada poucos segundos para o relatório não ficar atrasado; a conta é a
+// mesma com qualquer ritmo
+void power_update(void) {
+  if (!descs)
+    return;
+  uint64_t now = time_us_64();
+  uint64_t busy = sched_busy_us();
+  uint64_t dt = now - mark_us;
+  uint64_t db = busy - mark_busy_us;
+  if (db > dt)
+    db = dt;   // Execução que atravessou o fechamento anterior
+  power_account_t *a = &accounts[current];
+  a->time_us += dt;
+  a->busy_us += db;
+  a->charge += db * descs[current].run_ua + (dt - db) * descs[current].idle_ua;
+  mark_us = now;
+  mark_busy_us = busy;
+}
+
+void power_set_state(uint8_t state) {
+  if (state >= n_states || state == current)
+    return;
+  power_update();
+  current = state;
+  accounts[state].entries++;
+}
+
+uint8_t power_state(void) {
+  return current;
+}
+
+const power_account_t *power_account(uint8_t state) {
+  return state < n_states ? &accounts[state] : NULL;
+}
+
+// Corrente média desde power_init, em µA
+uint32_t power_average_ua(void) {
+  power_update();
+  uint64_t time = 0, charge = 0;
+  for (uint8_t i = 0; i < n_states; ++i) {
+    time += accounts[i].time_us;
+    charge += accounts[i].charge;
+  }
+  return time ? (uint32_t)(charge / time) : 0;
+}
+
+static void print_row(const char *name, uint64_t time, uint64_t total, uint64_t busy, uint64_t charge,
+                      uint32_t entries, uint32_t battery_mah) {
+  uint32_t avg_ua = time ? (uint32_t)(charge / time) : 0;
+  uint32_t cpu_x10 = time ? (uint32_t)(busy * 1000 / time) : 0;
+  uint32_t uah = (uint32_t)(charge / 3600000000ull);
+  uint32_t hours_x10 = avg_ua ? (uint32_t)((uint64_t)battery_mah * 10000 / avg_ua) : 0;
+  printf("%-10s %9lu %5lu %4lu.%lu %8lu %5lu.%03lu %5lu.%lu %6lu.%lu\n", name, (unsigned long)(time / 1000000),
+         (unsigned long)(total ? time * 100 / total : 0), (unsigned long)(cpu_x10 / 10), (unsigned long)(cpu_x10 % 10),
+         (unsigned long)entries, (unsigned long)(uah / 1000), (unsigned long)(uah % 1000),
+         (unsigned long)(avg_ua / 1000), (unsigned long)(avg_ua % 1000 / 100), (unsigned long)(hours_x10 / 10),
+         (unsigned long)(hours_x10 % 10));
+}
+
+// Tempo, ocupação do núcleo 0, carga e corrente média por estado. A
+// autonomia de cada linha é a da bateria se a placa ficasse só naquele
+// estado; a do total é a projetada com a mistura observada até aqui
+void power_print(uint32_t battery_mah) {
+  power_update();
+  uint64_t time = 0, busy = 0, charge = 0;
+  uint32_t entries = 0;
+  for (uint8_t i = 0; i < n_states; ++i) {
+    time += accounts[i].time_us;
+    busy += accounts[i].busy_us;
+    charge += accounts[i].charge;
+    entries += accounts[i].entries;
+  }
+  printf("estado      tempo(s)     %%  cpu(%%) entradas  carga(mAh) media(mA) autonomia(h)\n");
+  for (uint8_t i = 0; i < n_states; ++i) {
+    const power_account_t *a = &accounts[i];
+    print_row(descs[i].name, a->time_us, time, a->busy_us, a->charge, a->entries, battery_mah);
+  }
+  print_row("total", time, time, busy, charge, entries, battery_mah);
+}
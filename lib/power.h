@@ -0,0 +1,36 @@
+#ifndef POWER_H
+#define POWER_H
+
+#include "pico/stdlib.h"
+
+// Contabilidade de energia por estado de operação. A placa não mede corrente:
+// o tempo em cada estado, separado entre o núcleo 0 executando tarefas e
+// dormindo em WFE (pelo escalonador), é multiplicado pela corrente estimada
+// do estado. A tabela de estados e correntes é de quem chama; trocar a tabela
+// ou a política de troca de estados e comparar a autonomia projetada é o uso
+// pretendido.
+
+#define POWER_MAX_STATES 4
+
+typedef struct {
+  const char *name;
+  uint32_t run_ua;                 // Corrente da placa com o núcleo 0 executando
+  uint32_t idle_ua;                // Idem com ele em WFE
+} power_state_desc_t;
+
+typedef struct {
+  uint64_t time_us;
+  uint64_t busy_us;                // Parte do tempo com tarefas executando
+  uint64_t charge;                 // Carga em µA·µs
+  uint32_t entries;
+} power_account_t;
+
+void power_init(const power_state_desc_t *states, uint8_t count, uint8_t initial);
+void power_set_state(uint8_t state);
+void power_update(void);
+uint8_t power_state(void);
+const power_account_t *power_account(uint8_t state);
+uint32_t power_average_ua(void);
+void power_print(uint32_t battery_mah);
+
+#endif
@@ -0,0 +1,108 @@
+#include "rollstats.h"
+
+// Largura e número de baldes de cada janela, e onde começa o anel dela
+typedef struct {
+  uint16_t width_s;
+  uint8_t len;
+  uint8_t first;
+} rollstats_tier_t;
+
+static const rollstats_tier_t tiers[ROLLSTATS_WINDOWS] = {
+  [ROLLSTATS_1MIN] = { 5, 12, 0 },
+  [ROLLSTATS_1H]   = { 60, 60, 12 },
+  [ROLLSTATS_24H]  = { 900, 96, 72 },
+};
+
+static void bucket_clear(rollstats_bucket_t *b) {
+  b->count = 0;
+  b->sum = 0;
+  b->sum_sq = 0;
+}
+
+void rollstats_init(rollstats_t *s) {
+  for (uint32_t i = 0; i < ROLLSTATS_BUCKETS; ++i)
+    bucket_clear(&s->buckets[i]);
+  for (uint32_t w = 0; w < ROLLSTATS_WINDOWS; ++w)
+    s->slot[w] = 0;
+  s->samples = 0;
+}
+
+// Leva a janela até 'now_s', zerando os baldes que saíram dela. Depois de
+// muito tempo parado zera no máximo o anel inteiro, então o custo é limitado
+static rollstats_bucket_t *roll(rollstats_t *s, rollstats_window_t w, uint32_t now_s) {
+  const rollstats_tier_t *t = &tiers[w];
+  uint32_t slot = now_s / t->width_s;
+  uint32_t gap = slot - s->slot[w];
+  if (gap > t->len)
+    gap = t->len;
+  for (uint32_t k = 1; k <= gap; ++k)
+    bucket_clear(&s->buckets[t->first + (s->slot[w] + k) % t->len]);
+  s->slot[w] = slot;
+  return &s->buckets[t->first + slot % t->len];
+}
+
+void rollstats_add(rollstats_t *s, uint32_t now_s, int32_t value) {
+  for (uint32_t w = 0; w < ROLLSTATS_WINDOWS; ++w) {
+    rollstats_bucket_t *b = roll(s, w, now_s);
+    if (b->count == 0 || value < b->min)
+      b->min = value;
+    if (b->count == 0 || value > b->max)
+      b->max = value;
+    b->count++;
+    b->sum += value;
+    b->sum_sq += (int64_t)value * value;
+  }
+  s->samples++;
+}
+
+// Combina os baldes da janela; retorna false se ela ainda não tem amostras
+bool rollstats_get(rollstats_t *s, rollstats_window_t w, uint32_t now_s, rollstats_summary_t *out) {
+  const rollstats_tier_t *t = &tiers[w];
+  roll(s, w, now_s);
+  rollstats_bucket_t acc = { 0 };
+  for (uint32_t i = 0; i < t->len; ++i) {
+    const rollstats_bucket_t *b = &s->buckets[t->first + i];
+    if (!b->count)
+      continue;
+    if (acc.count == 0 || b->min < acc.min)
+      acc.min = b->min;
+    if (acc.count == 0 || b->max > acc.max)
+      acc.max = b->max;
+    acc.count += b->count;
+    acc.sum += b->sum;
+    acc.sum_sq += b->sum_sq;
+  }
+  out->count = acc.count;
+  if (!acc.count)
+    return false;
+  int64_t mean = acc.sum / (int64_t)acc.count;
+  int64_t var = acc.sum_sq / (int64_t)acc.count - mean * mean;
+  out->min = acc.min;
+  out->max = acc.max;
+  out->mean = (int32_t)mean;
+  out->var = var > 0 ? var : 0;   // O truncamento da média pode dar -1
+  return true;
+}
+
+// Desvio padrão por raiz inteira (bit a bit, sem ponto flutuante)
+int32_t rollstats_stddev(const rollstats_summary_t *sum) {
+  uint64_t v = (uint64_t)sum->var;
+  uint64_t root = 0;
+  uint64_t bit = 1ull << 62;
+  while (bit > v)
+    bit >>= 2;
+  while (bit) {
+    if (v >= root + bit) {
+      v -= root + bit;
+      root = (root >> 1) + bit;
+    } else {
+      root >>= 1;
+    }
+    bit >>= 2;
+  }
+  return (int32_t)root;
+}
+
+uint32_t rollstats_window_s(rollstats_window_t w) {
+  return (uint32_t)tiers[w].width_s * tiers[w].len;
+}
@@ -0,0 +1,49 @@
+#ifndef ROLLSTATS_H
+#define ROLLSTATS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Estatísticas deslizantes (mínimo, máximo, média e variância) de 1 min, 1 h
+// e 24 h em memória fixa. Cada janela é um anel de baldes pré-agregados:
+// uma amostra soma no balde atual das três janelas (O(1)); quando o tempo
+// passa da borda de um balde, o mais antigo é zerado e reaproveitado. A
+// consulta combina os baldes de uma janela, sem rever amostra nenhuma.
+
+typedef enum {
+  ROLLSTATS_1MIN,                  // 12 baldes de 5 s
+  ROLLSTATS_1H,                    // 60 baldes de 1 min
+  ROLLSTATS_24H,                   // 96 baldes de 15 min
+  ROLLSTATS_WINDOWS
+} rollstats_window_t;
+
+#define ROLLSTATS_BUCKETS (12 + 60 + 96)
+
+typedef struct {
+  uint32_t count;
+  int32_t min, max;
+  int64_t sum;
+  int64_t sum_sq;
+} rollstats_bucket_t;
+
+typedef struct {
+  uint32_t slot[ROLLSTATS_WINDOWS];        // Balde atual de cada janela (tempo / largura)
+  rollstats_bucket_t buckets[ROLLSTATS_BUCKETS];
+  uint32_t samples;                        // Total desde o início
+} rollstats_t;
+
+// Resumo de uma janela, nas unidades da amostra (variância em unidade²)
+typedef struct {
+  uint32_t count;                  // 0: janela ainda vazia
+  int32_t min, max;
+  int32_t mean;
+  int64_t var;
+} rollstats_summary_t;
+
+void rollstats_init(rollstats_t *s);
+void rollstats_add(rollstats_t *s, uint32_t now_s, int32_t value);
+bool rollstats_get(rollstats_t *s, rollstats_window_t w, uint32_t now_s, rollstats_summary_t *out);
+int32_t rollstats_stddev(const rollstats_summary_t *sum);
+uint32_t rollstats_window_s(rollstats_window_t w);
+
+#endif
@@ -0,0 +1,110 @@
+#include <string.h>
+#include "sampler_core.h"
+
+void sampler_core_init(sampler_core_t *core, uint8_t input_mask, uint16_t decimation) {
+  memset(core, 0, sizeof(*core));
+  core->decimation = decimation ? decimation : 1;
+  for (uint8_t input = 0; input < SAMPLER_MAX_INPUTS; ++input) {
+    core->slot_of_input[input] = -1;
+    if (input_mask & (1u << input)) {
+      core->slot_of_input[input] = core->n_inputs;
+      core->inputs[core->n_inputs++] = input;
+    }
+  }
+}
+
+static inline void sampler_store(sampler_core_t *core, sampler_channel_t *ch, uint16_t value) {
+  ch->ring[ch->count & (SAMPLER_WINDOW - 1)] = value;
+  ch->count++;
+  ch->dec_acc += value;
+  if (++ch->dec_n == core->decimation) {
+    ch->decimated = ch->dec_acc / core->decimation;
+    ch->dec_acc = 0;
+    ch->dec_n = 0;
+    ch->dec_count++;
+  }
+  if (ch->sink)
+    ch->sink(ch->sink_ctx, value);
+}
+
+// Amostras contínuas a partir de core->position; a posição no ciclo define o canal
+void sampler_core_push(sampler_core_t *core, const uint16_t *samples, size_t n) {
+  if (core->n_inputs == 0)
+    return;
+  uint8_t slot = core->position % core->n_inputs;
+  for (size_t i = 0; i < n; ++i) {
+    sampler_store(core, &core->ch[slot], samples[i] & 0x0FFF);
+    if (++slot == core->n_inputs)
+      slot = 0;
+  }
+  core->position += n;
+}
+
+// Avança o ciclo sem dados, mantendo o alinhamento canal/amostra após uma perda
+void sampler_core_skip(sampler_core_t *core, size_t n) {
+  core->position += n;
+  core->skipped += n;
+}
+
+// Liga um consumidor por amostra ao canal; é chamado no contexto de sampler_core_push
+void sampler_core_set_sink(sampler_core_t *core, uint8_t input, sampler_sink_t sink, void *ctx) {
+  if (input >= SAMPLER_MAX_INPUTS || core->slot_of_input[input] < 0)
+    return;
+  sampler_channel_t *ch = &core->ch[core->slot_of_input[input]];
+  ch->sink = sink;
+  ch->sink_ctx = ctx;
+}
+
+static const sampler_channel_t *sampler_channel(const sampler_core_t *core, uint8_t input) {
+  if (input >= SAMPLER_MAX_INPUTS || core->slot_of_input[input] < 0)
+    return NULL;
+  return &core->ch[core->slot_of_input[input]];
+}
+
+uint16_t sampler_latest(const sampler_core_t *core, uint8_t input) {
+  const sampler_channel_t *ch = sampler_channel(core, input);
+  if (!ch || ch->count == 0)
+    return 0;
+  return ch->ring[(ch->count - 1) & (SAMPLER_WINDOW - 1)];
+}
+
+// Copia as últimas n amostras do canal (da mais antiga para a mais recente)
+size_t sampler_window(const sampler_core_t *core, uint8_t input, uint16_t *out, size_t n) {
+  const sampler_channel_t *ch = sampler_channel(core, input);
+  if (!ch)
+    return 0;
+  if (n > SAMPLER_WINDOW)
+    n = SAMPLER_WINDOW;
+  if (n > ch->count)
+    n = ch->count;
+  uint32_t first = ch->count - n;
+  for (size_t i = 0; i < n; ++i)
+    out[i] = ch->ring[(first + i) & (SAMPLER_WINDOW - 1)];
+  return n;
+}
+
+uint16_t sampler_mean(const sampler_core_t *core, uint8_t input, size_t n) {
+  const sampler_channel_t *ch = sampler_channel(core, input);
+  if (!ch)
+    return 0;
+  if (n > SAMPLER_WINDOW)
+    n = SAMPLER_WINDOW;
+  if (n > ch->count)
+    n = ch->count;
+  if (n == 0)
+    return 0;
+  uint32_t sum = 0;
+  for (uint32_t i = ch->count - n; i != ch->count; ++i)
+    sum += ch->ring[i & (SAMPLER_WINDOW - 1)];
+  return sum / n;
+}
+
+uint16_t sampler_decimated(const sampler_core_t *core, uint8_t input) {
+  const sampler_channel_t *ch = sampler_channel(core, input);
+  return ch ? ch->decimated : 0;
+}
+
+uint32_t sampler_count(const sampler_core_t *core, uint8_t input) {
+  const sampler_channel_t *ch = sampler_channel(core, input);
+  return ch ? ch->count : 0;
+}
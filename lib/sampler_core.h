@@ -0,0 +1,50 @@
+#ifndef SAMPLER_CORE_H
+#define SAMPLER_CORE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Núcleo da amostragem round-robin, sem dependência de hardware: recebe o fluxo
+// intercalado (canal a canal, na ordem crescente das entradas ativas) e separa
+// as amostras por canal. Pode ser alimentado por DMA ou por fluxos sintéticos.
+
+#define SAMPLER_MAX_INPUTS 5      // Entradas 0-3 + sensor de temperatura interno
+#define SAMPLER_WINDOW     64     // Amostras guardadas por canal (potência de 2)
+
+// Consumidor opcional chamado a cada amostra do canal (ex.: cadeia de filtros)
+typedef void (*sampler_sink_t)(void *ctx, uint16_t sample);
+
+typedef struct {
+  uint16_t ring[SAMPLER_WINDOW];
+  uint32_t count;                 // Total de amostras recebidas neste canal
+  uint32_t dec_acc;               // Soma parcial do bloco de decimação
+  uint16_t dec_n;
+  uint16_t decimated;             // Média do último bloco completo
+  uint32_t dec_count;             // Blocos decimados produzidos
+  sampler_sink_t sink;
+  void *sink_ctx;
+} sampler_channel_t;
+
+typedef struct {
+  uint8_t inputs[SAMPLER_MAX_INPUTS];        // Entrada do ADC de cada posição do ciclo
+  int8_t slot_of_input[SAMPLER_MAX_INPUTS];  // Posição no ciclo de cada entrada (-1 inativa)
+  uint8_t n_inputs;
+  uint16_t decimation;
+  uint64_t position;                         // Amostras intercaladas já consumidas
+  uint32_t skipped;                          // Amostras perdidas (sobrescritas antes da leitura)
+  sampler_channel_t ch[SAMPLER_MAX_INPUTS];
+} sampler_core_t;
+
+void sampler_core_init(sampler_core_t *core, uint8_t input_mask, uint16_t decimation);
+void sampler_core_push(sampler_core_t *core, const uint16_t *samples, size_t n);
+void sampler_core_skip(sampler_core_t *core, size_t n);
+void sampler_core_set_sink(sampler_core_t *core, uint8_t input, sampler_sink_t sink, void *ctx);
+
+uint16_t sampler_latest(const sampler_core_t *core, uint8_t input);
+size_t sampler_window(const sampler_core_t *core, uint8_t input, uint16_t *out, size_t n);
+uint16_t sampler_mean(const sampler_core_t *core, uint8_t input, size_t n);
+uint16_t sampler_decimated(const sampler_core_t *core, uint8_t input);
+uint32_t sampler_count(const sampler_core_t *core, uint8_t input);
+
+#endif
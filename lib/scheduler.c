@@ -0,0 +1,182 @@
+#include <stdio.h>
+#include "scheduler.h"
+#include "hardware/gpio.h"
+#include "hardware/sync.h"
+#include "hardware/timer.h"
+#include "trace.h"
+
+#define SCHED_MAX_GPIO 30
+
+static sched_task_t tasks[SCHED_MAX_TASKS];
+static uint8_t task_count;
+static uint64_t busy_us;           // Soma das execuções (o resto é WFE ou despacho)
+
+// Fonte de eventos por GPIO: qual tarefa avisar e com quais bits
+static struct {
+  int8_t task;
+  uint32_t events;
+} gpio_bindings[SCHED_MAX_GPIO];
+static bool gpio_callback_installed;
+
+void sched_init(void) {
+  task_count = 0;
+  busy_us = 0;
+  for (uint i = 0; i < SCHED_MAX_GPIO; ++i)
+    gpio_bindings[i].task = SCHED_NO_TASK;
+  gpio_callback_installed = false;
+}
+
+// A ordem de cadastro define a prioridade: a primeira tarefa pronta da lista roda antes
+int sched_add_task(const char *name, sched_fn_t fn, void *ctx, uint32_t period_ms, uint32_t deadline_ms) {
+  if (task_count >= SCHED_MAX_TASKS)
+    return SCHED_NO_TASK;
+  sched_task_t *t = &tasks[task_count];
+  t->name = name;
+  t->fn = fn;
+  t->ctx = ctx;
+  t->period_us = period_ms * 1000u;
+  t->deadline_us = deadline_ms * 1000u;
+  t->next_release_us = time_us_64() + t->period_us;
+  t->events = 0;
+  t->runs = t->last_us = t->wcet_us = t->max_lateness_us = t->deadline_misses = 0;
+  return task_count++;
+}
+
+// Muda o período de uma tarefa periódica; a próxima liberação conta a partir de agora
+void sched_set_period(int id, uint32_t period_ms) {
+  if (id < 0 || id >= task_count || !tasks[id].period_us)
+    return;
+  tasks[id].period_us = period_ms * 1000u;
+  tasks[id].next_release_us = time_us_64() + tasks[id].period_us;
+}
+
+// Pode ser chamada de ISRs, alarmes ou de outra tarefa
+void sched_post(int id, uint32_t events) {
+  if (id < 0 || id >= task_count)
+    return;
+  uint32_t irq_state = save_and_disable_interrupts();
+  tasks[id].events |= events;
+  restore_interrupts(irq_state);
+  __sev();
+}
+
+static int64_t sched_alarm_cb(alarm_id_t alarm, void *user_data) {
+  uint32_t packed = (uint32_t)(uintptr_t)user_data;
+  sched_post(packed >> 24, packed & 0x00FFFFFF);
+  return 0;
+}
+
+// Fonte de eventos por tempo: entrega os eventos (até 24 bits) após delay_ms
+void sched_post_after(int id, uint32_t delay_ms, uint32_t events) {
+  uint32_t packed = ((uint32_t)id << 24) | (events & 0x00FFFFFF);
+  add_alarm_in_ms(delay_ms, sched_alarm_cb, (void *)(uintptr_t)packed, true);
+}
+
+static void sched_gpio_irq(uint gpio, uint32_t event_mask) {
+  TRACE(TRACE_ISR_GPIO, gpio);
+  if (gpio < SCHED_MAX_GPIO && gpio_bindings[gpio].task != SCHED_NO_TASK)
+    sched_post(gpio_bindings[gpio].task, gpio_bindings[gpio].events);
+}
+
+// Fonte de eventos por GPIO: a borda escolhida vira um evento para a tarefa
+void sched_bind_gpio(uint gpio, uint32_t edge_mask, int id, uint32_t events) {
+  if (gpio >= SCHED_MAX_GPIO)
+    return;
+  gpio_bindings[gpio].task = id;
+  gpio_bindings[gpio].events = events;
+  if (!gpio_callback_installed) {
+    gpio_set_irq_enabled_with_callback(gpio, edge_mask, true, &sched_gpio_irq);
+    gpio_callback_installed = true;
+  } else {
+    gpio_set_irq_enabled(gpio, edge_mask, true);
+  }
+}
+
+static uint32_t sched_take_events(sched_task_t *t) {
+  uint32_t irq_state = save_and_disable_interrupts();
+  uint32_t events = t->events;
+  t->events = 0;
+  restore_interrupts(irq_state);
+  return events;
+}
+
+static void sched_dispatch(sched_task_t *t, uint64_t now, bool periodic) {
+  uint64_t release = periodic ? t->next_release_us : now;
+  uint32_t events = sched_take_events(t);
+
+  if (now - release > t->max_lateness_us)
+    t->max_lateness_us = now - release;
+
+  TRACE(TRACE_TASK_BEGIN, t - tasks);
+  t->fn(events, t->ctx);
+  TRACE(TRACE_TASK_END, t - tasks);
+
+  uint64_t end = time_us_64();
+  t->last_us = end - now;
+  busy_us += t->last_us;
+  if (t->last_us > t->wcet_us)
+    t->wcet_us = t->last_us;
+  if (t->deadline_us && end - release > t->deadline_us)
+    t->deadline_misses++;
+  t->runs++;
+
+  if (periodic) {
+    t->next_release_us += t->period_us;
+    // Se a tarefa ficou para trás, pula as liberações perdidas em vez de acumular
+    if (t->next_release_us <= end)
+      t->next_release_us = end + t->period_us;
+  }
+}
+
+// Roda a tarefa pronta de maior prioridade. Sem nada pronto, dorme até a
+// próxima liberação ou até algum evento (WFE acordado pelo __sev de sched_post)
+bool sched_run_once(void) {
+  uint64_t now = time_us_64();
+  uint64_t next = now + 1000000;
+
+  for (uint8_t i = 0; i < task_count; ++i) {
+    sched_task_t *t = &tasks[i];
+    if (t->events) {
+      sched_dispatch(t, now, t->period_us && now >= t->next_release_us);
+      return true;
+    }
+    if (t->period_us && now >= t->next_release_us) {
+      sched_dispatch(t, now, true);
+      return true;
+    }
+    if (t->period_us && t->next_release_us < next)
+      next = t->next_release_us;
+  }
+
+  best_effort_wfe_or_timeout(from_us_since_boot(next));
+  return false;
+}
+
+void sched_run(void) {
+  while (true)
+    sched_run_once();
+}
+
+// Tempo total de execução das tarefas desde sched_init (base da contagem de energia)
+uint64_t sched_busy_us(void) {
+  return busy_us;
+}
+
+const sched_task_t *sched_task(int id) {
+  return (id >= 0 && id < task_count) ? &tasks[id] : NULL;
+}
+
+void sched_reset_stats(void) {
+  for (uint8_t i = 0; i < task_count; ++i)
+    tasks[i].runs = tasks[i].last_us = tasks[i].wcet_us = tasks[i].max_lateness_us = tasks[i].deadline_misses = 0;
+}
+
+// Tabela com o pior tempo de execução e a folga restante de cada tarefa
+void sched_print_stats(void) {
+  printf("tarefa       execs   ultima   pior(us)  atraso(us)  perdas\n");
+  for (uint8_t i = 0; i < task_count; ++i) {
+    sched_task_t *t = &tasks[i];
+    printf("%-12s %6lu %8lu %10lu %11lu %7lu\n", t->name, (unsigned long)t->runs, (unsigned long)t->last_us,
+           (unsigned long)t->wcet_us, (unsigned long)t->max_lateness_us, (unsigned long)t->deadline_misses);
+  }
+}
@@ -0,0 +1,43 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include "pico/stdlib.h"
+
+#define SCHED_MAX_TASKS 12
+#define SCHED_NO_TASK   (-1)
+
+// Corpo de uma tarefa: recebe os eventos pendentes (já consumidos) e o contexto.
+// Deve rodar até o fim sem bloquear; esperas viram estados + sched_post_after.
+typedef void (*sched_fn_t)(uint32_t events, void *ctx);
+
+typedef struct {
+  const char *name;
+  sched_fn_t fn;
+  void *ctx;
+  uint32_t period_us;          // 0 = tarefa só dispara por evento
+  uint32_t deadline_us;        // Prazo entre a liberação e o fim da execução
+  uint64_t next_release_us;
+  volatile uint32_t events;    // Eventos pendentes (escritos por ISRs/alarmes)
+
+  // Estatísticas
+  uint32_t runs;
+  uint32_t last_us;            // Duração da última execução
+  uint32_t wcet_us;            // Pior duração observada
+  uint32_t max_lateness_us;    // Maior atraso entre a liberação e o início
+  uint32_t deadline_misses;
+} sched_task_t;
+
+void sched_init(void);
+int sched_add_task(const char *name, sched_fn_t fn, void *ctx, uint32_t period_ms, uint32_t deadline_ms);
+void sched_set_period(int id, uint32_t period_ms);
+void sched_post(int id, uint32_t events);
+void sched_post_after(int id, uint32_t delay_ms, uint32_t events);
+void sched_bind_gpio(uint gpio, uint32_t edge_mask, int id, uint32_t events);
+bool sched_run_once(void);
+__attribute__((noreturn)) void sched_run(void);   // Laço principal, não volta
+const sched_task_t *sched_task(int id);
+uint64_t sched_busy_us(void);
+void sched_reset_stats(void);
+void sched_print_stats(void);
+
+#endif
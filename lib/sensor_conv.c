@@ -0,0 +1,44 @@
+#include "sensor_conv.h"
+
+// Calibrações padrão, geradas em tempo de compilação a partir das fórmulas
+// que antes estavam espalhadas pelo firmware:
+//  - temperatura: escala do joystick para 0-64 °C
+//  - umidade: invertida, 99 % (solo encharcado) a 0 %
+//  - luminosidade: microfone / 255, com o piso de 50 % usado na demonstração
+static const cal_table_t cal_temp_padrao = CAL_TABLE_LINEAR(Q8(0), Q8(64));
+static const cal_table_t cal_umidade_padrao = CAL_TABLE_LINEAR(Q8(99), Q8(0));
+static const cal_table_t cal_lumi_padrao = CAL_TABLE_LINEAR(Q8(50), Q8(50) + Q8(4095) / 255);
+
+static const cal_table_t *tabelas[SENSOR_COUNT] = {
+  [SENSOR_TEMP] = &cal_temp_padrao,
+  [SENSOR_UMIDADE] = &cal_umidade_padrao,
+  [SENSOR_LUMI] = &cal_lumi_padrao,
+};
+
+// Interpolação entre os dois pontos do trecho: só soma, multiplicação e shift
+int32_t cal_apply(const cal_table_t *table, uint16_t raw) {
+  if (raw > 4095)
+    raw = 4095;
+  uint16_t i = raw >> CAL_SHIFT;
+  int32_t frac = raw & ((1u << CAL_SHIFT) - 1);
+  int32_t y0 = table->y[i];
+  return y0 + (((table->y[i + 1] - y0) * frac) >> CAL_SHIFT);
+}
+
+// Troca a calibração de um sensor em tempo de execução (ex.: sensor real no lugar do joystick)
+void sensor_conv_set_table(sensor_id_t sensor, const cal_table_t *table) {
+  if (sensor < SENSOR_COUNT && table)
+    tabelas[sensor] = table;
+}
+
+const cal_table_t *sensor_conv_table(sensor_id_t sensor) {
+  return sensor < SENSOR_COUNT ? tabelas[sensor] : 0;
+}
+
+// Converte um lote de amostras brutas; chamada uma vez por lote
+void sensor_conv_run(const sensor_raw_t *raw, sensor_readings_t *out) {
+  out->temp_q8 = cal_apply(tabelas[SENSOR_TEMP], raw->raw[SENSOR_TEMP]);
+  out->umidade_q8 = cal_apply(tabelas[SENSOR_UMIDADE], raw->raw[SENSOR_UMIDADE]);
+  out->lumi_q8 = cal_apply(tabelas[SENSOR_LUMI], raw->raw[SENSOR_LUMI]);
+  out->lote++;
+}
@@ -0,0 +1,64 @@
+#ifndef SENSOR_CONV_H
+#define SENSOR_CONV_H
+
+#include <stdint.h>
+
+// Conversão bruto (ADC de 12 bits) -> unidade de engenharia em ponto fixo Q8
+// (valor * 256), por tabela de calibração com interpolação linear por trechos.
+// Sem divisões nem ponto flutuante: o RP2040 (Cortex-M0+) não tem FPU.
+
+#define CAL_POINTS 17                 // Pontos em raw = 0, 256, ..., 4096
+#define CAL_SHIFT  8                  // raw >> CAL_SHIFT = trecho da tabela
+
+#define Q8(v)       ((int32_t)(v) * 256)
+#define Q8_INT(q)   ((int)(((q) + 128) >> 8))   // Arredonda para o inteiro mais próximo
+
+typedef struct {
+  int32_t y[CAL_POINTS];              // Saída em Q8 em cada ponto
+} cal_table_t;
+
+// Ponto k de uma reta que leva raw 0 -> a e raw 4095 -> b (a e b em Q8),
+// calculado pelo compilador
+#define CAL_LIN(k, a, b) \
+  ((int32_t)((a) + ((int64_t)((b) - (a)) * ((k) << CAL_SHIFT)) / 4095))
+
+#define CAL_TABLE_LINEAR(a, b) {{                                                   \
+  CAL_LIN(0, a, b),  CAL_LIN(1, a, b),  CAL_LIN(2, a, b),  CAL_LIN(3, a, b),        \
+  CAL_LIN(4, a, b),  CAL_LIN(5, a, b),  CAL_LIN(6, a, b),  CAL_LIN(7, a, b),        \
+  CAL_LIN(8, a, b),  CAL_LIN(9, a, b),  CAL_LIN(10, a, b), CAL_LIN(11, a, b),       \
+  CAL_LIN(12, a, b), CAL_LIN(13, a, b), CAL_LIN(14, a, b), CAL_LIN(15, a, b),       \
+  CAL_LIN(16, a, b) }}
+
+typedef enum {
+  SENSOR_TEMP,
+  SENSOR_UMIDADE,
+  SENSOR_LUMI,
+  SENSOR_COUNT
+} sensor_id_t;
+
+// Amostras brutas de um lote, na ordem de sensor_id_t
+typedef struct {
+  uint16_t raw[SENSOR_COUNT];
+} sensor_raw_t;
+
+#define SENSOR_BANDS 4
+
+// Leituras convertidas, compartilhadas por display, avaliação de saúde e rega.
+// Os canais de som vêm da análise do microfone por blocos (lib/audio.h), não
+// da tabela de calibração: quem processa o áudio os preenche
+typedef struct {
+  int32_t temp_q8;        // °C
+  int32_t umidade_q8;     // %
+  int32_t lumi_q8;        // %
+  int32_t som_q8;         // dBFS, RMS do último bloco do microfone
+  int32_t som_pico_q8;    // dBFS
+  int32_t bandas_q8[SENSOR_BANDS];   // dBFS por banda, dos graves aos agudos
+  uint32_t lote;          // Incrementa a cada conversão
+} sensor_readings_t;
+
+int32_t cal_apply(const cal_table_t *table, uint16_t raw);
+void sensor_conv_set_table(sensor_id_t sensor, const cal_table_t *table);
+const cal_table_t *sensor_conv_table(sensor_id_t sensor);
+void sensor_conv_run(const sensor_raw_t *raw, sensor_readings_t *out);
+
+#endif
@@ -0,0 +1,48 @@
+#include <string.h>
+#include "seqlock.h"
+
+void seqlock_init(seqlock_t *sl, void *slot0, void *slot1, size_t size, const void *initial) {
+  sl->slots[0] = slot0;
+  sl->slots[1] = slot1;
+  sl->size = size;
+  memcpy(slot0, initial, size);
+  memcpy(slot1, initial, size);
+  atomic_store_explicit(&sl->seq, 0, memory_order_release);
+  sl->writes = sl->reads = sl->retries = sl->max_retries = 0;
+}
+
+// Escritor único: cada passo desvia os leitores para a cópia que não está sendo escrita
+void seqlock_publish(seqlock_t *sl, const void *value) {
+  uint32_t seq = atomic_load_explicit(&sl->seq, memory_order_relaxed);
+
+  atomic_store_explicit(&sl->seq, seq + 1, memory_order_release);  // Leitores -> cópia 1
+  atomic_thread_fence(memory_order_seq_cst);
+  memcpy(sl->slots[0], value, sl->size);
+
+  atomic_store_explicit(&sl->seq, seq + 2, memory_order_release);  // Leitores -> cópia 0
+  atomic_thread_fence(memory_order_seq_cst);
+  memcpy(sl->slots[1], value, sl->size);
+
+  sl->writes++;
+}
+
+// Copia a versão publicada mais recente; retorna o número da versão lida
+uint32_t seqlock_read(seqlock_t *sl, void *out) {
+  uint32_t tries = 0;
+  uint32_t seq;
+  for (;;) {
+    seq = atomic_load_explicit(&sl->seq, memory_order_acquire);
+    memcpy(out, sl->slots[seq & 1], sl->size);
+    atomic_thread_fence(memory_order_acquire);
+    if (atomic_load_explicit(&sl->seq, memory_order_relaxed) == seq)
+      break;
+    tries++;
+  }
+  sl->reads++;
+  if (tries) {
+    sl->retries += tries;
+    if (tries > sl->max_retries)
+      sl->max_retries = tries;
+  }
+  return seq >> 1;
+}
@@ -0,0 +1,37 @@
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdatomic.h>
+
+// Publicação versionada de uma estrutura com um escritor e vários leitores
+// (tarefas, ISRs e o outro núcleo), sem desligar interrupções para ler.
+//
+// Variante com duas cópias (latch): o escritor atualiza uma cópia por vez e o
+// contador de sequência indica qual está estável. Um leitor que interrompe o
+// escritor no mesmo núcleo lê a cópia estável e nunca fica girando; só repete
+// a leitura se uma publicação inteira acontecer no meio dela (outro núcleo).
+
+typedef struct {
+  _Atomic uint32_t seq;            // Par: cópia 0 estável; ímpar: cópia 1 estável
+  void *slots[2];
+  size_t size;
+
+  // Estatísticas (contadores dos leitores são aproximados com leitores concorrentes)
+  uint32_t writes;
+  volatile uint32_t reads;
+  volatile uint32_t retries;       // Leituras refeitas por causa de uma escrita no meio
+  volatile uint32_t max_retries;   // Maior número de repetições numa única leitura
+} seqlock_t;
+
+void seqlock_init(seqlock_t *sl, void *slot0, void *slot1, size_t size, const void *initial);
+void seqlock_publish(seqlock_t *sl, const void *value);
+uint32_t seqlock_read(seqlock_t *sl, void *out);
+
+static inline uint32_t seqlock_version(const seqlock_t *sl) {
+  return atomic_load_explicit(&sl->seq, memory_order_acquire) >> 1;
+}
+
+#endif
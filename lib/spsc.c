@@ -0,0 +1,43 @@
+#include <string.h>
+#include "spsc.h"
+
+void spsc_init(spsc_queue_t *q, void *storage, uint16_t elem_size, uint16_t capacity) {
+  q->slots = storage;
+  q->elem_size = elem_size;
+  q->capacity = capacity;
+  atomic_store_explicit(&q->head, 0, memory_order_relaxed);
+  atomic_store_explicit(&q->tail, 0, memory_order_relaxed);
+  q->dropped = 0;
+}
+
+// Produtor: copia o elemento e só então publica o novo head
+bool spsc_push(spsc_queue_t *q, const void *elem) {
+  uint32_t head = atomic_load_explicit(&q->head, memory_order_relaxed);
+  uint32_t tail = atomic_load_explicit(&q->tail, memory_order_acquire);
+  if (head - tail >= q->capacity) {
+    q->dropped++;
+    return false;
+  }
+  memcpy(q->slots + (head & (q->capacity - 1)) * q->elem_size, elem, q->elem_size);
+  atomic_store_explicit(&q->head, head + 1, memory_order_release);
+  return true;
+}
+
+// Consumidor: copia o elemento e só então libera a posição
+bool spsc_pop(spsc_queue_t *q, void *elem) {
+  uint32_t tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
+  uint32_t head = atomic_load_explicit(&q->head, memory_order_acquire);
+  if (head == tail)
+    return false;
+  memcpy(elem, q->slots + (tail & (q->capacity - 1)) * q->elem_size, q->elem_size);
+  atomic_store_explicit(&q->tail, tail + 1, memory_order_release);
+  return true;
+}
+
+// Esvazia a fila ficando só com o elemento mais recente; retorna quantos havia
+size_t spsc_drain_latest(spsc_queue_t *q, void *elem) {
+  size_t n = 0;
+  while (spsc_pop(q, elem))
+    n++;
+  return n;
+}
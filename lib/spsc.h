@@ -0,0 +1,30 @@
+#ifndef SPSC_H
+#define SPSC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdatomic.h>
+
+// Fila sem trava de um produtor e um consumidor (ex.: núcleo 0 -> núcleo 1).
+// Elementos de tamanho fixo copiados por valor; capacidade em potência de 2.
+// Só usa leituras/escritas atômicas de 32 bits, que o Cortex-M0+ faz nativamente.
+
+typedef struct {
+  uint8_t *slots;
+  uint16_t elem_size;
+  uint16_t capacity;
+  _Atomic uint32_t head;           // Escrito só pelo produtor
+  _Atomic uint32_t tail;           // Escrito só pelo consumidor
+  uint32_t dropped;                // Pushes recusados por fila cheia (lado do produtor)
+} spsc_queue_t;
+
+// Armazenamento estático para 'capacity' elementos do tipo 'type'
+#define SPSC_STORAGE(name, type, capacity) static uint8_t name[(capacity) * sizeof(type)] __attribute__((aligned(4)))
+
+void spsc_init(spsc_queue_t *q, void *storage, uint16_t elem_size, uint16_t capacity);
+bool spsc_push(spsc_queue_t *q, const void *elem);
+bool spsc_pop(spsc_queue_t *q, void *elem);
+size_t spsc_drain_latest(spsc_queue_t *q, void *elem);
+
+#endif
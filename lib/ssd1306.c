@@ -1,5 +1,27 @@
+#include <string.h>
 #include "ssd1306.h"
 #include "font.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#include "trace.h"
+
+// Custo aproximado (em bytes no barramento) de abrir uma janela de envio:
+// transação de comandos + endereço e byte de controle da transação de dados
+#define SSD1306_WINDOW_COST 10
+
+// Posição do byte da coluna x na página p (endereçamento vertical, 8 páginas)
+static inline uint16_t ssd1306_index(uint8_t x, uint8_t page) {
+  return page + (x << 3) + 1;
+}
+
+// Bit STOP do registrador IC_DATA_CMD (encerra a transação após o byte)
+#define SSD1306_DATA_CMD_STOP (1u << 9)
+
+static void ssd1306_clear_dirty(ssd1306_t *ssd) {
+  memset(ssd->dirty_x0, 0xFF, sizeof(ssd->dirty_x0));
+  memset(ssd->dirty_x1, 0x00, sizeof(ssd->dirty_x1));
+}
 
 void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c) {
   ssd->width = width;
@@ -11,6 +33,14 @@ void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_v
   ssd->ram_buffer = calloc(ssd->bufsize, sizeof(uint8_t));
   ssd->ram_buffer[0] = 0x40;
   ssd->port_buffer[0] = 0x80;
+  ssd->shadow_buffer = calloc(ssd->bufsize, sizeof(uint8_t));
+  ssd->tx_buffer = calloc(ssd->bufsize, sizeof(uint8_t));
+  ssd->shadow_valid = false;
+  ssd->flush_mode = SSD1306_FLUSH_FULL;
+  ssd->dma_channel = -1;
+  ssd->flushes = ssd->flush_bytes = 0;
+  ssd1306_clear_dirty(ssd);
+  ssd1306_mark_dirty(ssd, 0, 0, width - 1, height - 1);
 }
 
 void ssd1306_config(ssd1306_t *ssd) {
@@ -42,6 +72,7 @@ void ssd1306_config(ssd1306_t *ssd) {
 }
 
 void ssd1306_command(ssd1306_t *ssd, uint8_t command) {
+  ssd1306_flush_wait(ssd);
   ssd->port_buffer[1] = command;
   i2c_write_blocking(
     ssd->i2c_port,
@@ -52,69 +83,423 @@ void ssd1306_command(ssd1306_t *ssd, uint8_t command) {
   );
 }
 
+// Define a janela de colunas/páginas numa única transação de comandos (Co = 0)
+static void ssd1306_set_window(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t p0, uint8_t p1) {
+  uint8_t cmd[7] = {0x00, SET_COL_ADDR, x0, x1, SET_PAGE_ADDR, p0, p1};
+  i2c_write_blocking(ssd->i2c_port, ssd->address, cmd, sizeof(cmd), false);
+  ssd->flush_bytes += sizeof(cmd);
+}
+
+// Envia a janela x0..x1 x p0..p1 de forma bloqueante
+static void ssd1306_send_window(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t p0, uint8_t p1, void *ctx) {
+  uint8_t rows = p1 - p0 + 1;
+  ssd1306_set_window(ssd, x0, x1, p0, p1);
+  if (rows == ssd->pages && x0 == 0 && x1 == ssd->width - 1) {
+    // Quadro completo: o ram_buffer já começa com o byte de controle 0x40
+    i2c_write_blocking(ssd->i2c_port, ssd->address, ssd->ram_buffer, ssd->bufsize, false);
+    ssd->flush_bytes += ssd->bufsize;
+    return;
+  }
+  size_t len = 1;
+  ssd->tx_buffer[0] = 0x40;
+  for (uint16_t x = x0; x <= x1; ++x) {
+    memcpy(&ssd->tx_buffer[len], &ssd->ram_buffer[ssd1306_index(x, p0)], rows);
+    len += rows;
+  }
+  i2c_write_blocking(ssd->i2c_port, ssd->address, ssd->tx_buffer, len, false);
+  ssd->flush_bytes += len;
+}
+
+// Reduz a faixa suja da página às colunas que realmente diferem do último envio
+static bool ssd1306_trim_page(ssd1306_t *ssd, uint8_t page, uint8_t *x0, uint8_t *x1) {
+  uint8_t lo = ssd->dirty_x0[page];
+  uint8_t hi = ssd->dirty_x1[page];
+  if (lo > hi)
+    return false;
+  while (lo <= hi && ssd->ram_buffer[ssd1306_index(lo, page)] == ssd->shadow_buffer[ssd1306_index(lo, page)])
+    ++lo;
+  if (lo > hi)
+    return false;
+  while (ssd->ram_buffer[ssd1306_index(hi, page)] == ssd->shadow_buffer[ssd1306_index(hi, page)])
+    --hi;
+  *x0 = lo;
+  *x1 = hi;
+  return true;
+}
+
+// Entrega a janela ao destino e atualiza a cópia do que o display passa a mostrar
+static void ssd1306_emit(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t p0, uint8_t p1,
+                         ssd1306_window_fn_t emit, void *ctx) {
+  emit(ssd, x0, x1, p0, p1, ctx);
+  for (uint16_t x = x0; x <= x1; ++x) {
+    uint16_t index = ssd1306_index(x, p0);
+    memcpy(&ssd->shadow_buffer[index], &ssd->ram_buffer[index], p1 - p0 + 1);
+  }
+}
+
+// Decide quais janelas enviar (quadro completo ou só o que mudou) e as
+// repassa para emit; usado tanto pelo envio bloqueante quanto pelo DMA
+void ssd1306_plan_windows(ssd1306_t *ssd, bool dirty_only, ssd1306_window_fn_t emit, void *ctx) {
+  if (!dirty_only || !ssd->shadow_valid) {
+    ssd1306_emit(ssd, 0, ssd->width - 1, 0, ssd->pages - 1, emit, ctx);
+    ssd->shadow_valid = true;
+    ssd1306_clear_dirty(ssd);
+    return;
+  }
+
+  // Agrupa páginas consecutivas numa mesma janela quando isso custa menos
+  // bytes no barramento do que abrir uma janela por página
+  bool open = false;
+  uint8_t bx0 = 0, bx1 = 0, bp0 = 0, bp1 = 0;
+  for (uint8_t p = 0; p < ssd->pages; ++p) {
+    uint8_t x0, x1;
+    if (!ssd1306_trim_page(ssd, p, &x0, &x1))
+      continue;
+    if (open && bp1 + 1 == p) {
+      uint8_t mx0 = x0 < bx0 ? x0 : bx0;
+      uint8_t mx1 = x1 > bx1 ? x1 : bx1;
+      uint32_t merged = (uint32_t)(mx1 - mx0 + 1) * (p - bp0 + 1);
+      uint32_t split = (uint32_t)(bx1 - bx0 + 1) * (bp1 - bp0 + 1) + (x1 - x0 + 1) + SSD1306_WINDOW_COST;
+      if (merged <= split) {
+        bx0 = mx0;
+        bx1 = mx1;
+        bp1 = p;
+        continue;
+      }
+    }
+    if (open)
+      ssd1306_emit(ssd, bx0, bx1, bp0, bp1, emit, ctx);
+    open = true;
+    bx0 = x0;
+    bx1 = x1;
+    bp0 = bp1 = p;
+  }
+  if (open)
+    ssd1306_emit(ssd, bx0, bx1, bp0, bp1, emit, ctx);
+  ssd1306_clear_dirty(ssd);
+}
+
+// Envio bloqueante: conta como um envio se alguma janela saiu
+static void ssd1306_send_blocking(ssd1306_t *ssd, bool dirty_only) {
+  uint32_t before = ssd->flush_bytes;
+  TRACE(TRACE_FLUSH_BEGIN, 0);
+  ssd1306_plan_windows(ssd, dirty_only, ssd1306_send_window, NULL);
+  TRACE(TRACE_FLUSH_END, ssd->flush_bytes - before);
+  if (ssd->flush_bytes != before)
+    ssd->flushes++;
+}
+
+void ssd1306_send_dirty(ssd1306_t *ssd) {
+  ssd1306_flush_wait(ssd);
+  ssd1306_send_blocking(ssd, true);
+}
+
 void ssd1306_send_data(ssd1306_t *ssd) {
-  ssd1306_command(ssd, SET_COL_ADDR);
-  ssd1306_command(ssd, 0);
-  ssd1306_command(ssd, ssd->width - 1);
-  ssd1306_command(ssd, SET_PAGE_ADDR);
-  ssd1306_command(ssd, 0);
-  ssd1306_command(ssd, ssd->pages - 1);
-  i2c_write_blocking(
-    ssd->i2c_port,
-    ssd->address,
-    ssd->ram_buffer,
-    ssd->bufsize,
-    false
-  );
+  bool dirty_only = ssd->flush_mode == SSD1306_FLUSH_DIRTY;
+  if (ssd->dma_channel >= 0) {
+    // Com DMA o envio só bloqueia se já houver dois quadros na fila
+    while (!ssd1306_send_data_async(ssd, NULL, NULL))
+      tight_loop_contents();
+    return;
+  }
+  ssd1306_send_blocking(ssd, dirty_only);
+}
+
+// ---------------------------------------------------------------------------
+// Envio assíncrono via DMA
+//
+// Cada quadro é convertido num fluxo de palavras de 16 bits para o registrador
+// IC_DATA_CMD: uma transação de comandos com a janela seguida da transação de
+// dados, com o bit STOP no último byte de cada uma. Como o fluxo é uma cópia,
+// o ram_buffer fica livre para o próximo desenho assim que o envio começa.
+// ---------------------------------------------------------------------------
+
+static ssd1306_t *ssd1306_dma_owner;
+
+static void ssd1306_encode_window(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t p0, uint8_t p1, void *ctx) {
+  ssd1306_stream_t *stream = ctx;
+  uint16_t *out = &stream->words[stream->len];
+  uint8_t rows = p1 - p0 + 1;
+  size_t n = 0;
+  const uint8_t cmd[7] = {0x00, SET_COL_ADDR, x0, x1, SET_PAGE_ADDR, p0, p1};
+  for (uint8_t i = 0; i < sizeof(cmd); ++i)
+    out[n++] = cmd[i];
+  out[n - 1] |= SSD1306_DATA_CMD_STOP;
+  out[n++] = 0x40;
+  for (uint16_t x = x0; x <= x1; ++x) {
+    const uint8_t *col = &ssd->ram_buffer[ssd1306_index(x, p0)];
+    for (uint8_t r = 0; r < rows; ++r)
+      out[n++] = col[r];
+  }
+  out[n - 1] |= SSD1306_DATA_CMD_STOP;
+  stream->len += n;
+}
+
+size_t ssd1306_encode_frame(ssd1306_t *ssd, ssd1306_stream_t *stream) {
+  stream->len = 0;
+  ssd1306_plan_windows(ssd, ssd->flush_mode == SSD1306_FLUSH_DIRTY, ssd1306_encode_window, stream);
+  return stream->len;
+}
+
+static void ssd1306_dma_start(ssd1306_t *ssd, int8_t slot) {
+  ssd->stream_active = slot;
+  TRACE(TRACE_FLUSH_BEGIN, ssd->stream[slot].len);
+  dma_channel_transfer_from_buffer_now(ssd->dma_channel, ssd->stream[slot].words, ssd->stream[slot].len);
+}
+
+static void ssd1306_dma_irq_handler(void) {
+  ssd1306_t *ssd = ssd1306_dma_owner;
+  if (!ssd || !dma_channel_get_irq0_status(ssd->dma_channel))
+    return;
+  dma_channel_acknowledge_irq0(ssd->dma_channel);
+  TRACE(TRACE_ISR_DMA, ssd->dma_channel);
+
+  ssd1306_stream_t *done = &ssd->stream[ssd->stream_active];
+  TRACE(TRACE_FLUSH_END, done->len);
+  ssd1306_flush_cb_t cb = done->cb;
+  void *user_data = done->user_data;
+  ssd->stream_active = -1;
+
+  // O endereço do escravo não muda entre quadros, então o próximo fluxo
+  // pode seguir direto para a FIFO sem reprogramar o IC_TAR
+  if (ssd->stream_pending >= 0) {
+    int8_t next = ssd->stream_pending;
+    ssd->stream_pending = -1;
+    ssd1306_dma_start(ssd, next);
+  }
+  if (cb)
+    cb(ssd, user_data);
+}
+
+void ssd1306_dma_init(ssd1306_t *ssd) {
+  size_t capacity = ssd->bufsize + SSD1306_MAX_PAGES * 8;
+  for (uint8_t i = 0; i < 2; ++i) {
+    ssd->stream[i].words = calloc(capacity, sizeof(uint16_t));
+    ssd->stream[i].len = 0;
+  }
+  ssd->stream_active = -1;
+  ssd->stream_pending = -1;
+
+  ssd->dma_channel = dma_claim_unused_channel(true);
+  dma_channel_config c = dma_channel_get_default_config(ssd->dma_channel);
+  channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+  channel_config_set_read_increment(&c, true);
+  channel_config_set_write_increment(&c, false);
+  channel_config_set_dreq(&c, i2c_get_dreq(ssd->i2c_port, true));
+  dma_channel_configure(ssd->dma_channel, &c, &i2c_get_hw(ssd->i2c_port)->data_cmd, NULL, 0, false);
+
+  ssd1306_dma_owner = ssd;
+  dma_channel_set_irq0_enabled(ssd->dma_channel, true);
+  irq_add_shared_handler(DMA_IRQ_0, ssd1306_dma_irq_handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+  irq_set_enabled(DMA_IRQ_0, true);
+}
+
+// Se o display não respondeu (NACK) a FIFO é descartada: cancela o DMA e
+// força um quadro completo no próximo envio
+static void ssd1306_check_abort(ssd1306_t *ssd) {
+  i2c_hw_t *hw = i2c_get_hw(ssd->i2c_port);
+  if (!(hw->raw_intr_stat & I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS))
+    return;
+  dma_channel_set_irq0_enabled(ssd->dma_channel, false);
+  dma_channel_abort(ssd->dma_channel);
+  dma_channel_acknowledge_irq0(ssd->dma_channel);
+  dma_channel_set_irq0_enabled(ssd->dma_channel, true);
+  (void)hw->clr_tx_abrt;
+  ssd->stream_active = -1;
+  ssd->stream_pending = -1;
+  ssd->shadow_valid = false;
+  ssd1306_mark_dirty(ssd, 0, 0, ssd->width - 1, ssd->height - 1);
+}
+
+bool ssd1306_send_data_async(ssd1306_t *ssd, ssd1306_flush_cb_t cb, void *user_data) {
+  ssd1306_check_abort(ssd);
+  if (ssd->stream_pending >= 0)
+    return false;
+
+  // O buffer livre é sempre o que não está na linha de transmissão
+  int8_t slot = ssd->stream_active == 0 ? 1 : 0;
+  ssd1306_stream_t *stream = &ssd->stream[slot];
+  if (ssd1306_encode_frame(ssd, stream) == 0) {
+    if (cb)
+      cb(ssd, user_data);
+    return true;
+  }
+  stream->cb = cb;
+  stream->user_data = user_data;
+  ssd->flushes++;
+  ssd->flush_bytes += stream->len;
+
+  uint32_t irq_state = save_and_disable_interrupts();
+  if (ssd->stream_active >= 0) {
+    ssd->stream_pending = slot;
+  } else {
+    // Barramento ocioso: garante o endereço do display antes do primeiro byte
+    i2c_hw_t *hw = i2c_get_hw(ssd->i2c_port);
+    while (hw->status & I2C_IC_STATUS_ACTIVITY_BITS)
+      tight_loop_contents();
+    hw->enable = 0;
+    hw->tar = ssd->address;
+    hw->enable = 1;
+    ssd1306_dma_start(ssd, slot);
+  }
+  restore_interrupts(irq_state);
+  return true;
+}
+
+bool ssd1306_flush_busy(ssd1306_t *ssd) {
+  if (ssd->dma_channel < 0)
+    return false;
+  ssd1306_check_abort(ssd);
+  if (ssd->stream_active >= 0 || ssd->stream_pending >= 0)
+    return true;
+  // O DMA termina quando o último byte entra na FIFO; o quadro só saiu de
+  // fato quando a FIFO esvaziou e o controlador parou
+  i2c_hw_t *hw = i2c_get_hw(ssd->i2c_port);
+  return !(hw->status & I2C_IC_STATUS_TFE_BITS) || (hw->status & I2C_IC_STATUS_ACTIVITY_BITS);
+}
+
+void ssd1306_flush_wait(ssd1306_t *ssd) {
+  while (ssd1306_flush_busy(ssd))
+    tight_loop_contents();
+}
+
+void ssd1306_set_flush_mode(ssd1306_t *ssd, ssd1306_flush_mode_t mode) {
+  ssd->flush_mode = mode;
+}
+
+// Marca o retângulo (x0, y0)-(x1, y1), inclusivo, como alterado
+void ssd1306_mark_dirty(ssd1306_t *ssd, uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1) {
+  if (x0 >= ssd->width || y0 >= ssd->height)
+    return;
+  if (x1 >= ssd->width)
+    x1 = ssd->width - 1;
+  if (y1 >= ssd->height)
+    y1 = ssd->height - 1;
+  for (uint8_t p = y0 >> 3; p <= (y1 >> 3); ++p) {
+    if (x0 < ssd->dirty_x0[p])
+      ssd->dirty_x0[p] = x0;
+    if (x1 > ssd->dirty_x1[p])
+      ssd->dirty_x1[p] = x1;
+  }
 }
 
 void ssd1306_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value) {
+  if (x >= ssd->width || y >= ssd->height)
+    return;
   uint16_t index = (y >> 3) + (x << 3) + 1;
   uint8_t pixel = (y & 0b111);
+  uint8_t page = y >> 3;
+  if (x < ssd->dirty_x0[page])
+    ssd->dirty_x0[page] = x;
+  if (x > ssd->dirty_x1[page])
+    ssd->dirty_x1[page] = x;
   if (value)
     ssd->ram_buffer[index] |= (1 << pixel);
   else
     ssd->ram_buffer[index] &= ~(1 << pixel);
 }
 
-/*
-void ssd1306_fill(ssd1306_t *ssd, bool value) {
+// Bits da página cobertos pelas linhas y0..y1 (já limitadas à página)
+static inline uint8_t ssd1306_page_mask(uint8_t page, uint8_t p0, uint8_t p1, uint8_t y0, uint8_t y1) {
+  uint8_t lo = (page == p0) ? (y0 & 7) : 0;
+  uint8_t hi = (page == p1) ? (y1 & 7) : 7;
+  return (uint8_t)(0xFF << lo) & (uint8_t)(0xFF >> (7 - hi));
+}
+
+// Rasteriza o retângulo (x0, y0)-(x1, y1), inclusivo, direto nos bytes de página:
+// colunas consecutivas de uma mesma página ficam a 8 bytes de distância, e
+// colunas inteiras são contíguas no ram_buffer
+static void ssd1306_fill_area(ssd1306_t *ssd, int x0, int y0, int x1, int y1, bool value) {
+  if (x0 < 0) x0 = 0;
+  if (y0 < 0) y0 = 0;
+  if (x1 >= ssd->width) x1 = ssd->width - 1;
+  if (y1 >= ssd->height) y1 = ssd->height - 1;
+  if (x0 > x1 || y0 > y1)
+    return;
+  ssd1306_mark_dirty(ssd, x0, y0, x1, y1);
+
+  uint8_t p0 = y0 >> 3;
+  uint8_t p1 = y1 >> 3;
+  uint16_t columns = x1 - x0 + 1;
   uint8_t byte = value ? 0xFF : 0x00;
-  for (uint8_t i = 1; i < ssd->bufsize; ++i)
-    ssd->ram_buffer[i] = byte;
-}*/
 
-void ssd1306_fill(ssd1306_t *ssd, bool value) {
-    // Itera por todas as posições do display
-    for (uint8_t y = 0; y < ssd->height; ++y) {
-        for (uint8_t x = 0; x < ssd->width; ++x) {
-            ssd1306_pixel(ssd, x, y, value);
-        }
+  // Altura total: as colunas formam um bloco contíguo, preenchido por palavras
+  if (p0 == 0 && p1 == ssd->pages - 1 && (y0 & 7) == 0 && (y1 & 7) == 7) {
+    memset(&ssd->ram_buffer[ssd1306_index(x0, 0)], byte, columns << 3);
+    return;
+  }
+
+  for (uint8_t p = p0; p <= p1; ++p) {
+    uint8_t mask = ssd1306_page_mask(p, p0, p1, y0, y1);
+    uint8_t *b = &ssd->ram_buffer[ssd1306_index(x0, p)];
+    if (mask == 0xFF) {
+      for (uint16_t n = columns; n; --n, b += 8)
+        *b = byte;
+    } else if (value) {
+      for (uint16_t n = columns; n; --n, b += 8)
+        *b |= mask;
+    } else {
+      for (uint16_t n = columns; n; --n, b += 8)
+        *b &= ~mask;
+    }
+  }
+}
+
+// Copia a área (x0, y0)-(x1, y1) de um buffer com o mesmo layout do ram_buffer
+void ssd1306_copy_area(ssd1306_t *ssd, const uint8_t *src, uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1) {
+  if (x1 >= ssd->width) x1 = ssd->width - 1;
+  if (y1 >= ssd->height) y1 = ssd->height - 1;
+  if (x0 > x1 || y0 > y1)
+    return;
+  ssd1306_mark_dirty(ssd, x0, y0, x1, y1);
+  uint8_t p0 = y0 >> 3;
+  uint8_t p1 = y1 >> 3;
+  for (uint8_t p = p0; p <= p1; ++p) {
+    uint8_t mask = ssd1306_page_mask(p, p0, p1, y0, y1);
+    for (uint16_t x = x0; x <= x1; ++x) {
+      uint16_t index = ssd1306_index(x, p);
+      ssd->ram_buffer[index] = (ssd->ram_buffer[index] & ~mask) | (src[index] & mask);
     }
+  }
 }
 
+void ssd1306_fill(ssd1306_t *ssd, bool value) {
+  memset(&ssd->ram_buffer[1], value ? 0xFF : 0x00, ssd->bufsize - 1);
+  ssd1306_mark_dirty(ssd, 0, 0, ssd->width - 1, ssd->height - 1);
+}
 
+void ssd1306_fill_rect(ssd1306_t *ssd, uint8_t top, uint8_t left, uint8_t width, uint8_t height, bool value) {
+  if (width == 0 || height == 0)
+    return;
+  ssd1306_fill_area(ssd, left, top, left + width - 1, top + height - 1, value);
+}
 
 void ssd1306_rect(ssd1306_t *ssd, uint8_t top, uint8_t left, uint8_t width, uint8_t height, bool value, bool fill) {
-  for (uint8_t x = left; x < left + width; ++x) {
-    ssd1306_pixel(ssd, x, top, value);
-    ssd1306_pixel(ssd, x, top + height - 1, value);
-  }
-  for (uint8_t y = top; y < top + height; ++y) {
-    ssd1306_pixel(ssd, left, y, value);
-    ssd1306_pixel(ssd, left + width - 1, y, value);
-  }
-
+  if (width == 0 || height == 0)
+    return;
+  int right = left + width - 1;
+  int bottom = top + height - 1;
   if (fill) {
-    for (uint8_t x = left + 1; x < left + width - 1; ++x) {
-      for (uint8_t y = top + 1; y < top + height - 1; ++y) {
-        ssd1306_pixel(ssd, x, y, value);
-      }
-    }
+    ssd1306_fill_area(ssd, left, top, right, bottom, value);
+    return;
   }
+  ssd1306_fill_area(ssd, left, top, right, top, value);
+  ssd1306_fill_area(ssd, left, bottom, right, bottom, value);
+  ssd1306_fill_area(ssd, left, top, left, bottom, value);
+  ssd1306_fill_area(ssd, right, top, right, bottom, value);
 }
 
 void ssd1306_line(ssd1306_t *ssd, uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1, bool value) {
+    // Linhas retas vão direto para os rasterizadores de faixa
+    if (y0 == y1) {
+        ssd1306_hline(ssd, x0 < x1 ? x0 : x1, x0 < x1 ? x1 : x0, y0, value);
+        return;
+    }
+    if (x0 == x1) {
+        ssd1306_vline(ssd, x0, y0 < y1 ? y0 : y1, y0 < y1 ? y1 : y0, value);
+        return;
+    }
+
     int dx = abs(x1 - x0);
     int dy = abs(y1 - y0);
 
@@ -144,43 +529,60 @@ void ssd1306_line(ssd1306_t *ssd, uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1
 
 
 void ssd1306_hline(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t y, bool value) {
-  for (uint8_t x = x0; x <= x1; ++x)
-    ssd1306_pixel(ssd, x, y, value);
+  ssd1306_fill_area(ssd, x0, y, x1, y, value);
 }
 
 void ssd1306_vline(ssd1306_t *ssd, uint8_t x, uint8_t y0, uint8_t y1, bool value) {
-  for (uint8_t y = y0; y <= y1; ++y)
-    ssd1306_pixel(ssd, x, y, value);
+  ssd1306_fill_area(ssd, x, y0, x, y1, value);
+}
+
+// Copia um glifo 8x8 coluna a coluna: cada byte da fonte já tem o formato de
+// uma coluna de página do SSD1306 (bit 0 = linha de cima)
+void ssd1306_blit_glyph(ssd1306_t *ssd, const uint8_t *glyph, uint8_t x, uint8_t y, ssd1306_blit_t mode) {
+  if (x >= ssd->width || y >= ssd->height)
+    return;
+  uint8_t columns = (ssd->width - x < 8) ? ssd->width - x : 8;
+  uint8_t page = y >> 3;
+  uint8_t shift = y & 7;
+  uint8_t *b = &ssd->ram_buffer[ssd1306_index(x, page)];
+  ssd1306_mark_dirty(ssd, x, y, x + columns - 1, y + 7);
+
+  if (shift == 0) {
+    // y alinhado à página: um byte por coluna
+    if (mode == SSD1306_BLIT_OR) {
+      for (uint8_t i = 0; i < columns; ++i, b += 8)
+        *b |= glyph[i];
+    } else {
+      for (uint8_t i = 0; i < columns; ++i, b += 8)
+        *b = glyph[i];
+    }
+    return;
+  }
+
+  // y desalinhado: a coluna se divide entre a página atual e a seguinte
+  bool has_next = page + 1 < ssd->pages;
+  uint8_t mask_lo = 0xFF << shift;
+  uint8_t mask_hi = 0xFF >> (8 - shift);
+  for (uint8_t i = 0; i < columns; ++i, b += 8) {
+    uint8_t lo = glyph[i] << shift;
+    uint8_t hi = glyph[i] >> (8 - shift);
+    if (mode == SSD1306_BLIT_OR) {
+      b[0] |= lo;
+      if (has_next)
+        b[1] |= hi;
+    } else {
+      b[0] = (b[0] & ~mask_lo) | lo;
+      if (has_next)
+        b[1] = (b[1] & ~mask_hi) | hi;
+    }
+  }
 }
 
 // Função para desenhar um caractere
 void ssd1306_draw_char(ssd1306_t *ssd, char c, uint8_t x, uint8_t y)
 {
-  uint16_t index = 0;
-  char ver=c;
-  if (c >= 'A' && c <= 'Z')
-  {
-    index = (c - 'A' + 11) * 8; // Para letras maiúsculas
-  }else  if (c >= '0' && c <= '9')
-  {
-    index = (c - '0' + 1) * 8; // Adiciona o deslocamento necessário
-  }else  if (c >= 'a' && c <= 'z')
-  {
-    index = (c - 'a' + 37) * 8; // Adiciona o deslocamento necessário
-  }else if(c >= ':' && c <= '?'){
-    index = (c - ':' + 63) * 8; // Adiciona o deslocamento necessário
-  }else if(c >= '!' && c <= '/'){
-    index = (c - '!' + 69) * 8; // Adiciona o deslocamento necessário
-  }
-  
-  for (uint8_t i = 0; i < 8; ++i)
-  {
-    uint8_t line = font[index + i];
-    for (uint8_t j = 0; j < 8; ++j)
-    {
-      ssd1306_pixel(ssd, x + i, y + j, line & (1 << j));
-    }
-  }
+  uint8_t glyph = ((uint8_t)c < 128) ? font_glyph[(uint8_t)c] : 0;
+  ssd1306_blit_glyph(ssd, &font[glyph << 3], x, y, SSD1306_BLIT_OPAQUE);
 }
 
 // Função para desenhar uma string
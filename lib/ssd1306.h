@@ -1,9 +1,13 @@
+#ifndef SSD1306_H
+#define SSD1306_H
+
 #include <stdlib.h>
 #include "pico/stdlib.h"
 #include "hardware/i2c.h"
 
 #define WIDTH 128
 #define HEIGHT 64
+#define SSD1306_MAX_PAGES 8
 
 typedef enum {
   SET_CONTRAST = 0x81,
@@ -25,25 +29,81 @@ typedef enum {
   SET_CHARGE_PUMP = 0x8D
 } ssd1306_command_t;
 
+// Modo de envio do ram_buffer: quadro completo ou apenas as janelas alteradas
+typedef enum {
+  SSD1306_FLUSH_FULL,
+  SSD1306_FLUSH_DIRTY
+} ssd1306_flush_mode_t;
+
+// Como um glifo é combinado com o que já está no ram_buffer
+typedef enum {
+  SSD1306_BLIT_OPAQUE,   // Substitui o bloco 8x8 (fundo apagado)
+  SSD1306_BLIT_OR        // Apenas acende os pixels do glifo
+} ssd1306_blit_t;
+
+typedef struct ssd1306 ssd1306_t;
+
+// Chamado (no contexto da IRQ do DMA) quando o quadro inteiro já foi entregue
+// à FIFO de transmissão do I2C
+typedef void (*ssd1306_flush_cb_t)(ssd1306_t *ssd, void *user_data);
+
+// Recebe cada janela x0..x1 x p0..p1 escolhida para envio
+typedef void (*ssd1306_window_fn_t)(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t p0, uint8_t p1, void *ctx);
+
+// Quadro codificado como palavras de IC_DATA_CMD, pronto para o DMA
 typedef struct {
+  uint16_t *words;
+  size_t len;
+  ssd1306_flush_cb_t cb;
+  void *user_data;
+} ssd1306_stream_t;
+
+struct ssd1306 {
   uint8_t width, height, pages, address;
   i2c_inst_t *i2c_port;
   bool external_vcc;
   uint8_t *ram_buffer;
   size_t bufsize;
   uint8_t port_buffer[2];
-} ssd1306_t;
+  ssd1306_flush_mode_t flush_mode;
+  uint8_t *shadow_buffer;                 // Cópia do último quadro enviado ao display
+  uint8_t *tx_buffer;                     // Janela montada para envio parcial
+  bool shadow_valid;
+  uint8_t dirty_x0[SSD1306_MAX_PAGES];    // Faixa de colunas tocadas em cada página
+  uint8_t dirty_x1[SSD1306_MAX_PAGES];    // (x0 > x1 indica página limpa)
+  int dma_channel;                        // -1 enquanto o envio for bloqueante
+  ssd1306_stream_t stream[2];             // Buffer duplo de transmissão
+  volatile int8_t stream_active;          // Fluxo em transmissão (-1 nenhum)
+  volatile int8_t stream_pending;         // Fluxo aguardando a vez (-1 nenhum)
+  uint32_t flushes;                       // Envios com algo a transmitir
+  uint32_t flush_bytes;                   // Bytes de comando e dados postos no barramento
+};
 
 void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c);
 void ssd1306_config(ssd1306_t *ssd);
 void ssd1306_command(ssd1306_t *ssd, uint8_t command);
 void ssd1306_send_data(ssd1306_t *ssd);
+void ssd1306_send_dirty(ssd1306_t *ssd);
+void ssd1306_set_flush_mode(ssd1306_t *ssd, ssd1306_flush_mode_t mode);
+void ssd1306_mark_dirty(ssd1306_t *ssd, uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1);
+void ssd1306_plan_windows(ssd1306_t *ssd, bool dirty_only, ssd1306_window_fn_t emit, void *ctx);
+
+void ssd1306_dma_init(ssd1306_t *ssd);
+size_t ssd1306_encode_frame(ssd1306_t *ssd, ssd1306_stream_t *stream);
+bool ssd1306_send_data_async(ssd1306_t *ssd, ssd1306_flush_cb_t cb, void *user_data);
+bool ssd1306_flush_busy(ssd1306_t *ssd);
+void ssd1306_flush_wait(ssd1306_t *ssd);
 
 void ssd1306_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value);
 void ssd1306_fill(ssd1306_t *ssd, bool value);
+void ssd1306_copy_area(ssd1306_t *ssd, const uint8_t *src, uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1);
+void ssd1306_fill_rect(ssd1306_t *ssd, uint8_t top, uint8_t left, uint8_t width, uint8_t height, bool value);
 void ssd1306_rect(ssd1306_t *ssd, uint8_t top, uint8_t left, uint8_t width, uint8_t height, bool value, bool fill);
 void ssd1306_line(ssd1306_t *ssd, uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1, bool value);
 void ssd1306_hline(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t y, bool value);
 void ssd1306_vline(ssd1306_t *ssd, uint8_t x, uint8_t y0, uint8_t y1, bool value);
+void ssd1306_blit_glyph(ssd1306_t *ssd, const uint8_t *glyph, uint8_t x, uint8_t y, ssd1306_blit_t mode);
 void ssd1306_draw_char(ssd1306_t *ssd, char c, uint8_t x, uint8_t y);
-void ssd1306_draw_string(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y);
\ No newline at end of file
+void ssd1306_draw_string(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y);
+
+#endif
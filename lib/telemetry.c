@@ -0,0 +1,174 @@
+#include <string.h>
+#include "telemetry.h"
+
+// CRC-16/CCITT (polinômio 0x1021, início 0xFFFF) com tabela de 16 entradas
+static const uint16_t crc_nibble[16] = {
+  0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+  0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+};
+
+uint16_t tlm_crc16(const uint8_t *data, size_t len) {
+  uint16_t crc = 0xFFFF;
+  while (len--) {
+    crc = (crc << 4) ^ crc_nibble[(crc >> 12) ^ (*data >> 4)];
+    crc = (crc << 4) ^ crc_nibble[(crc >> 12) ^ (*data++ & 0x0F)];
+  }
+  return crc;
+}
+
+// COBS: cada zero vira a distância até o próximo; a saída não tem zeros e
+// cresce no máximo 1 byte a cada 254
+size_t tlm_cobs_encode(const uint8_t *in, size_t len, uint8_t *out) {
+  size_t code_pos = 0, o = 1;
+  uint8_t code = 1;
+  for (size_t i = 0; i < len; ++i) {
+    if (in[i]) {
+      out[o++] = in[i];
+      code++;
+    }
+    if (!in[i] || code == 0xFF) {
+      out[code_pos] = code;
+      code_pos = o++;
+      code = 1;
+    }
+  }
+  out[code_pos] = code;
+  return o;
+}
+
+// 0 se a entrada não é COBS válido (zero no meio ou bloco além do fim)
+size_t tlm_cobs_decode(const uint8_t *in, size_t len, uint8_t *out) {
+  size_t o = 0;
+  for (size_t i = 0; i < len;) {
+    uint8_t code = in[i++];
+    if (!code || i + code - 1 > len)
+      return 0;
+    for (uint8_t k = 1; k < code; ++k) {
+      if (!in[i])
+        return 0;
+      out[o++] = in[i++];
+    }
+    if (code != 0xFF && i < len)
+      out[o++] = 0;
+  }
+  return o;
+}
+
+void tlm_init(tlm_t *t, tlm_write_fn write, void *ctx) {
+  t->len = 0;
+  t->seq = 0;
+  t->head = t->tail = 0;
+  t->write = write;
+  t->ctx = ctx;
+  t->stats = (tlm_stats_t){ 0 };
+}
+
+// Fecha o quadro aberto: CRC, COBS e os zeros, inteiro no anel ou descartado
+void tlm_close(tlm_t *t) {
+  if (!t->len)
+    return;
+  uint8_t raw[TLM_FRAME_MAX + 2];
+  uint8_t enc[TLM_PACKET];
+  memcpy(raw, t->frame, t->len);
+  tlm_put16(raw + t->len, tlm_crc16(t->frame, t->len));
+  enc[0] = 0;
+  size_t n = 1 + tlm_cobs_encode(raw, t->len + 2u, enc + 1);
+  enc[n++] = 0;
+  t->len = 0;
+  t->stats.frames++;
+  if (TLM_RING_LEN - tlm_pending(t) < n) {
+    t->stats.dropped_frames++;
+    t->stats.dropped_bytes += n;
+    return;
+  }
+  for (size_t i = 0; i < n; ++i)
+    t->ring[t->head++ & (TLM_RING_LEN - 1)] = enc[i];
+}
+
+// Acrescenta um registro ao quadro aberto, fechando-o antes se não couber ou
+// se o atraso não cabe nos 16 bits. false só para registro maior que um quadro
+bool tlm_record(tlm_t *t, uint8_t type, uint32_t t_ms, const uint8_t *data, uint8_t len) {
+  if (TLM_HEADER + TLM_REC_HEADER + len > TLM_FRAME_MAX)
+    return false;
+  if (t->len && (t->len + TLM_REC_HEADER + len > TLM_FRAME_MAX || t_ms - t->t0_ms > UINT16_MAX))
+    tlm_close(t);
+  if (!t->len) {
+    t->frame[0] = TLM_VERSION;
+    tlm_put16(t->frame + 1, t->seq++);
+    tlm_put32(t->frame + 3, t_ms);
+    t->t0_ms = t_ms;
+    t->len = TLM_HEADER;
+  }
+  uint8_t *p = t->frame + t->len;
+  p[0] = type;
+  p[1] = len;
+  tlm_put16(p + 2, t_ms - t->t0_ms);
+  memcpy(p + TLM_REC_HEADER, data, len);
+  t->len += TLM_REC_HEADER + len;
+  t->stats.records++;
+  return true;
+}
+
+// Fecha o quadro que envelheceu e entrega ao porto o que ele aceitar agora,
+// no máximo até a volta do anel por chamada
+void tlm_poll(tlm_t *t, uint32_t now_ms) {
+  if (t->len && now_ms - t->t0_ms >= TLM_BATCH_MS)
+    tlm_close(t);
+  while (tlm_pending(t) && t->write) {
+    uint32_t index = t->tail & (TLM_RING_LEN - 1);
+    uint32_t chunk = TLM_RING_LEN - index;
+    if (chunk > tlm_pending(t))
+      chunk = tlm_pending(t);
+    size_t n = t->write(t->ctx, &t->ring[index], chunk);
+    t->tail += n;
+    t->stats.bytes_out += n;
+    if (n < chunk)
+      break;
+  }
+}
+
+tlm_dec_result_t tlm_decode_byte(tlm_decoder_t *d, uint8_t byte, uint8_t *raw, size_t *raw_len) {
+  if (byte) {
+    if (d->len < sizeof(d->buf))
+      d->buf[d->len++] = byte;
+    else
+      d->overflow = true;
+    return TLM_DEC_NONE;
+  }
+  size_t len = d->len;
+  bool overflow = d->overflow;
+  d->len = 0;
+  d->overflow = false;
+  if (!len)
+    return TLM_DEC_NONE;   // Zeros seguidos (fim de um quadro e início do próximo)
+
+  // Nos erros, raw leva os bytes recebidos: texto intercalado pode ser mostrado
+  size_t n = overflow ? 0 : tlm_cobs_decode(d->buf, len, raw);
+  if (overflow || n < TLM_HEADER + 2 || n > TLM_FRAME_MAX + 2) {
+    memcpy(raw, d->buf, len);
+    *raw_len = len;
+    return overflow ? TLM_DEC_TOO_LONG : TLM_DEC_BAD_COBS;
+  }
+  if (tlm_crc16(raw, n - 2) != tlm_get16(raw + n - 2) || raw[0] != TLM_VERSION) {
+    memcpy(raw, d->buf, len);
+    *raw_len = len;
+    return TLM_DEC_BAD_CRC;
+  }
+  *raw_len = n - 2;
+  return TLM_DEC_FRAME;
+}
+
+// Percorre os registros de um quadro decodificado; pos começa em 0
+bool tlm_frame_next(const uint8_t *raw, size_t len, size_t *pos, tlm_rec_t *r) {
+  if (*pos < TLM_HEADER)
+    *pos = TLM_HEADER;
+  if (*pos + TLM_REC_HEADER > len || *pos + TLM_REC_HEADER + raw[*pos + 1] > len)
+    return false;
+  const uint8_t *p = raw + *pos;
+  r->type = p[0];
+  r->len = p[1];
+  r->t_ms = tlm_get32(raw + 3) + tlm_get16(p + 2);
+  r->data = p + TLM_REC_HEADER;
+  *pos += TLM_REC_HEADER + r->len;
+  return true;
+}
@@ -0,0 +1,127 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Telemetria binária em quadros. Os registros (tipo, tamanho, atraso em ms
+// desde o início do quadro e os dados) se acumulam num quadro aberto até ele
+// encher (um pacote bulk de 64 bytes do USB full-speed) ou envelhecer
+// TLM_BATCH_MS. Ao fechar, o quadro ganha um CRC-16 e é codificado em COBS
+// entre dois bytes 0x00: o receptor se ressincroniza no próximo zero, e o
+// texto do printf intercalado na mesma porta só estraga a si mesmo.
+//
+// Os quadros fechados vão inteiros para um anel em RAM ou são descartados
+// (e contados) se não couberem. tlm_poll() passa ao porto só o que ele aceita
+// sem esperar: com o host sem ler, os dados se perdem e o controle segue.
+// O número de sequência conta também os descartados, e o host vê as lacunas.
+//
+// Quadro antes do COBS, tudo little-endian:
+//   versão (1) | sequência (2) | t0 em ms (4) | registros... | CRC-16 (2)
+// Registro: tipo (1) | tamanho dos dados (1) | t - t0 em ms (2) | dados
+// Sem dependência de hardware: o mesmo código codifica no firmware e no
+// teste do tools/tlm_decode, que também usa o decodificador daqui.
+
+#define TLM_VERSION    1
+#define TLM_PACKET     64                  // Quadro codificado, com os delimitadores
+#define TLM_FRAME_MAX  (TLM_PACKET - 5)    // Cabeçalho e registros (sem CRC, COBS e zeros)
+#define TLM_HEADER     7
+#define TLM_REC_HEADER 4
+#define TLM_RING_BITS  10
+#define TLM_RING_LEN   (1u << TLM_RING_BITS)
+#define TLM_BATCH_MS   250                 // Idade máxima do quadro aberto
+
+// Registros do firmware; valores Q8 e dBFS em int16, como nas leituras
+typedef enum {
+  TLM_SENSORS = 1,   // Temperatura, umidade, luminosidade (Q8) e som (dBFS Q8)
+  TLM_AUDIO,         // Pico e as 4 bandas do microfone (dBFS Q8)
+  TLM_STATUS,        // Estado de energia, bits (bomba, alerta, rega armada),
+                     // quadros descartados, amostras do ADC e blocos de áudio perdidos
+  TLM_TYPES
+} tlm_type_t;
+
+#define TLM_SENSORS_LEN 8
+#define TLM_AUDIO_LEN   10
+#define TLM_STATUS_LEN  14
+
+// Porto de saída: escreve o que puder agora e retorna quantos bytes aceitou
+typedef size_t (*tlm_write_fn)(void *ctx, const uint8_t *data, size_t len);
+
+typedef struct {
+  uint32_t records;
+  uint32_t frames;                         // Quadros fechados (enviados ou não)
+  uint32_t dropped_frames;                 // Sem espaço no anel
+  uint32_t dropped_bytes;
+  uint32_t bytes_out;                      // Aceitos pelo porto
+} tlm_stats_t;
+
+typedef struct {
+  uint8_t frame[TLM_FRAME_MAX];
+  uint8_t len;                             // 0: nenhum quadro aberto
+  uint16_t seq;
+  uint32_t t0_ms;
+  uint8_t ring[TLM_RING_LEN];
+  uint32_t head, tail;                     // Bytes escritos e entregues ao porto
+  tlm_write_fn write;
+  void *ctx;
+  tlm_stats_t stats;
+} tlm_t;
+
+void tlm_init(tlm_t *t, tlm_write_fn write, void *ctx);
+bool tlm_record(tlm_t *t, uint8_t type, uint32_t t_ms, const uint8_t *data, uint8_t len);
+void tlm_close(tlm_t *t);
+void tlm_poll(tlm_t *t, uint32_t now_ms);
+
+static inline uint32_t tlm_pending(const tlm_t *t) {
+  return t->head - t->tail;
+}
+
+static inline uint8_t *tlm_put16(uint8_t *p, uint16_t v) {
+  p[0] = v;
+  p[1] = v >> 8;
+  return p + 2;
+}
+
+static inline uint8_t *tlm_put32(uint8_t *p, uint32_t v) {
+  return tlm_put16(tlm_put16(p, v), v >> 16);
+}
+
+static inline uint16_t tlm_get16(const uint8_t *p) {
+  return p[0] | (p[1] << 8);
+}
+
+static inline uint32_t tlm_get32(const uint8_t *p) {
+  return tlm_get16(p) | ((uint32_t)tlm_get16(p + 2) << 16);
+}
+
+uint16_t tlm_crc16(const uint8_t *data, size_t len);
+size_t tlm_cobs_encode(const uint8_t *in, size_t len, uint8_t *out);
+size_t tlm_cobs_decode(const uint8_t *in, size_t len, uint8_t *out);
+
+// Lado do receptor: junta bytes até um zero e entrega o quadro conferido
+// (sem o CRC) em raw, que deve ter TLM_PACKET bytes
+typedef enum {
+  TLM_DEC_NONE,                            // Nada completo ainda
+  TLM_DEC_FRAME,                           // Quadro válido em raw
+  TLM_DEC_BAD_COBS,
+  TLM_DEC_BAD_CRC,
+  TLM_DEC_TOO_LONG,                        // Mais que um quadro sem zero (texto, lixo)
+} tlm_dec_result_t;
+
+typedef struct {
+  uint8_t buf[TLM_PACKET];
+  size_t len;
+  bool overflow;
+} tlm_decoder_t;
+
+typedef struct {
+  uint8_t type, len;
+  uint32_t t_ms;
+  const uint8_t *data;
+} tlm_rec_t;
+
+tlm_dec_result_t tlm_decode_byte(tlm_decoder_t *d, uint8_t byte, uint8_t *raw, size_t *raw_len);
+bool tlm_frame_next(const uint8_t *raw, size_t len, size_t *pos, tlm_rec_t *r);
+
+#endif
@@ -0,0 +1,150 @@
+#include "tone.h"
+#include "hardware/pwm.h"
+#include "hardware/clocks.h"
+#include "hardware/sync.h"
+
+static uint tone_slice;
+static uint tone_channel;
+
+// Fila de notas avulsas (produtor: tarefas; consumidor: alarme)
+static tone_note_t queue[TONE_QUEUE_LEN];
+static volatile uint8_t q_head;
+static volatile uint8_t q_tail;
+
+// Padrão em execução (tem prioridade sobre a fila enquanto durar)
+static const tone_note_t *pattern;
+static size_t pattern_len;
+static size_t pattern_pos;
+static bool pattern_loop;
+
+static alarm_id_t tone_alarm;
+static volatile bool playing;
+
+// Programa o slice para freq_hz: menor divisor que deixa o wrap caber em 16 bits
+static void tone_output(uint16_t freq_hz, uint8_t duty_pct) {
+  if (freq_hz == TONE_REST || duty_pct == 0) {
+    pwm_set_chan_level(tone_slice, tone_channel, 0);
+    return;
+  }
+  uint32_t clk = clock_get_hz(clk_sys);
+  uint32_t div16 = (uint32_t)(((uint64_t)clk * 16 + (uint64_t)freq_hz * 65536 - 1) / ((uint64_t)freq_hz * 65536));
+  if (div16 < 16)
+    div16 = 16;
+  if (div16 > 0xFFF)
+    div16 = 0xFFF;
+  uint32_t wrap = (uint32_t)(((uint64_t)clk * 16) / (div16 * freq_hz)) - 1;
+  if (wrap > 0xFFFF)
+    wrap = 0xFFFF;
+  if (duty_pct > 100)
+    duty_pct = 100;
+  pwm_set_clkdiv_int_frac(tone_slice, div16 >> 4, div16 & 0xF);
+  pwm_set_wrap(tone_slice, wrap);
+  pwm_set_chan_level(tone_slice, tone_channel, (wrap + 1) * duty_pct / 100);
+}
+
+// Próxima nota: padrão primeiro, depois a fila; false quando não resta nada
+static bool tone_next(tone_note_t *note) {
+  if (pattern) {
+    if (pattern_pos == pattern_len && pattern_loop)
+      pattern_pos = 0;
+    if (pattern_pos < pattern_len) {
+      *note = pattern[pattern_pos++];
+      return true;
+    }
+    pattern = NULL;
+  }
+  if (q_tail != q_head) {
+    *note = queue[q_tail & (TONE_QUEUE_LEN - 1)];
+    q_tail++;
+    return true;
+  }
+  return false;
+}
+
+// Toca a próxima nota e devolve em quantos us o alarme deve voltar (0 = acabou)
+static int64_t tone_advance(void) {
+  tone_note_t note;
+  if (tone_next(&note)) {
+    tone_output(note.freq_hz, note.duty_pct);
+    // Duração zero vira 1 ms: um padrão em laço nunca prende o alarme
+    return note.duration_ms ? (int64_t)note.duration_ms * 1000 : 1000;
+  }
+  tone_output(TONE_REST, 0);
+  playing = false;
+  tone_alarm = 0;
+  return 0;
+}
+
+static int64_t tone_alarm_cb(alarm_id_t id, void *user_data) {
+  return tone_advance();
+}
+
+// Dispara a sequência se o gerador estava parado
+static void tone_kick(void) {
+  if (playing)
+    return;
+  playing = true;
+  int64_t delay = tone_advance();
+  if (delay > 0) {
+    tone_alarm = add_alarm_in_us(delay, tone_alarm_cb, NULL, true);
+    if (tone_alarm <= 0) {
+      tone_output(TONE_REST, 0);
+      playing = false;
+      tone_alarm = 0;
+    }
+  }
+}
+
+void tone_init(uint gpio) {
+  tone_slice = pwm_gpio_to_slice_num(gpio);
+  tone_channel = pwm_gpio_to_channel(gpio);
+  gpio_set_function(gpio, GPIO_FUNC_PWM);
+  pwm_config cfg = pwm_get_default_config();
+  pwm_init(tone_slice, &cfg, true);
+  pwm_set_chan_level(tone_slice, tone_channel, 0);
+}
+
+// Nota avulsa no fim da fila; retorna false se a fila estiver cheia
+bool tone_play(uint16_t freq_hz, uint8_t duty_pct, uint16_t duration_ms) {
+  tone_note_t note = { freq_hz, duration_ms, duty_pct };
+  return tone_enqueue(&note, 1) == 1;
+}
+
+// Acrescenta notas à fila; retorna quantas couberam
+size_t tone_enqueue(const tone_note_t *notes, size_t n) {
+  uint32_t status = save_and_disable_interrupts();
+  size_t added = 0;
+  while (added < n && (uint8_t)(q_head - q_tail) < TONE_QUEUE_LEN) {
+    queue[q_head & (TONE_QUEUE_LEN - 1)] = notes[added++];
+    q_head++;
+  }
+  restore_interrupts(status);
+  tone_kick();
+  return added;
+}
+
+// Substitui o que estiver tocando pelo padrão (a tabela deve continuar válida)
+void tone_play_pattern(const tone_note_t *notes, size_t n, bool loop) {
+  tone_stop();
+  pattern = notes;
+  pattern_len = n;
+  pattern_pos = 0;
+  pattern_loop = loop && n > 0;
+  tone_kick();
+}
+
+void tone_stop(void) {
+  uint32_t status = save_and_disable_interrupts();
+  if (tone_alarm > 0)
+    cancel_alarm(tone_alarm);
+  tone_alarm = 0;
+  pattern = NULL;
+  q_tail = q_head;
+  playing = false;
+  restore_interrupts(status);
+  tone_output(TONE_REST, 0);
+}
+
+bool tone_busy(void) {
+  return playing;
+}
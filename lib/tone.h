@@ -0,0 +1,25 @@
+#ifndef TONE_H
+#define TONE_H
+
+#include "pico/stdlib.h"
+
+// Gerador de tons em um slice PWM: a onda é feita pelo hardware e um alarme
+// avança a sequência de notas; nenhuma chamada espera o som terminar
+
+#define TONE_QUEUE_LEN 16          // Notas na fila (potência de 2)
+#define TONE_REST      0           // Frequência 0 = pausa
+
+typedef struct {
+  uint16_t freq_hz;                // TONE_REST para silêncio
+  uint16_t duration_ms;
+  uint8_t duty_pct;                // Ciclo de trabalho (0-100); 50 = volume máximo no buzzer passivo
+} tone_note_t;
+
+void tone_init(uint gpio);
+bool tone_play(uint16_t freq_hz, uint8_t duty_pct, uint16_t duration_ms);
+size_t tone_enqueue(const tone_note_t *notes, size_t n);
+void tone_play_pattern(const tone_note_t *notes, size_t n, bool loop);
+void tone_stop(void);
+bool tone_busy(void);
+
+#endif
@@ -0,0 +1,83 @@
+#include <stdio.h>
+#include "trace.h"
+
+#if TRACE_ENABLED
+
+trace_ring_t trace_rings[2];
+
+#define TRACE_NAME(id, name, kind) name,
+#define TRACE_KIND(id, name, kind) kind,
+static const char *const trace_names[] = { TRACE_EVENTS(TRACE_NAME) };
+static const uint8_t trace_kinds[] = { TRACE_EVENTS(TRACE_KIND) };
+
+#define TRACE_RECS_PER_LINE 8
+
+void trace_clear(void) {
+  for (uint core = 0; core < 2; ++core) {
+    trace_ring_t *r = &trace_rings[core];
+    r->tail = r->head;
+    r->lost = 0;
+  }
+}
+
+// Copia um registro do anel do outro núcleo sem travá-lo: se o escritor deu a
+// volta por cima dele durante a cópia, o registro é descartado como perdido
+static bool trace_copy(trace_ring_t *r, uint32_t index, trace_rec_t *out) {
+  *out = r->recs[index & (TRACE_RING_LEN - 1)];
+  __dmb();
+  return r->head - index <= TRACE_RING_LEN;
+}
+
+static void trace_dump_ring(uint core, uint32_t head) {
+  trace_ring_t *r = &trace_rings[core];
+  if (head - r->tail > TRACE_RING_LEN) {
+    r->lost += head - r->tail - TRACE_RING_LEN;
+    r->tail = head - TRACE_RING_LEN;
+  }
+
+  uint8_t line = 0;
+  while (r->tail != head) {
+    trace_rec_t rec;
+    if (!trace_copy(r, r->tail, &rec)) {
+      r->lost++;
+      r->tail++;
+      continue;
+    }
+    if (line == 0)
+      printf("#T %u", core);
+    printf(" %08lx%04x%04x", (unsigned long)rec.t_us, rec.event, rec.arg);
+    if (++line == TRACE_RECS_PER_LINE) {
+      printf("\n");
+      line = 0;
+    }
+    r->tail++;
+  }
+  if (line)
+    printf("\n");
+}
+
+// Despeja pelo stdio (USB) tudo o que foi gravado desde o último despejo.
+// A saída é texto: linhas "#E" descrevem os eventos, "#T <núcleo>" trazem os
+// registros (tempo, evento e argumento em hexa) e o instante "agora", lido
+// depois de fixar o fim de cada anel, ancora os tempos de 32 bits
+void trace_dump(void) {
+  uint32_t heads[2] = { trace_rings[0].head, trace_rings[1].head };
+  printf("#trace inicio agora=%llu\n", (unsigned long long)time_us_64());
+  for (uint i = 0; i < TRACE_EVENT_COUNT; ++i)
+    printf("#E %u %s %u\n", i, trace_names[i], trace_kinds[i]);
+  for (uint core = 0; core < 2; ++core)
+    trace_dump_ring(core, heads[core]);
+  printf("#trace fim perdidos=%lu,%lu\n", (unsigned long)trace_rings[0].lost,
+         (unsigned long)trace_rings[1].lost);
+}
+
+#else
+
+// Sem trace os anéis nem existem; o comando só avisa
+void trace_clear(void) {}
+
+void trace_dump(void) {
+  printf("#trace desligado (compilado com TRACE_ENABLED=0)\n");
+}
+
+#endif
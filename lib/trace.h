@@ -0,0 +1,86 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include "hardware/timer.h"
+
+// Registro de eventos em RAM para medir o caminho quente sem printf.
+// Cada ponto grava 8 bytes (tempo em us, evento e argumento) num anel por
+// núcleo; com TRACE_ENABLED em 0 as macros somem e não custam nada.
+// O anel sobrescreve os registros mais antigos: trace_dump() despeja o que
+// ainda não foi lido, em hexadecimal, para o tools/trace_decode.
+
+#ifndef TRACE_ENABLED
+#define TRACE_ENABLED 1
+#endif
+
+#define TRACE_RING_LEN 1024        // Registros por núcleo (potência de 2), 8 KB cada
+
+// Eventos: nome para o decodificador e tipo (pares de início/fim viram intervalos)
+#define TRACE_EVENTS(X)                                                  \
+  X(TRACE_TASK_BEGIN,   "tarefa",       TRACE_KIND_BEGIN) /* arg: id  */ \
+  X(TRACE_TASK_END,     "tarefa",       TRACE_KIND_END)                  \
+  X(TRACE_RENDER_BEGIN, "render",       TRACE_KIND_BEGIN) /* núcleo 1 */ \
+  X(TRACE_RENDER_END,   "render",       TRACE_KIND_END)                  \
+  X(TRACE_ADC_BATCH,    "adc_lote",     TRACE_KIND_MARK)  /* amostras */ \
+  X(TRACE_ADC_LOST,     "adc_perdidas", TRACE_KIND_MARK)  /* amostras */ \
+  X(TRACE_FLUSH_BEGIN,  "envio_oled",   TRACE_KIND_BEGIN) /* palavras */ \
+  X(TRACE_FLUSH_END,    "envio_oled",   TRACE_KIND_END)                  \
+  X(TRACE_ISR_GPIO,     "isr_gpio",     TRACE_KIND_MARK)  /* gpio     */ \
+  X(TRACE_ISR_DMA,      "isr_dma",      TRACE_KIND_MARK)  /* canal    */ \
+  X(TRACE_PUMP,         "bomba",        TRACE_KIND_MARK)  /* 1 ou 0   */ \
+  X(TRACE_ALERT,        "alerta",       TRACE_KIND_MARK)  /* 1 ou 0   */ \
+  X(TRACE_FLASH_BEGIN,  "flash",        TRACE_KIND_BEGIN) /* 1: apaga */ \
+  X(TRACE_FLASH_END,    "flash",        TRACE_KIND_END)                  \
+  X(TRACE_INPUT,        "entrada_ev",   TRACE_KIND_MARK)  /* fonte<<4 */ \
+  X(TRACE_INPUT_DONE,   "reacao",       TRACE_KIND_MARK)  /* | tipo   */
+
+typedef enum {
+  TRACE_KIND_MARK,
+  TRACE_KIND_BEGIN,
+  TRACE_KIND_END,
+} trace_kind_t;
+
+#define TRACE_ENUM(id, name, kind) id,
+typedef enum { TRACE_EVENTS(TRACE_ENUM) TRACE_EVENT_COUNT } trace_event_t;
+#undef TRACE_ENUM
+
+typedef struct {
+  uint32_t t_us;                   // Parte baixa do timer de 1 us (volta a cada 71 min)
+  uint16_t event;
+  uint16_t arg;
+} trace_rec_t;
+
+typedef struct {
+  trace_rec_t recs[TRACE_RING_LEN];
+  volatile uint32_t head;          // Registros gravados desde o boot
+  uint32_t tail;                   // Próximo a despejar (só quem despeja escreve)
+  uint32_t lost;                   // Sobrescritos antes de serem despejados
+} trace_ring_t;
+
+extern trace_ring_t trace_rings[2];
+
+// O registro inteiro é gravado com as interrupções desligadas, então uma ISR
+// nunca deixa meio registro no anel do seu núcleo; cada núcleo só escreve no seu
+static inline void trace_record(trace_event_t event, uint16_t arg) {
+  trace_ring_t *r = &trace_rings[get_core_num()];
+  uint32_t irq_state = save_and_disable_interrupts();
+  trace_rec_t *rec = &r->recs[r->head & (TRACE_RING_LEN - 1)];
+  rec->t_us = time_us_32();
+  rec->event = event;
+  rec->arg = arg;
+  r->head++;
+  restore_interrupts(irq_state);
+}
+
+#if TRACE_ENABLED
+#define TRACE(event, arg) trace_record((event), (uint16_t)(arg))
+#else
+#define TRACE(event, arg) ((void)0)
+#endif
+
+void trace_clear(void);
+void trace_dump(void);
+
+#endif
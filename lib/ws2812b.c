@@ -0,0 +1,87 @@
+#include <string.h>
+#include "ws2812b.h"
+#include "hardware/dma.h"
+#include "hardware/sync.h"
+
+static void ws2812b_start(ws2812b_t *strip, uint8_t slot);
+
+// Fim do envio + intervalo de reset: a linha está livre para o próximo quadro
+static int64_t ws2812b_latch_cb(alarm_id_t id, void *user_data) {
+  ws2812b_t *strip = user_data;
+  strip->latch_alarm = 0;
+  if (strip->pending) {
+    // Leva o último quadro publicado, nunca o que está em composição
+    strip->pending = false;
+    ws2812b_start(strip, strip->wire ^ 1);
+  } else {
+    strip->busy = false;
+  }
+  return 0;
+}
+
+// Dispara o DMA de uma cópia completa; a outra passa a receber o próximo quadro
+static void ws2812b_start(ws2812b_t *strip, uint8_t slot) {
+  strip->wire = slot;
+  strip->busy = true;
+  strip->frames++;
+  dma_channel_transfer_from_buffer_now(strip->dma_channel, strip->out[slot], strip->n_leds);
+
+  // O DMA termina antes do PIO: conta o quadro inteiro no fio (FIFO incluso) mais o reset
+  uint32_t hold_us = strip->n_leds * WS2812B_US_PER_LED + WS2812B_RESET_US;
+  strip->latch_alarm = strip->alarm_pool
+      ? alarm_pool_add_alarm_in_us(strip->alarm_pool, hold_us, ws2812b_latch_cb, strip, true)
+      : add_alarm_in_us(hold_us, ws2812b_latch_cb, strip, true);
+  if (strip->latch_alarm <= 0) {
+    busy_wait_us(hold_us);
+    strip->latch_alarm = 0;
+    strip->busy = false;
+  }
+}
+
+void ws2812b_init(ws2812b_t *strip, PIO pio, uint sm, uint16_t n_leds) {
+  memset(strip, 0, sizeof(*strip));
+  strip->pio = pio;
+  strip->sm = sm;
+  strip->n_leds = n_leds > WS2812B_MAX_LEDS ? WS2812B_MAX_LEDS : n_leds;
+
+  strip->dma_channel = dma_claim_unused_channel(true);
+  dma_channel_config c = dma_channel_get_default_config(strip->dma_channel);
+  channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+  channel_config_set_read_increment(&c, true);
+  channel_config_set_write_increment(&c, false);
+  channel_config_set_dreq(&c, pio_get_dreq(pio, sm, true));
+  dma_channel_configure(strip->dma_channel, &c, &pio->txf[sm], NULL, 0, false);
+}
+
+// O alarme de latch precisa disparar no mesmo núcleo que chama ws2812b_show:
+// a exclusão mútua com ele é feita só desligando as interrupções locais
+void ws2812b_set_alarm_pool(ws2812b_t *strip, alarm_pool_t *pool) {
+  strip->alarm_pool = pool;
+}
+
+void ws2812b_clear(ws2812b_t *strip) {
+  memset(strip->frame, 0, strip->n_leds * sizeof(uint32_t));
+}
+
+// Publica o quadro em composição, copiado inteiro para a cópia que não está
+// no fio; a composição pode seguir logo depois. Retorna true se o envio começou
+// agora; com a linha ocupada o quadro fica pendente (um mais novo o substitui)
+// e sai assim que o reset terminar
+bool ws2812b_show(ws2812b_t *strip) {
+  uint32_t status = save_and_disable_interrupts();
+  uint8_t slot = strip->wire ^ 1;
+  memcpy(strip->out[slot], strip->frame, strip->n_leds * sizeof(uint32_t));
+  bool start = !strip->busy;
+  if (start)
+    strip->busy = true;
+  else
+    strip->pending = true;
+  restore_interrupts(status);
+  if (start)
+    ws2812b_start(strip, slot);
+  return start;
+}
+
+bool ws2812b_busy(const ws2812b_t *strip) {
+  return strip->busy;
+}
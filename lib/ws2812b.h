@@ -0,0 +1,46 @@
+#ifndef WS2812B_H
+#define WS2812B_H
+
+#include "pico/stdlib.h"
+#include "hardware/pio.h"
+
+// Quadro da matriz WS2812B já empacotado no formato da máquina de estados
+// (GRB nos 24 bits altos), enviado por DMA com buffer duplo: ws2812b_show
+// copia o quadro composto para a cópia livre, e só quadros completos vão ao fio
+
+#define WS2812B_MAX_LEDS  25
+#define WS2812B_US_PER_LED 30      // 24 bits a 1,25 us
+#define WS2812B_RESET_US  300      // Tempo em nível baixo para o quadro ser travado (latch)
+
+typedef struct {
+  PIO pio;
+  uint sm;
+  int dma_channel;
+  uint16_t n_leds;
+  uint32_t frame[WS2812B_MAX_LEDS];      // Em composição
+  uint32_t out[2][WS2812B_MAX_LEDS];     // Quadros completos: um no fio, outro pronto
+  uint8_t wire;                    // Cópia que está (ou esteve) no fio
+  volatile bool busy;              // Envio ou intervalo de reset em curso
+  volatile bool pending;           // Há um quadro pronto esperando a linha
+  alarm_id_t latch_alarm;
+  alarm_pool_t *alarm_pool;        // Pool do núcleo que compõe os quadros (NULL = padrão)
+  uint32_t frames;                 // Quadros efetivamente enviados
+} ws2812b_t;
+
+void ws2812b_init(ws2812b_t *strip, PIO pio, uint sm, uint16_t n_leds);
+void ws2812b_set_alarm_pool(ws2812b_t *strip, alarm_pool_t *pool);
+void ws2812b_clear(ws2812b_t *strip);
+bool ws2812b_show(ws2812b_t *strip);
+bool ws2812b_busy(const ws2812b_t *strip);
+
+static inline uint32_t ws2812b_pack(uint8_t r, uint8_t g, uint8_t b) {
+  return ((uint32_t)g << 24) | ((uint32_t)r << 16) | ((uint32_t)b << 8);
+}
+
+// Atualiza o LED direto no quadro em composição
+static inline void ws2812b_set(ws2812b_t *strip, uint16_t index, uint8_t r, uint8_t g, uint8_t b) {
+  if (index < strip->n_leds)
+    strip->frame[index] = ws2812b_pack(r, g, b);
+}
+
+#endif
@@ -0,0 +1,16 @@
+#ifndef SIM_HARDWARE_CLOCKS_H
+#define SIM_HARDWARE_CLOCKS_H
+
+#include "pico.h"
+
+enum clock_index {
+  clk_gpout0 = 0, clk_gpout1, clk_gpout2, clk_gpout3,
+  clk_ref, clk_sys, clk_peri, clk_usb, clk_adc, clk_rtc,
+  CLK_COUNT
+};
+
+uint32_t clock_get_hz(enum clock_index clk_index);
+bool set_sys_clock_khz(uint32_t freq_khz, bool required);
+void set_sys_clock_48mhz(void);
+
+#endif
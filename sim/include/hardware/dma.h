@@ -0,0 +1,56 @@
+#ifndef SIM_HARDWARE_DMA_H
+#define SIM_HARDWARE_DMA_H
+
+#include "pico.h"
+
+#define NUM_DMA_CHANNELS 12
+
+enum dma_channel_transfer_size { DMA_SIZE_8 = 0, DMA_SIZE_16 = 1, DMA_SIZE_32 = 2 };
+
+// Fontes de DREQ usadas pelo firmware (numeração do RP2040)
+enum dma_channel_transfer_dreq {
+  DREQ_PIO0_TX0 = 0, DREQ_PIO0_TX1, DREQ_PIO0_TX2, DREQ_PIO0_TX3,
+  DREQ_PIO1_TX0 = 8,
+  DREQ_I2C0_TX = 32, DREQ_I2C0_RX, DREQ_I2C1_TX, DREQ_I2C1_RX,
+  DREQ_ADC = 36,
+  DREQ_FORCE = 63,
+};
+
+typedef struct {
+  uint8_t size;
+  bool read_increment;
+  bool write_increment;
+  bool ring_write;
+  uint8_t ring_bits;
+  uint dreq;
+} dma_channel_config;
+
+// Só os campos numéricos; os endereços de verdade ficam no estado da simulação
+typedef struct {
+  volatile uint32_t read_addr;
+  volatile uint32_t write_addr;
+  volatile uint32_t transfer_count;
+  volatile uint32_t ctrl_trig;
+} dma_channel_hw_t;
+
+int dma_claim_unused_channel(bool required);
+void dma_channel_unclaim(uint channel);
+dma_channel_config dma_channel_get_default_config(uint channel);
+void channel_config_set_transfer_data_size(dma_channel_config *c, enum dma_channel_transfer_size size);
+void channel_config_set_read_increment(dma_channel_config *c, bool incr);
+void channel_config_set_write_increment(dma_channel_config *c, bool incr);
+void channel_config_set_ring(dma_channel_config *c, bool write, uint size_bits);
+void channel_config_set_dreq(dma_channel_config *c, uint dreq);
+void dma_channel_configure(uint channel, const dma_channel_config *config, volatile void *write_addr,
+                           const volatile void *read_addr, uint transfer_count, bool trigger);
+void dma_channel_transfer_from_buffer_now(uint channel, const volatile void *read_addr, uint32_t transfer_count);
+void dma_channel_transfer_to_buffer_now(uint channel, volatile void *write_addr, uint32_t transfer_count);
+dma_channel_hw_t *dma_channel_hw_addr(uint channel);
+bool dma_channel_is_busy(uint channel);
+void dma_channel_wait_for_finish_blocking(uint channel);
+void dma_channel_abort(uint channel);
+void dma_channel_set_irq0_enabled(uint channel, bool enabled);
+bool dma_channel_get_irq0_status(uint channel);
+void dma_channel_acknowledge_irq0(uint channel);
+
+#endif
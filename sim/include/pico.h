@@ -0,0 +1,23 @@
+#ifndef SIM_PICO_H
+#define SIM_PICO_H
+
+// Subconjunto do Pico SDK usado pelo firmware, implementado pela HAL simulada (sim/)
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef unsigned int uint;
+
+#define PICO_ON_DEVICE 0
+#define PICO_OK 0
+#define PICO_ERROR_TIMEOUT (-1)
+
+#define count_of(a) (sizeof(a) / sizeof((a)[0]))
+#define __not_in_flash_func(f) f
+#define __unused __attribute__((unused))
+
+uint get_core_num(void);
+void tight_loop_contents(void);
+
+#endif
@@ -0,0 +1,11 @@
+#ifndef SIM_PICO_STDIO_H
+#define SIM_PICO_STDIO_H
+
+#include <stdio.h>
+#include "pico.h"
+
+// A saída vai para o stdout do processo; a entrada vem do roteiro (ação "usb")
+bool stdio_init_all(void);
+int getchar_timeout_us(uint32_t timeout_us);
+
+#endif
@@ -0,0 +1,13 @@
+#ifndef SIM_PICO_STDIO_USB_H
+#define SIM_PICO_STDIO_USB_H
+
+#include "pico.h"
+
+// Driver USB do stdio: só a escrita crua, que ocupa o FIFO do CDC (tusb.h)
+typedef struct stdio_driver {
+  void (*out_chars)(const char *buf, int len);
+} stdio_driver_t;
+
+extern stdio_driver_t stdio_usb;
+
+#endif
@@ -0,0 +1,11 @@
+#ifndef SIM_TUSB_H
+#define SIM_TUSB_H
+
+#include "pico.h"
+
+// Só o que o firmware usa do CDC do TinyUSB: o espaço no FIFO de transmissão
+// segue o host simulado (sim_usb_host), que pode parar de ler
+bool tud_cdc_connected(void);
+uint32_t tud_cdc_write_available(void);
+
+#endif
@@ -0,0 +1,81 @@
+#ifndef SIM_H
+#define SIM_H
+
+// Estado interno da simulação da BitDogLab (não é visto pelo firmware)
+
+#include <stdio.h>
+#include "pico.h"
+
+#define SIM_CORES 2
+#define SIM_FOREVER UINT64_MAX
+
+// Eventos do mundo simulado: os de hardware rodam na hora; os de interrupção
+// são entregues ao núcleo alvo e ficam adiados enquanto ele estiver com as
+// interrupções desligadas
+typedef void (*sim_event_fn_t)(void *arg, int32_t id);
+
+typedef enum {
+  SIM_EV_HW,
+  SIM_EV_IRQ,
+} sim_event_kind_t;
+
+// Relógio e eventos (sim_core.c)
+uint64_t sim_now(void);
+int32_t sim_schedule(uint64_t t, sim_event_kind_t kind, int core, sim_event_fn_t fn, void *arg);
+bool sim_cancel(int32_t id);
+void sim_raise_irq(int core, sim_event_fn_t fn, void *arg);
+void sim_advance(uint64_t us);
+void sim_start(void (*entry)(void));
+void sim_run(uint64_t end_us);
+void sim_stop(void);
+
+// Periféricos (sim_periph.c)
+void sim_periph_init(void);
+void sim_gpio_drive(uint gpio, int level);   // -1 solta o pino (volta ao pull)
+void sim_adc_set(uint input, uint16_t value, uint32_t ramp_us);
+void sim_adc_noise(uint input, uint16_t amplitude);
+void sim_adc_hold(uint input, uint16_t value);   // Como sim_adc_set, sem rampa nem log
+void sim_adc_wav(uint input, const int16_t *samples, size_t count, uint32_t rate, bool loop);
+void sim_i2c_nack_next(void);
+void sim_usb_input(const char *text);
+void sim_usb_host(bool reading);   // false: o host para de ler e o FIFO do CDC enche
+
+// Flash QSPI (sim_flash.c)
+void sim_flash_init(void);
+bool sim_flash_load(const char *path);
+bool sim_flash_save(const char *path);
+void sim_flash_power_cut(void);
+bool sim_flash_power_lost(void);
+
+// Solo do vaso e bomba (sim_soil.c)
+void sim_soil_start(double moisture, double flow, double dry_per_h, double tau_s);
+void sim_soil_tank(bool empty);
+void sim_soil_gpio(uint gpio, bool level);
+void sim_soil_print(FILE *f);
+
+// Saídas capturadas (sim_periph.c)
+void sim_log(const char *kind, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+void sim_set_output(FILE *events, FILE *leds, const char *frames_dir);
+bool sim_oled_write_pbm(const char *path);
+
+typedef struct {
+  uint32_t oled_flushes;
+  uint32_t oled_bytes;
+  uint32_t oled_nacks;
+  uint32_t led_frames;
+  uint32_t gpio_changes;
+  uint32_t pwm_changes;
+  uint64_t adc_conversions;
+  uint32_t alarms;
+  uint32_t irqs;
+  uint32_t switches;
+  uint32_t flash_programs;
+  uint32_t flash_erases;
+} sim_stats_t;
+
+extern sim_stats_t sim_stats;
+
+// Roteiro de entradas (sim_trace.c)
+bool sim_trace_load(const char *path);
+
+#endif
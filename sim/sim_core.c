@@ -0,0 +1,495 @@
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <string.h>
+#include <ucontext.h>
+#include "sim.h"
+#include "pico/time.h"
+#include "pico/multicore.h"
+#include "hardware/sync.h"
+
+// ---------------------------------------------------------------------------
+// Tempo virtual e eventos
+//
+// O relógio só anda quando nenhum dos dois núcleos tem o que fazer: cada um
+// roda até esperar (sleep, WFE, laço de espera), e aí o mundo entrega os
+// eventos vencidos ou salta direto para o próximo. O código em si não gasta
+// tempo virtual, então a simulação corre bem mais rápido que o tempo real.
+// ---------------------------------------------------------------------------
+
+#define SIM_MAX_EVENTS 128
+#define SIM_STACK_SIZE (256 * 1024)
+#define SIM_SPIN_US 10       // Passo de um laço de espera (tight_loop_contents)
+
+typedef struct {
+  bool used;
+  uint64_t t;
+  uint64_t seq;              // Desempate: eventos do mesmo instante em ordem de criação
+  sim_event_kind_t kind;
+  int core;
+  sim_event_fn_t fn;
+  void *arg;
+  int32_t id;
+} sim_event_t;
+
+typedef struct {
+  ucontext_t ctx;
+  void *stack;
+  void (*entry)(void);
+  bool started;
+  bool finished;
+  bool irq_off;              // Interrupções desligadas (PRIMASK)
+  bool event;                // Registrador de eventos do WFE
+  bool wfe;                  // Parado em WFE: acorda com evento ou prazo
+  uint64_t wake_at;
+} sim_core_t;
+
+sim_stats_t sim_stats;
+
+static sim_event_t events[SIM_MAX_EVENTS];
+static uint64_t event_seq;
+static int32_t next_id = 1;
+static uint64_t now_us;
+
+static ucontext_t world;
+static sim_core_t cores[SIM_CORES];
+static int current = -1;     // Núcleo em execução; -1 é o próprio mundo
+static int irq_depth;        // > 0 dentro de uma ISR ou callback de alarme
+static bool stop_requested;
+
+uint64_t sim_now(void) {
+  return now_us;
+}
+
+static int32_t sim_schedule_id(uint64_t t, sim_event_kind_t kind, int core, sim_event_fn_t fn, void *arg, int32_t id) {
+  for (int i = 0; i < SIM_MAX_EVENTS; ++i) {
+    sim_event_t *e = &events[i];
+    if (e->used)
+      continue;
+    *e = (sim_event_t){ true, t < now_us ? now_us : t, event_seq++, kind, core, fn, arg, id };
+    return id;
+  }
+  fprintf(stderr, "sim: fila de eventos cheia\n");
+  abort();
+}
+
+int32_t sim_schedule(uint64_t t, sim_event_kind_t kind, int core, sim_event_fn_t fn, void *arg) {
+  return sim_schedule_id(t, kind, core, fn, arg, next_id++);
+}
+
+bool sim_cancel(int32_t id) {
+  for (int i = 0; i < SIM_MAX_EVENTS; ++i) {
+    if (events[i].used && events[i].id == id) {
+      events[i].used = false;
+      return true;
+    }
+  }
+  return false;
+}
+
+void sim_raise_irq(int core, sim_event_fn_t fn, void *arg) {
+  sim_schedule(now_us, SIM_EV_IRQ, core, fn, arg);
+}
+
+static bool deliverable(const sim_event_t *e) {
+  return e->kind == SIM_EV_HW || !cores[e->core].irq_off;
+}
+
+// Evento vencido mais antigo; core >= 0 restringe às interrupções desse núcleo
+static sim_event_t *next_due(int core) {
+  sim_event_t *best = NULL;
+  for (int i = 0; i < SIM_MAX_EVENTS; ++i) {
+    sim_event_t *e = &events[i];
+    if (!e->used || e->t > now_us || !deliverable(e))
+      continue;
+    if (core >= 0 && (e->kind != SIM_EV_IRQ || e->core != core))
+      continue;
+    if (!best || e->t < best->t || (e->t == best->t && e->seq < best->seq))
+      best = e;
+  }
+  return best;
+}
+
+static void run_event(sim_event_t *slot) {
+  sim_event_t e = *slot;
+  slot->used = false;
+  if (e.kind == SIM_EV_HW) {
+    e.fn(e.arg, e.id);
+    return;
+  }
+  // A ISR roda "no" núcleo alvo: get_core_num e os alarmes criados nela seguem esse núcleo
+  int prev = current;
+  current = e.core;
+  irq_depth++;
+  e.fn(e.arg, e.id);
+  irq_depth--;
+  current = prev;
+  cores[e.core].event = true;
+  sim_stats.irqs++;
+}
+
+// ---------------------------------------------------------------------------
+// Núcleos: corrotinas que devolvem o controle ao mundo sempre que esperam
+// ---------------------------------------------------------------------------
+
+static void sim_yield(uint64_t wake_at, bool wfe) {
+  if (current < 0 || irq_depth)
+    return;   // Numa ISR não há para onde ceder: a espera vira instantânea
+  sim_core_t *c = &cores[current];
+  c->wake_at = wake_at;
+  c->wfe = wfe;
+  swapcontext(&c->ctx, &world);
+}
+
+void sim_advance(uint64_t us) {
+  sim_yield(now_us + us, false);
+}
+
+static void core_trampoline(void) {
+  sim_core_t *c = &cores[current];
+  c->entry();
+  c->finished = true;
+}
+
+static void core_start(int n, void (*entry)(void)) {
+  sim_core_t *c = &cores[n];
+  c->stack = malloc(SIM_STACK_SIZE);
+  c->entry = entry;
+  getcontext(&c->ctx);
+  c->ctx.uc_stack.ss_sp = c->stack;
+  c->ctx.uc_stack.ss_size = SIM_STACK_SIZE;
+  c->ctx.uc_link = &world;
+  makecontext(&c->ctx, core_trampoline, 0);
+  c->started = true;
+  c->wake_at = now_us;
+}
+
+void sim_start(void (*entry)(void)) {
+  core_start(0, entry);
+}
+
+static bool runnable(const sim_core_t *c) {
+  return c->started && !c->finished && (now_us >= c->wake_at || (c->wfe && c->event));
+}
+
+// Encerra sim_run no instante atual (corte de energia)
+void sim_stop(void) {
+  stop_requested = true;
+}
+
+void sim_run(uint64_t end_us) {
+  int rr = 0;
+  while (!stop_requested) {
+    sim_event_t *e;
+    while (!stop_requested && (e = next_due(-1)))
+      run_event(e);
+    if (stop_requested)
+      break;
+
+    // Revezamento entre os núcleos prontos no mesmo instante
+    int ran = -1;
+    for (int k = 0; k < SIM_CORES; ++k) {
+      int n = (rr + k) % SIM_CORES;
+      if (runnable(&cores[n])) {
+        ran = n;
+        break;
+      }
+    }
+    if (ran >= 0) {
+      rr = ran + 1;
+      current = ran;
+      sim_stats.switches++;
+      swapcontext(&world, &cores[ran].ctx);
+      current = -1;
+      continue;
+    }
+
+    // Ninguém pronto: salta para o próximo evento ou prazo
+    uint64_t next = SIM_FOREVER;
+    for (int i = 0; i < SIM_MAX_EVENTS; ++i)
+      if (events[i].used && events[i].t > now_us && events[i].t < next)
+        next = events[i].t;
+    for (int n = 0; n < SIM_CORES; ++n)
+      if (cores[n].started && !cores[n].finished && cores[n].wake_at < next)
+        next = cores[n].wake_at;
+    if (next > end_us) {
+      now_us = end_us;
+      return;
+    }
+    now_us = next;
+  }
+}
+
+// ---------------------------------------------------------------------------
+// pico/time, hardware/timer
+// ---------------------------------------------------------------------------
+
+uint get_core_num(void) {
+  return current > 0 ? (uint)current : 0;
+}
+
+void tight_loop_contents(void) {
+  sim_yield(now_us + SIM_SPIN_US, false);
+}
+
+uint64_t time_us_64(void) {
+  return now_us;
+}
+
+absolute_time_t get_absolute_time(void) {
+  return now_us;
+}
+
+void busy_wait_us(uint64_t us) {
+  sim_yield(now_us + us, false);
+}
+
+void sleep_until(absolute_time_t t) {
+  if (t > now_us)
+    sim_yield(t, false);
+}
+
+void sleep_us(uint64_t us) {
+  sleep_until(now_us + us);
+}
+
+void sleep_ms(uint32_t ms) {
+  sleep_until(now_us + (uint64_t)ms * 1000);
+}
+
+// Prazo já vencido ainda custa um passo de espera: um laço que só consulta o
+// relógio também precisa deixar o tempo virtual andar
+bool best_effort_wfe_or_timeout(absolute_time_t timeout) {
+  if (now_us >= timeout) {
+    tight_loop_contents();
+    return true;
+  }
+  sim_core_t *c = &cores[get_core_num()];
+  if (!c->event) {
+    sim_yield(timeout, true);
+    if (irq_depth)
+      return true;
+  }
+  c->event = false;
+  return now_us >= timeout;
+}
+
+void __wfe(void) {
+  sim_core_t *c = &cores[get_core_num()];
+  if (!c->event)
+    sim_yield(SIM_FOREVER, true);
+  c->event = false;
+}
+
+void __wfi(void) {
+  __wfe();
+}
+
+void __sev(void) {
+  for (int n = 0; n < SIM_CORES; ++n)
+    cores[n].event = true;
+}
+
+// Retorna 1 se as interrupções já estavam desligadas
+uint32_t save_and_disable_interrupts(void) {
+  sim_core_t *c = &cores[get_core_num()];
+  uint32_t was_off = c->irq_off;
+  c->irq_off = true;
+  return was_off;
+}
+
+// Religar entrega na hora as interrupções que ficaram pendentes, como no NVIC
+void restore_interrupts(uint32_t status) {
+  uint n = get_core_num();
+  cores[n].irq_off = status != 0;
+  if (cores[n].irq_off || irq_depth || current < 0)
+    return;
+  sim_event_t *e;
+  while ((e = next_due(n)))
+    run_event(e);
+}
+
+// ---------------------------------------------------------------------------
+// Alarmes e timers repetitivos
+// ---------------------------------------------------------------------------
+
+#define SIM_MAX_ALARMS 32
+
+struct alarm_pool {
+  int core;                  // Núcleo onde os callbacks rodam
+};
+
+typedef struct {
+  bool used;
+  int32_t id;
+  uint64_t t;
+  alarm_pool_t *pool;
+  alarm_callback_t cb;
+  void *user_data;
+} sim_alarm_t;
+
+static alarm_pool_t default_pool = { 0 };
+static alarm_pool_t extra_pools[3];
+static uint extra_pool_count;
+static sim_alarm_t alarms[SIM_MAX_ALARMS];
+
+// < 0: reagenda a partir do horário previsto; > 0: a partir do retorno do callback
+static void alarm_fire(void *arg, int32_t id) {
+  sim_alarm_t *a = arg;
+  sim_stats.alarms++;
+  int64_t r = a->cb(id, a->user_data);
+  if (!a->used || a->id != id)
+    return;   // Cancelado dentro do próprio callback
+  if (r == 0) {
+    a->used = false;
+    return;
+  }
+  a->t = r < 0 ? a->t - r : now_us + r;
+  sim_schedule_id(a->t, SIM_EV_IRQ, a->pool->core, alarm_fire, a, id);
+}
+
+alarm_pool_t *alarm_pool_get_default(void) {
+  return &default_pool;
+}
+
+alarm_pool_t *alarm_pool_create_with_unused_hardware_alarm(uint max_timers) {
+  (void)max_timers;
+  if (extra_pool_count >= count_of(extra_pools))
+    return NULL;
+  alarm_pool_t *pool = &extra_pools[extra_pool_count++];
+  pool->core = get_core_num();
+  return pool;
+}
+
+alarm_id_t alarm_pool_add_alarm_at(alarm_pool_t *pool, absolute_time_t time, alarm_callback_t callback, void *user_data, bool fire_if_past) {
+  if (time <= now_us && !fire_if_past)
+    return 0;
+  for (int i = 0; i < SIM_MAX_ALARMS; ++i) {
+    sim_alarm_t *a = &alarms[i];
+    if (a->used)
+      continue;
+    a->used = true;
+    a->t = time;
+    a->pool = pool;
+    a->cb = callback;
+    a->user_data = user_data;
+    a->id = sim_schedule(time, SIM_EV_IRQ, pool->core, alarm_fire, a);
+    return a->id;
+  }
+  return -1;
+}
+
+alarm_id_t alarm_pool_add_alarm_in_us(alarm_pool_t *pool, uint64_t us, alarm_callback_t callback, void *user_data, bool fire_if_past) {
+  return alarm_pool_add_alarm_at(pool, now_us + us, callback, user_data, fire_if_past);
+}
+
+alarm_id_t add_alarm_at(absolute_time_t time, alarm_callback_t callback, void *user_data, bool fire_if_past) {
+  return alarm_pool_add_alarm_at(&default_pool, time, callback, user_data, fire_if_past);
+}
+
+alarm_id_t add_alarm_in_us(uint64_t us, alarm_callback_t callback, void *user_data, bool fire_if_past) {
+  return add_alarm_at(now_us + us, callback, user_data, fire_if_past);
+}
+
+alarm_id_t add_alarm_in_ms(uint32_t ms, alarm_callback_t callback, void *user_data, bool fire_if_past) {
+  return add_alarm_at(now_us + (uint64_t)ms * 1000, callback, user_data, fire_if_past);
+}
+
+bool cancel_alarm(alarm_id_t alarm_id) {
+  for (int i = 0; i < SIM_MAX_ALARMS; ++i) {
+    if (alarms[i].used && alarms[i].id == alarm_id) {
+      alarms[i].used = false;
+      return sim_cancel(alarm_id);
+    }
+  }
+  return false;
+}
+
+static int64_t repeating_timer_cb(alarm_id_t id, void *user_data) {
+  repeating_timer_t *rt = user_data;
+  return rt->callback(rt) ? rt->delay_us : 0;
+}
+
+bool add_repeating_timer_us(int64_t delay_us, repeating_timer_callback_t callback, void *user_data, repeating_timer_t *out) {
+  out->delay_us = delay_us;
+  out->pool = &default_pool;
+  out->callback = callback;
+  out->user_data = user_data;
+  out->alarm_id = add_alarm_in_us(delay_us < 0 ? -delay_us : delay_us, repeating_timer_cb, out, true);
+  return out->alarm_id > 0;
+}
+
+bool add_repeating_timer_ms(int32_t delay_ms, repeating_timer_callback_t callback, void *user_data, repeating_timer_t *out) {
+  return add_repeating_timer_us((int64_t)delay_ms * 1000, callback, user_data, out);
+}
+
+bool cancel_repeating_timer(repeating_timer_t *timer) {
+  bool ok = timer->alarm_id > 0 && cancel_alarm(timer->alarm_id);
+  timer->alarm_id = 0;
+  return ok;
+}
+
+// ---------------------------------------------------------------------------
+// pico/multicore: FIFOs do SIO, uma por sentido
+// ---------------------------------------------------------------------------
+
+#define SIM_FIFO_DEPTH 8
+
+static struct {
+  uint32_t data[SIM_FIFO_DEPTH];
+  uint8_t head, count;
+} fifo[SIM_CORES];           // fifo[n] é a de entrada do núcleo n
+
+void multicore_launch_core1(void (*entry)(void)) {
+  core_start(1, entry);
+}
+
+bool multicore_fifo_rvalid(void) {
+  return fifo[get_core_num()].count > 0;
+}
+
+bool multicore_fifo_wready(void) {
+  return fifo[get_core_num() ^ 1].count < SIM_FIFO_DEPTH;
+}
+
+bool multicore_fifo_push_timeout_us(uint32_t data, uint64_t timeout_us) {
+  uint64_t deadline = now_us + timeout_us;
+  while (!multicore_fifo_wready()) {
+    if (now_us >= deadline || irq_depth)
+      return false;
+    tight_loop_contents();
+  }
+  uint n = get_core_num() ^ 1;
+  fifo[n].data[(fifo[n].head + fifo[n].count) % SIM_FIFO_DEPTH] = data;
+  fifo[n].count++;
+  __sev();
+  return true;
+}
+
+void multicore_fifo_push_blocking(uint32_t data) {
+  multicore_fifo_push_timeout_us(data, SIM_FOREVER / 2);
+}
+
+bool multicore_fifo_pop_timeout_us(uint64_t timeout_us, uint32_t *out) {
+  uint64_t deadline = now_us + timeout_us;
+  uint n = get_core_num();
+  while (!fifo[n].count) {
+    if (now_us >= deadline || irq_depth)
+      return false;
+    best_effort_wfe_or_timeout(deadline);
+  }
+  *out = fifo[n].data[fifo[n].head];
+  fifo[n].head = (fifo[n].head + 1) % SIM_FIFO_DEPTH;
+  fifo[n].count--;
+  __sev();
+  return true;
+}
+
+uint32_t multicore_fifo_pop_blocking(void) {
+  uint32_t data = 0;
+  multicore_fifo_pop_timeout_us(SIM_FOREVER / 2, &data);
+  return data;
+}
+
+void multicore_fifo_drain(void) {
+  fifo[get_core_num()].count = 0;
+}
@@ -0,0 +1,119 @@
+#include <stdlib.h>
+#include <string.h>
+#include "sim.h"
+#include "hardware/flash.h"
+#include "hardware/sync.h"
+#include "pico/flash.h"
+
+// ---------------------------------------------------------------------------
+// Flash QSPI: imagem em RAM com a semântica da NOR (apagar deixa 0xFF,
+// programar só derruba bits) e a duração das operações em tempo virtual.
+// Um corte de energia no meio de uma operação deixa só a parte já feita,
+// como uma página programada pela metade ou um setor meio apagado.
+// ---------------------------------------------------------------------------
+
+#define SIM_FLASH_PROGRAM_US 800     // Página de 256 bytes (típico da W25Q16)
+#define SIM_FLASH_ERASE_US   45000   // Setor de 4 KB
+
+uint8_t sim_flash_image[PICO_FLASH_SIZE_BYTES];
+
+static struct {
+  bool active;
+  bool erase;
+  uint32_t offs;
+  const uint8_t *data;
+  size_t count;
+  uint64_t start_us;
+  uint32_t duration_us;
+} op;
+
+static bool power_lost;
+
+void sim_flash_init(void) {
+  memset(sim_flash_image, 0xFF, sizeof(sim_flash_image));
+}
+
+// Aplica a fração já concluída da operação em curso
+static void op_apply(size_t done) {
+  if (op.erase) {
+    memset(&sim_flash_image[op.offs], 0xFF, done);
+  } else {
+    for (size_t i = 0; i < done; ++i)
+      sim_flash_image[op.offs + i] &= op.data[i];
+  }
+}
+
+static void op_run(bool erase, uint32_t offs, const uint8_t *data, size_t count, uint32_t duration_us) {
+  uint32_t align = erase ? FLASH_SECTOR_SIZE : FLASH_PAGE_SIZE;
+  if (offs % align || count % align || offs + count > PICO_FLASH_SIZE_BYTES) {
+    fprintf(stderr, "sim: flash_range_%s fora do alinhamento (0x%x, %zu)\n", erase ? "erase" : "program", offs, count);
+    abort();
+  }
+  op = (typeof(op)){ true, erase, offs, data, count, sim_now(), duration_us };
+  sim_log("flash", "%s,0x%x,%zu", erase ? "apaga" : "programa", offs, count);
+  sim_advance(duration_us);
+  if (power_lost)
+    return;   // O núcleo não volta a rodar depois do corte
+  op_apply(count);
+  op.active = false;
+  if (erase)
+    sim_stats.flash_erases++;
+  else
+    sim_stats.flash_programs++;
+}
+
+void flash_range_erase(uint32_t flash_offs, size_t count) {
+  op_run(true, flash_offs, NULL, count, (count / FLASH_SECTOR_SIZE) * SIM_FLASH_ERASE_US);
+}
+
+void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count) {
+  op_run(false, flash_offs, data, count, (count / FLASH_PAGE_SIZE) * SIM_FLASH_PROGRAM_US);
+}
+
+int flash_safe_execute(void (*func)(void *), void *param, uint32_t enter_exit_timeout_ms) {
+  uint32_t irq_state = save_and_disable_interrupts();
+  func(param);
+  restore_interrupts(irq_state);
+  return PICO_OK;
+}
+
+bool flash_safe_execute_core_init(void) {
+  return true;
+}
+
+// Corte de energia (ação "corte" do roteiro): a operação em curso fica pela
+// metade e a simulação para ali
+void sim_flash_power_cut(void) {
+  if (op.active) {
+    size_t done = (size_t)((double)op.count * (double)(sim_now() - op.start_us) / op.duration_us);
+    op_apply(done > op.count ? op.count : done);
+    sim_log("flash", "corte,%zu de %zu bytes", done, op.count);
+  }
+  sim_log("energia", "corte");
+  power_lost = true;
+  sim_stop();
+}
+
+bool sim_flash_power_lost(void) {
+  return power_lost;
+}
+
+bool sim_flash_load(const char *path) {
+  FILE *f = fopen(path, "rb");
+  if (!f)
+    return false;   // Ainda não existe: flash apagada
+  size_t n = fread(sim_flash_image, 1, sizeof(sim_flash_image), f);
+  fclose(f);
+  return n == sizeof(sim_flash_image);
+}
+
+bool sim_flash_save(const char *path) {
+  FILE *f = fopen(path, "wb");
+  if (!f) {
+    fprintf(stderr, "sim: nao criou %s\n", path);
+    return false;
+  }
+  bool ok = fwrite(sim_flash_image, 1, sizeof(sim_flash_image), f) == sizeof(sim_flash_image);
+  fclose(f);
+  return ok;
+}
@@ -0,0 +1,104 @@
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "sim.h"
+
+// main() do firmware, renomeada na compilação da simulação
+int firmware_main();
+
+static void core0_entry(void) {
+  firmware_main();
+}
+
+static void usage(const char *prog) {
+  fprintf(stderr,
+          "uso: %s [-t roteiro] [-d segundos] [-o pasta] [-f] [-F flash.bin]\n"
+          "  -t  roteiro de entradas (sensores, botões), ver sim/roteiros/\n"
+          "  -d  duração em segundos de tempo virtual (padrão 30)\n"
+          "  -o  pasta das saídas: eventos.csv, ws2812.txt, oled.pbm (padrão .)\n"
+          "  -f  grava também um PBM do OLED a cada envio (pasta quadros/)\n"
+          "  -F  imagem da flash: lida na partida (se existir) e gravada no fim,\n"
+          "      para o histórico sobreviver entre execuções e cortes de energia\n",
+          prog);
+}
+
+static FILE *open_out(const char *dir, const char *name) {
+  char path[512];
+  snprintf(path, sizeof(path), "%s/%s", dir, name);
+  FILE *f = fopen(path, "w");
+  if (!f)
+    fprintf(stderr, "sim: nao criou %s\n", path);
+  return f;
+}
+
+int main(int argc, char **argv) {
+  const char *trace = NULL;
+  const char *out_dir = ".";
+  const char *flash_path = NULL;
+  double seconds = 30;
+  bool frames = false;
+  int opt;
+  while ((opt = getopt(argc, argv, "t:d:o:fF:h")) != -1) {
+    switch (opt) {
+      case 't': trace = optarg; break;
+      case 'd': seconds = atof(optarg); break;
+      case 'o': out_dir = optarg; break;
+      case 'f': frames = true; break;
+      case 'F': flash_path = optarg; break;
+      default: usage(argv[0]); return opt == 'h' ? 0 : 2;
+    }
+  }
+
+  mkdir(out_dir, 0755);
+  char frames_dir[512];
+  snprintf(frames_dir, sizeof(frames_dir), "%s/quadros", out_dir);
+  if (frames)
+    mkdir(frames_dir, 0755);
+
+  FILE *events = open_out(out_dir, "eventos.csv");
+  FILE *leds = open_out(out_dir, "ws2812.txt");
+  if (!events || !leds)
+    return 1;
+  fprintf(events, "t_us,tipo,dados\n");
+  sim_set_output(events, leds, frames ? frames_dir : NULL);
+
+  sim_periph_init();
+  if (flash_path)
+    sim_flash_load(flash_path);
+  if (trace && !sim_trace_load(trace))
+    return 1;
+
+  struct timespec t0, t1;
+  clock_gettime(CLOCK_MONOTONIC, &t0);
+  sim_start(core0_entry);
+  sim_run((uint64_t)(seconds * 1e6));
+  clock_gettime(CLOCK_MONOTONIC, &t1);
+
+  char path[512];
+  snprintf(path, sizeof(path), "%s/oled.pbm", out_dir);
+  sim_oled_write_pbm(path);
+  if (flash_path)
+    sim_flash_save(flash_path);
+  fclose(events);
+  fclose(leds);
+
+  double wall = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) * 1e-9;
+  seconds = sim_now() * 1e-6;
+  if (sim_flash_power_lost())
+    fprintf(stderr, "\nsim: corte de energia em %.3f s\n", seconds);
+  fprintf(stderr,
+          "\nsim: %.1f s virtuais em %.3f s (%.0fx)\n"
+          "sim: oled %u envios, %u bytes, %u NACKs | matriz %u quadros\n"
+          "sim: gpio %u mudancas, pwm %u | adc %llu conversoes | %u alarmes, %u irqs, %u trocas de nucleo\n"
+          "sim: flash %u paginas programadas, %u setores apagados\n",
+          seconds, wall, wall > 0 ? seconds / wall : 0.0,
+          sim_stats.oled_flushes, sim_stats.oled_bytes, sim_stats.oled_nacks, sim_stats.led_frames,
+          sim_stats.gpio_changes, sim_stats.pwm_changes, (unsigned long long)sim_stats.adc_conversions,
+          sim_stats.alarms, sim_stats.irqs, sim_stats.switches, sim_stats.flash_programs, sim_stats.flash_erases);
+  sim_soil_print(stderr);
+  // Os núcleos simulados continuam "rodando": encerra sem desmontar as corrotinas
+  fflush(stdout);
+  _exit(0);
+}
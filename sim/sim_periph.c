@@ -0,0 +1,1038 @@
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim.h"
+#include "pico/stdlib.h"
+#include "pico/stdio_usb.h"
+#include "hardware/adc.h"
+#include "hardware/dma.h"
+#include "hardware/i2c.h"
+#include "hardware/irq.h"
+#include "hardware/pio.h"
+#include "hardware/pwm.h"
+
+// ---------------------------------------------------------------------------
+// Saídas capturadas: eventos em CSV, quadros da matriz e imagens do OLED
+// ---------------------------------------------------------------------------
+
+static FILE *events_out;
+static FILE *leds_out;
+static const char *frames_dir;
+
+void sim_set_output(FILE *events, FILE *leds, const char *dir) {
+  events_out = events;
+  leds_out = leds;
+  frames_dir = dir;
+}
+
+void sim_log(const char *kind, const char *fmt, ...) {
+  if (!events_out)
+    return;
+  fprintf(events_out, "%llu,%s,", (unsigned long long)sim_now(), kind);
+  va_list ap;
+  va_start(ap, fmt);
+  vfprintf(events_out, fmt, ap);
+  va_end(ap);
+  fputc('\n', events_out);
+}
+
+// ---------------------------------------------------------------------------
+// Clocks e stdio
+// ---------------------------------------------------------------------------
+
+static uint32_t sys_hz = 125000000;
+
+uint32_t clock_get_hz(enum clock_index clk_index) {
+  switch (clk_index) {
+    case clk_ref: return 12000000;
+    case clk_usb:
+    case clk_adc: return 48000000;
+    case clk_rtc: return 46875;
+    default: return sys_hz;
+  }
+}
+
+// O clk_peri acompanha o clk_sys, como no SDK: o I2C fica no divisor antigo
+// até o firmware chamar i2c_set_baudrate
+bool set_sys_clock_khz(uint32_t freq_khz, bool required) {
+  if (sys_hz != freq_khz * 1000)
+    sim_log("clock", "%lu", (unsigned long)freq_khz);
+  sys_hz = freq_khz * 1000;
+  return true;
+}
+
+void set_sys_clock_48mhz(void) {
+  set_sys_clock_khz(48000, true);
+}
+
+bool stdio_init_all(void) {
+  setvbuf(stdout, NULL, _IOLBF, 0);
+  return true;
+}
+
+// Bytes "digitados" no USB pelo roteiro, lidos por getchar_timeout_us
+static char usb_rx[256];
+static uint32_t usb_rx_head, usb_rx_tail;
+
+void sim_usb_input(const char *text) {
+  for (; *text && usb_rx_head - usb_rx_tail < sizeof(usb_rx); ++text)
+    usb_rx[usb_rx_head++ % sizeof(usb_rx)] = *text;
+}
+
+int getchar_timeout_us(uint32_t timeout_us) {
+  if (usb_rx_head == usb_rx_tail && timeout_us)
+    sim_advance(timeout_us);
+  if (usb_rx_head == usb_rx_tail)
+    return PICO_ERROR_TIMEOUT;
+  return (uint8_t)usb_rx[usb_rx_tail++ % sizeof(usb_rx)];
+}
+
+// Host do outro lado do USB: o FIFO de transmissão do CDC (256 bytes, como no
+// SDK) esvazia 64 bytes por quadro de 1 ms enquanto o host lê. Só os bytes de
+// stdio_usb.out_chars ocupam o FIFO; o texto do printf vai direto para o stdout
+#define CDC_TX_FIFO 256
+
+static struct {
+  bool stopped;
+  uint32_t level;
+  uint64_t t_us;             // Último quadro de 1 ms já descontado
+} usb_host;
+
+static void cdc_sync(void) {
+  uint64_t now = sim_now();
+  uint64_t frames = (now - usb_host.t_us) / 1000;
+  usb_host.t_us += frames * 1000;
+  if (usb_host.stopped)
+    return;
+  uint64_t drained = frames * 64;
+  usb_host.level = drained >= usb_host.level ? 0 : usb_host.level - (uint32_t)drained;
+}
+
+void sim_usb_host(bool reading) {
+  cdc_sync();
+  usb_host.stopped = !reading;
+  sim_log("usb_host", "%s", reading ? "lendo" : "parado");
+}
+
+bool tud_cdc_connected(void) {
+  return true;
+}
+
+uint32_t tud_cdc_write_available(void) {
+  cdc_sync();
+  return CDC_TX_FIFO - usb_host.level;
+}
+
+// Um tud_cdc_write seguido do flush, como no driver do SDK; quem chama já
+// limitou o tamanho ao espaço livre
+static void stdio_usb_out_chars(const char *buf, int len) {
+  cdc_sync();
+  uint32_t n = (uint32_t)len;
+  usb_host.level = n >= CDC_TX_FIFO - usb_host.level ? CDC_TX_FIFO : usb_host.level + n;
+  fwrite(buf, 1, (size_t)len, stdout);
+}
+
+stdio_driver_t stdio_usb = { .out_chars = stdio_usb_out_chars };
+
+// ---------------------------------------------------------------------------
+// GPIO: saídas registradas, entradas vindas do roteiro (ou do pull)
+// ---------------------------------------------------------------------------
+
+static struct {
+  bool out;
+  bool level;                // Nível escrito com gpio_put
+  int8_t ext;                // Nível imposto pelo roteiro (-1: solto)
+  int8_t pull;               // 1 pull-up, -1 pull-down, 0 sem pull
+  uint8_t func;
+  uint32_t irq_mask;
+} pins[NUM_BANK0_GPIOS];
+
+static gpio_irq_callback_t gpio_callback;
+static int gpio_irq_core;
+
+static bool pin_level(uint gpio) {
+  if (pins[gpio].out)
+    return pins[gpio].level;
+  if (pins[gpio].ext >= 0)
+    return pins[gpio].ext;
+  return pins[gpio].pull > 0;
+}
+
+void gpio_init(uint gpio) {
+  pins[gpio].out = false;
+  pins[gpio].level = false;
+  pins[gpio].func = GPIO_FUNC_SIO;
+}
+
+void gpio_set_dir(uint gpio, bool out) {
+  pins[gpio].out = out;
+}
+
+void gpio_put(uint gpio, bool value) {
+  if (pins[gpio].level == value)
+    return;
+  pins[gpio].level = value;
+  if (pins[gpio].out) {
+    sim_stats.gpio_changes++;
+    sim_log("gpio", "%u,%d", gpio, value);
+    sim_soil_gpio(gpio, value);
+  }
+}
+
+bool gpio_get(uint gpio) {
+  return pin_level(gpio);
+}
+
+void gpio_pull_up(uint gpio) { pins[gpio].pull = 1; }
+void gpio_pull_down(uint gpio) { pins[gpio].pull = -1; }
+void gpio_disable_pulls(uint gpio) { pins[gpio].pull = 0; }
+
+void gpio_set_irq_enabled(uint gpio, uint32_t event_mask, bool enabled) {
+  if (enabled)
+    pins[gpio].irq_mask |= event_mask;
+  else
+    pins[gpio].irq_mask &= ~event_mask;
+}
+
+// O callback é por núcleo no SDK: as bordas vão para quem o registrou
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t event_mask, bool enabled, gpio_irq_callback_t callback) {
+  gpio_set_irq_enabled(gpio, event_mask, enabled);
+  gpio_callback = callback;
+  gpio_irq_core = get_core_num();
+}
+
+static void gpio_irq_fire(void *arg, int32_t id) {
+  uintptr_t packed = (uintptr_t)arg;
+  if (gpio_callback)
+    gpio_callback(packed >> 8, packed & 0xFF);
+}
+
+void sim_gpio_drive(uint gpio, int level) {
+  if (gpio >= NUM_BANK0_GPIOS)
+    return;
+  bool before = pin_level(gpio);
+  pins[gpio].ext = level;
+  bool after = pin_level(gpio);
+  sim_log("input", "%u,%d", gpio, after);
+  if (before == after)
+    return;
+  uint32_t edge = after ? GPIO_IRQ_EDGE_RISE : GPIO_IRQ_EDGE_FALL;
+  if (pins[gpio].irq_mask & edge)
+    sim_raise_irq(gpio_irq_core, gpio_irq_fire, (void *)(uintptr_t)((gpio << 8) | edge));
+}
+
+// ---------------------------------------------------------------------------
+// IRQs: handlers por número, entregues ao núcleo que habilitou a linha
+// ---------------------------------------------------------------------------
+
+#define SIM_MAX_SHARED 4
+
+static struct {
+  bool enabled;
+  int core;
+  irq_handler_t handlers[SIM_MAX_SHARED];
+} irqs[NUM_IRQS];
+
+void irq_set_enabled(uint num, bool enabled) {
+  irqs[num].enabled = enabled;
+  irqs[num].core = get_core_num();
+}
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler) {
+  memset(irqs[num].handlers, 0, sizeof(irqs[num].handlers));
+  irqs[num].handlers[0] = handler;
+}
+
+void irq_add_shared_handler(uint num, irq_handler_t handler, uint8_t order_priority) {
+  for (int i = 0; i < SIM_MAX_SHARED; ++i) {
+    if (!irqs[num].handlers[i]) {
+      irqs[num].handlers[i] = handler;
+      return;
+    }
+  }
+}
+
+void irq_remove_handler(uint num, irq_handler_t handler) {
+  for (int i = 0; i < SIM_MAX_SHARED; ++i)
+    if (irqs[num].handlers[i] == handler)
+      irqs[num].handlers[i] = NULL;
+}
+
+static void irq_dispatch(void *arg, int32_t id) {
+  uint num = (uint)(uintptr_t)arg;
+  for (int i = 0; i < SIM_MAX_SHARED; ++i)
+    if (irqs[num].handlers[i])
+      irqs[num].handlers[i]();
+}
+
+static void irq_raise(uint num) {
+  if (irqs[num].enabled)
+    sim_raise_irq(irqs[num].core, irq_dispatch, (void *)(uintptr_t)num);
+}
+
+// ---------------------------------------------------------------------------
+// ADC: conversões em round-robin no ritmo do clk_adc, calculadas sob demanda
+// ---------------------------------------------------------------------------
+
+#define ADC_INPUTS 5
+#define ADC_FIFO_DEPTH 4
+
+adc_hw_t sim_adc_hw;
+
+static struct {
+  uint16_t v0, v1;           // Rampa linear de v0 (em t0) até v1 (em t1)
+  uint64_t t0, t1;
+  uint16_t noise;
+  const int16_t *wav;        // Sinal gravado no lugar da rampa, a partir de t0
+  size_t wav_count;
+  uint32_t wav_rate;
+  bool wav_loop;
+} adc_in[ADC_INPUTS];
+
+static struct {
+  bool running;
+  uint8_t rr_mask;
+  uint8_t input;
+  float clkdiv;
+  bool fifo_en;
+  bool dreq_en;
+  double next_us;            // Instante da próxima conversão
+  uint16_t fifo[ADC_FIFO_DEPTH];
+  uint8_t fifo_level;
+  int dma_channel;           // Canal com DREQ_ADC, ou -1
+} adc;
+
+static uint32_t noise_state = 0x2545F491u;
+
+static uint16_t adc_value_at(uint input, uint64_t t) {
+  int32_t v = adc_in[input].v1;
+  if (adc_in[input].wav && t >= adc_in[input].t0) {
+    // Amostra vigente no instante da conversão (retenção de ordem zero); os
+    // 16 bits com sinal viram 12 bits em torno do meio da escala
+    uint64_t i = (t - adc_in[input].t0) * adc_in[input].wav_rate / 1000000;
+    if (adc_in[input].wav_loop)
+      i %= adc_in[input].wav_count;
+    if (i < adc_in[input].wav_count)
+      v = 2048 + adc_in[input].wav[i] / 16;
+  } else if (t < adc_in[input].t1 && adc_in[input].t1 > adc_in[input].t0) {
+    double k = (double)(t - adc_in[input].t0) / (double)(adc_in[input].t1 - adc_in[input].t0);
+    v = adc_in[input].v0 + (int32_t)((adc_in[input].v1 - adc_in[input].v0) * k);
+  }
+  if (adc_in[input].noise) {
+    noise_state ^= noise_state << 13;
+    noise_state ^= noise_state >> 17;
+    noise_state ^= noise_state << 5;
+    v += (int32_t)(noise_state % (2u * adc_in[input].noise + 1)) - adc_in[input].noise;
+  }
+  return v < 0 ? 0 : v > 4095 ? 4095 : (uint16_t)v;
+}
+
+static double adc_period_us(void) {
+  double cycles = 1.0 + adc.clkdiv;
+  if (cycles < 96)
+    cycles = 96;
+  return cycles * 1e6 / clock_get_hz(clk_adc);
+}
+
+static void adc_next_input(void) {
+  if (!adc.rr_mask)
+    return;
+  do
+    adc.input = (adc.input + 1) % ADC_INPUTS;
+  while (!(adc.rr_mask & (1u << adc.input)));
+}
+
+static bool dma_adc_push(uint16_t sample);
+
+// Realiza as conversões que já deveriam ter acontecido até agora
+static void adc_sync(void) {
+  if (!adc.running)
+    return;
+  double period = adc_period_us();
+  uint64_t now = sim_now();
+  while (adc.next_us <= (double)now) {
+    uint16_t sample = adc_value_at(adc.input, (uint64_t)adc.next_us);
+    sim_stats.adc_conversions++;
+    if (!(adc.dreq_en && dma_adc_push(sample)) && adc.fifo_en && adc.fifo_level < ADC_FIFO_DEPTH)
+      adc.fifo[adc.fifo_level++] = sample;
+    adc_next_input();
+    adc.next_us += period;
+    // Sem ninguém consumindo, a FIFO enche e o resto se perde: pula direto para agora
+    if (adc.fifo_level == ADC_FIFO_DEPTH && (adc.dma_channel < 0 || !adc.dreq_en))
+      adc.next_us = (double)now + period;
+  }
+}
+
+void sim_adc_set(uint input, uint16_t value, uint32_t ramp_us) {
+  if (input >= ADC_INPUTS)
+    return;
+  adc_sync();   // As conversões anteriores usam a rampa antiga
+  uint64_t now = sim_now();
+  adc_in[input].v0 = adc_value_at(input, now);
+  adc_in[input].v1 = value > 4095 ? 4095 : value;
+  adc_in[input].wav = NULL;
+  adc_in[input].t0 = now;
+  adc_in[input].t1 = now + ramp_us;
+  sim_log("adc", "%u,%u,%u", input, value, ramp_us);
+}
+
+void sim_adc_hold(uint input, uint16_t value) {
+  if (input >= ADC_INPUTS)
+    return;
+  adc_sync();
+  adc_in[input].v0 = adc_in[input].v1 = value > 4095 ? 4095 : value;
+  adc_in[input].wav = NULL;
+  adc_in[input].t0 = adc_in[input].t1 = sim_now();
+}
+
+// Toca um WAV na entrada a partir de agora; no fim (sem repetir) a entrada
+// fica no nível que tinha antes
+void sim_adc_wav(uint input, const int16_t *samples, size_t count, uint32_t rate, bool loop) {
+  if (input >= ADC_INPUTS || !count || !rate)
+    return;
+  adc_sync();
+  adc_in[input].v0 = adc_in[input].v1 = adc_value_at(input, sim_now());
+  adc_in[input].wav = samples;
+  adc_in[input].wav_count = count;
+  adc_in[input].wav_rate = rate;
+  adc_in[input].wav_loop = loop;
+  adc_in[input].t0 = adc_in[input].t1 = sim_now();
+  sim_log("wav", "%u,%zu,%u,%d", input, count, rate, loop);
+}
+
+void sim_adc_noise(uint input, uint16_t amplitude) {
+  if (input >= ADC_INPUTS)
+    return;
+  adc_sync();
+  adc_in[input].noise = amplitude;
+}
+
+void adc_init(void) {
+  adc.running = false;
+  adc.rr_mask = 0;
+  adc.input = 0;
+  adc.fifo_level = 0;
+}
+
+void adc_gpio_init(uint gpio) {
+  gpio_set_function(gpio, GPIO_FUNC_NULL);
+  gpio_disable_pulls(gpio);
+}
+
+void adc_select_input(uint input) {
+  adc_sync();
+  adc.input = input % ADC_INPUTS;
+}
+
+uint adc_get_selected_input(void) {
+  adc_sync();
+  return adc.input;
+}
+
+void adc_set_round_robin(uint input_mask) {
+  adc_sync();
+  adc.rr_mask = input_mask & ((1u << ADC_INPUTS) - 1);
+}
+
+void adc_set_temp_sensor_enabled(bool enable) {}
+
+uint16_t adc_read(void) {
+  uint16_t v = adc_value_at(adc.input, sim_now());
+  sim_stats.adc_conversions++;
+  sim_advance(2);
+  return v;
+}
+
+void adc_run(bool run) {
+  adc_sync();
+  if (run && !adc.running)
+    adc.next_us = (double)sim_now() + adc_period_us();
+  adc.running = run;
+}
+
+void adc_set_clkdiv(float clkdiv) {
+  adc_sync();
+  adc.clkdiv = clkdiv;
+}
+
+void adc_fifo_setup(bool en, bool dreq_en, uint16_t dreq_thresh, bool err_in_fifo, bool byte_shift) {
+  adc_sync();
+  adc.fifo_en = en;
+  adc.dreq_en = dreq_en;
+}
+
+bool adc_fifo_is_empty(void) {
+  adc_sync();
+  return adc.fifo_level == 0;
+}
+
+uint8_t adc_fifo_get_level(void) {
+  adc_sync();
+  return adc.fifo_level;
+}
+
+uint16_t adc_fifo_get(void) {
+  adc_sync();
+  if (!adc.fifo_level)
+    return 0;
+  uint16_t v = adc.fifo[0];
+  memmove(adc.fifo, adc.fifo + 1, --adc.fifo_level * sizeof(uint16_t));
+  return v;
+}
+
+uint16_t adc_fifo_get_blocking(void) {
+  while (adc_fifo_is_empty())
+    tight_loop_contents();
+  return adc_fifo_get();
+}
+
+void adc_fifo_drain(void) {
+  adc_sync();
+  adc.fifo_level = 0;
+}
+
+// ---------------------------------------------------------------------------
+// SSD1306: decodifica as transações I2C na RAM de vídeo do controlador
+// ---------------------------------------------------------------------------
+
+#define OLED_ADDR 0x3C
+
+static struct {
+  uint8_t ram[8][128];
+  uint8_t mode;              // 0 horizontal, 1 vertical, 2 página
+  uint8_t col_start, col_end, page_start, page_end;
+  uint8_t col, page;
+  bool on, invert;
+  uint8_t cmd, nargs, needed, args[6];
+  enum { TX_CTRL, TX_ONE, TX_STREAM } tx;
+  bool tx_data;
+} oled = { .col_end = 127, .page_end = 7, .mode = 2 };
+
+// Bytes de argumento de cada comando (os demais não têm)
+static uint8_t oled_arg_count(uint8_t cmd) {
+  switch (cmd) {
+    case 0x20: case 0x81: case 0x8D: case 0xA8: case 0xD3:
+    case 0xD5: case 0xD9: case 0xDA: case 0xDB:
+      return 1;
+    case 0x21: case 0x22: case 0xA3:
+      return 2;
+    case 0x29: case 0x2A:
+      return 5;
+    case 0x26: case 0x27:
+      return 6;
+    default:
+      return 0;
+  }
+}
+
+static void oled_apply(void) {
+  uint8_t c = oled.cmd;
+  if (c == 0x20) {
+    oled.mode = oled.args[0] & 3;
+  } else if (c == 0x21) {
+    oled.col_start = oled.col = oled.args[0] & 0x7F;
+    oled.col_end = oled.args[1] & 0x7F;
+  } else if (c == 0x22) {
+    oled.page_start = oled.page = oled.args[0] & 7;
+    oled.page_end = oled.args[1] & 7;
+  } else if (c == 0xAE || c == 0xAF) {
+    if (oled.on != (c & 1))
+      sim_log("display", "%s", c & 1 ? "ligado" : "desligado");
+    oled.on = c & 1;
+  } else if (c == 0xA6 || c == 0xA7) {
+    oled.invert = c & 1;
+  } else if (c >= 0xB0 && c <= 0xB7) {
+    oled.page = c & 7;
+  } else if (c <= 0x0F) {
+    oled.col = (oled.col & 0xF0) | c;
+  } else if (c <= 0x1F) {
+    oled.col = (oled.col & 0x0F) | ((c & 0x07) << 4);
+  }
+}
+
+// O controlador guarda o comando incompleto entre transações: o driver manda
+// cada byte de comando numa transação própria (controle 0x80)
+static void oled_command(uint8_t b) {
+  if (oled.needed) {
+    oled.args[oled.nargs++] = b;
+    if (oled.nargs == oled.needed) {
+      oled.needed = 0;
+      oled_apply();
+    }
+    return;
+  }
+  oled.cmd = b;
+  oled.nargs = 0;
+  oled.needed = oled_arg_count(b);
+  if (!oled.needed)
+    oled_apply();
+}
+
+static void oled_data(uint8_t b) {
+  oled.ram[oled.page][oled.col] = b;
+  if (oled.mode == 1) {
+    if (++oled.page > oled.page_end) {
+      oled.page = oled.page_start;
+      if (++oled.col > oled.col_end)
+        oled.col = oled.col_start;
+    }
+  } else if (oled.mode == 0) {
+    if (++oled.col > oled.col_end) {
+      oled.col = oled.col_start;
+      if (++oled.page > oled.page_end)
+        oled.page = oled.page_start;
+    }
+  } else {
+    oled.col = (oled.col + 1) & 0x7F;
+  }
+}
+
+static void oled_begin(void) {
+  oled.tx = TX_CTRL;
+}
+
+static void oled_byte(uint8_t b) {
+  switch (oled.tx) {
+    case TX_CTRL:
+      oled.tx_data = b & 0x40;
+      oled.tx = (b & 0x80) ? TX_ONE : TX_STREAM;
+      break;
+    case TX_ONE:
+      oled.tx_data ? oled_data(b) : oled_command(b);
+      oled.tx = TX_CTRL;
+      break;
+    case TX_STREAM:
+      oled.tx_data ? oled_data(b) : oled_command(b);
+      break;
+  }
+}
+
+// PBM binário (P4): pixel aceso = preto
+bool sim_oled_write_pbm(const char *path) {
+  FILE *f = fopen(path, "wb");
+  if (!f)
+    return false;
+  fprintf(f, "P4\n128 64\n");
+  for (int y = 0; y < 64; ++y) {
+    for (int xb = 0; xb < 16; ++xb) {
+      uint8_t packed = 0;
+      for (int bit = 0; bit < 8; ++bit) {
+        bool lit = oled.on && ((oled.ram[y >> 3][xb * 8 + bit] >> (y & 7)) & 1);
+        if (lit != oled.invert)
+          packed |= 0x80 >> bit;
+      }
+      fputc(packed, f);
+    }
+  }
+  fclose(f);
+  return true;
+}
+
+static void oled_flushed(uint32_t bytes) {
+  sim_stats.oled_flushes++;
+  sim_stats.oled_bytes += bytes;
+  sim_log("oled", "%u", bytes);
+  if (frames_dir) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/oled_%08llu.pbm", frames_dir, (unsigned long long)sim_now());
+    sim_oled_write_pbm(path);
+  }
+}
+
+// ---------------------------------------------------------------------------
+// I2C
+// ---------------------------------------------------------------------------
+
+static i2c_hw_t i2c_regs[2];
+i2c_inst_t sim_i2c0_inst = { &i2c_regs[0], 0, 100000, 125000000 };
+i2c_inst_t sim_i2c1_inst = { &i2c_regs[1], 1, 100000, 125000000 };
+
+static bool nack_next;
+
+void sim_i2c_nack_next(void) {
+  nack_next = true;
+}
+
+// 9 bits por byte (8 de dados + ACK), com o divisor calculado para o
+// clk_peri do momento em que a taxa foi programada
+static double i2c_byte_us(const i2c_inst_t *i2c) {
+  return 9e6 / ((double)i2c->baudrate * clock_get_hz(clk_peri) / i2c->peri_hz);
+}
+
+uint i2c_set_baudrate(i2c_inst_t *i2c, uint baudrate) {
+  i2c->baudrate = baudrate;
+  i2c->peri_hz = clock_get_hz(clk_peri);
+  return baudrate;
+}
+
+uint i2c_init(i2c_inst_t *i2c, uint baudrate) {
+  i2c_set_baudrate(i2c, baudrate);
+  i2c->hw->enable = 1;
+  i2c->hw->status = I2C_IC_STATUS_TFE_BITS;
+  return baudrate;
+}
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop) {
+  if (addr != OLED_ADDR || nack_next) {
+    nack_next = false;
+    sim_stats.oled_nacks++;
+    sim_log("i2c", "nack,%u", addr);
+    return -1;   // PICO_ERROR_GENERIC
+  }
+  oled_begin();
+  for (size_t i = 0; i < len; ++i)
+    oled_byte(src[i]);
+  if (len > 1 && (src[0] & 0x40))
+    oled_flushed(len);
+  sim_advance((uint64_t)(len * i2c_byte_us(i2c)));
+  return (int)len;
+}
+
+// ---------------------------------------------------------------------------
+// PIO: a máquina de estados da WS2812 é representada só pelo TX FIFO
+// ---------------------------------------------------------------------------
+
+#define LED_MAX 25
+
+pio_hw_t sim_pio0_hw = { .index = 0 };
+pio_hw_t sim_pio1_hw = { .index = 1 };
+
+static uint8_t sm_claimed[2];
+static uint32_t led_frame[LED_MAX];
+static uint16_t led_count;
+
+uint pio_add_program(PIO pio, const pio_program_t *program) {
+  return 0;
+}
+
+int pio_claim_unused_sm(PIO pio, bool required) {
+  for (uint sm = 0; sm < 4; ++sm) {
+    if (!(sm_claimed[pio->index] & (1u << sm))) {
+      sm_claimed[pio->index] |= 1u << sm;
+      return sm;
+    }
+  }
+  if (required)
+    abort();
+  return -1;
+}
+
+// A temporização da WS2812 não é modelada: o quadro chega pronto pelo DMA
+void pio_sm_set_clkdiv(PIO pio, uint sm, float div) {
+}
+
+void pio_sm_put_blocking(PIO pio, uint sm, uint32_t data) {
+  pio->txf[sm] = data;
+}
+
+// Um quadro por linha: instante e as cores RRGGBB de cada LED, só quando mudou
+static void led_capture(const uint32_t *words, uint32_t n) {
+  if (n > LED_MAX)
+    n = LED_MAX;
+  sim_stats.led_frames++;
+  if (n == led_count && !memcmp(led_frame, words, n * sizeof(uint32_t)))
+    return;
+  memcpy(led_frame, words, n * sizeof(uint32_t));
+  led_count = n;
+  if (!leds_out)
+    return;
+  fprintf(leds_out, "%llu", (unsigned long long)sim_now());
+  for (uint32_t i = 0; i < n; ++i) {
+    uint32_t w = words[i];
+    fprintf(leds_out, " %02x%02x%02x", (w >> 16) & 0xFF, w >> 24, (w >> 8) & 0xFF);
+  }
+  fputc('\n', leds_out);
+}
+
+// ---------------------------------------------------------------------------
+// DMA: o destino é identificado pelo DREQ do canal
+// ---------------------------------------------------------------------------
+
+static struct {
+  bool claimed;
+  dma_channel_config cfg;
+  volatile void *write_addr;
+  const volatile void *read_addr;
+  bool busy;
+  bool irq0_enabled;
+  bool irq0_status;
+  int32_t done_event;
+  uint32_t ring_pos;         // Próxima posição de escrita no anel (em amostras)
+  uint32_t bytes;            // Tamanho do envio I2C em curso
+} dma[NUM_DMA_CHANNELS];
+
+static dma_channel_hw_t dma_regs[NUM_DMA_CHANNELS];
+
+static bool dreq_is_i2c(uint dreq) { return dreq == DREQ_I2C0_TX || dreq == DREQ_I2C1_TX; }
+static bool dreq_is_pio(uint dreq) { return dreq < 16 && (dreq & 4) == 0; }
+
+static i2c_inst_t *dma_i2c(uint channel) {
+  return dma[channel].cfg.dreq == DREQ_I2C0_TX ? i2c0 : i2c1;
+}
+
+int dma_claim_unused_channel(bool required) {
+  for (uint ch = 0; ch < NUM_DMA_CHANNELS; ++ch) {
+    if (!dma[ch].claimed) {
+      dma[ch].claimed = true;
+      return ch;
+    }
+  }
+  if (required)
+    abort();
+  return -1;
+}
+
+void dma_channel_unclaim(uint channel) {
+  dma[channel].claimed = false;
+}
+
+dma_channel_config dma_channel_get_default_config(uint channel) {
+  return (dma_channel_config){ DMA_SIZE_32, true, false, false, 0, DREQ_FORCE };
+}
+
+void channel_config_set_transfer_data_size(dma_channel_config *c, enum dma_channel_transfer_size size) { c->size = size; }
+void channel_config_set_read_increment(dma_channel_config *c, bool incr) { c->read_increment = incr; }
+void channel_config_set_write_increment(dma_channel_config *c, bool incr) { c->write_increment = incr; }
+void channel_config_set_dreq(dma_channel_config *c, uint dreq) { c->dreq = dreq; }
+
+void channel_config_set_ring(dma_channel_config *c, bool write, uint size_bits) {
+  c->ring_write = write;
+  c->ring_bits = size_bits;
+}
+
+static bool dma_adc_push(uint16_t sample) {
+  int ch = adc.dma_channel;
+  if (ch < 0 || !dma[ch].busy)
+    return false;
+  uint16_t *base = (uint16_t *)dma[ch].write_addr;
+  uint32_t ring_len = dma[ch].cfg.ring_bits ? (1u << dma[ch].cfg.ring_bits) / sizeof(uint16_t) : UINT32_MAX;
+  base[dma[ch].ring_pos % ring_len] = sample;
+  dma[ch].ring_pos++;
+  if (--dma_regs[ch].transfer_count == 0)
+    dma[ch].busy = false;
+  return true;
+}
+
+static void dma_complete(uint channel) {
+  dma[channel].busy = false;
+  dma[channel].done_event = 0;
+  dma_regs[channel].transfer_count = 0;
+  if (dma[channel].irq0_enabled) {
+    dma[channel].irq0_status = true;
+    irq_raise(DMA_IRQ_0);
+  }
+}
+
+static void dma_i2c_done(void *arg, int32_t id) {
+  uint ch = (uint)(uintptr_t)arg;
+  i2c_inst_t *i2c = dma_i2c(ch);
+  i2c->hw->status = I2C_IC_STATUS_TFE_BITS;
+  oled_flushed(dma[ch].bytes);
+  dma_complete(ch);
+}
+
+static void dma_pio_done(void *arg, int32_t id) {
+  dma_complete((uint)(uintptr_t)arg);
+}
+
+// Palavras de IC_DATA_CMD: byte nos 8 bits baixos, STOP no bit 9 fecha a transação
+static void dma_start_i2c(uint ch, const uint16_t *words, uint32_t count) {
+  i2c_inst_t *i2c = dma_i2c(ch);
+  if (nack_next) {
+    nack_next = false;
+    i2c->hw->raw_intr_stat |= I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS;
+    sim_stats.oled_nacks++;
+    sim_log("i2c", "nack,%u", i2c->hw->tar);
+    return;   // O controlador descarta a FIFO; o DMA fica parado até o abort
+  }
+  bool start = true;
+  for (uint32_t i = 0; i < count; ++i) {
+    if (start)
+      oled_begin();
+    oled_byte(words[i] & 0xFF);
+    start = words[i] & (1u << 9);
+  }
+  i2c->hw->status = I2C_IC_STATUS_ACTIVITY_BITS;
+  dma[ch].bytes = count;
+  dma[ch].done_event = sim_schedule(sim_now() + (uint64_t)(count * i2c_byte_us(i2c)), SIM_EV_HW,
+                                    0, dma_i2c_done, (void *)(uintptr_t)ch);
+}
+
+// 24 bits a 800 kHz por LED
+static void dma_start_pio(uint ch, const uint32_t *words, uint32_t count) {
+  led_capture(words, count);
+  dma[ch].done_event = sim_schedule(sim_now() + (uint64_t)count * 30, SIM_EV_HW, 0, dma_pio_done, (void *)(uintptr_t)ch);
+}
+
+static void dma_start(uint ch) {
+  uint32_t count = dma_regs[ch].transfer_count;
+  dma[ch].busy = count > 0;
+  if (!count)
+    return;
+  uint dreq = dma[ch].cfg.dreq;
+  if (dreq == DREQ_ADC) {
+    adc_sync();
+    adc.dma_channel = ch;
+    dma[ch].ring_pos = 0;
+  } else if (dreq_is_i2c(dreq)) {
+    dma_start_i2c(ch, (const uint16_t *)dma[ch].read_addr, count);
+  } else if (dreq_is_pio(dreq)) {
+    dma_start_pio(ch, (const uint32_t *)dma[ch].read_addr, count);
+  } else {
+    dma[ch].busy = false;
+  }
+}
+
+void dma_channel_configure(uint channel, const dma_channel_config *config, volatile void *write_addr,
+                           const volatile void *read_addr, uint transfer_count, bool trigger) {
+  if (dma[channel].cfg.dreq == DREQ_ADC)
+    adc_sync();
+  dma[channel].cfg = *config;
+  dma[channel].write_addr = write_addr;
+  dma[channel].read_addr = read_addr;
+  dma_regs[channel].transfer_count = transfer_count;
+  if (trigger)
+    dma_start(channel);
+}
+
+void dma_channel_transfer_from_buffer_now(uint channel, const volatile void *read_addr, uint32_t transfer_count) {
+  dma[channel].read_addr = read_addr;
+  dma_regs[channel].transfer_count = transfer_count;
+  dma_start(channel);
+}
+
+void dma_channel_transfer_to_buffer_now(uint channel, volatile void *write_addr, uint32_t transfer_count) {
+  dma[channel].write_addr = write_addr;
+  dma_regs[channel].transfer_count = transfer_count;
+  dma_start(channel);
+}
+
+dma_channel_hw_t *dma_channel_hw_addr(uint channel) {
+  if (dma[channel].cfg.dreq == DREQ_ADC)
+    adc_sync();
+  return &dma_regs[channel];
+}
+
+bool dma_channel_is_busy(uint channel) {
+  if (dma[channel].cfg.dreq == DREQ_ADC)
+    adc_sync();
+  return dma[channel].busy;
+}
+
+void dma_channel_wait_for_finish_blocking(uint channel) {
+  while (dma_channel_is_busy(channel))
+    tight_loop_contents();
+}
+
+// No firmware o abort é seguido da leitura de IC_CLR_TX_ABRT; como leituras
+// não têm efeito aqui, o abort de um canal do I2C já limpa o TX_ABRT
+void dma_channel_abort(uint channel) {
+  if (dma[channel].cfg.dreq == DREQ_ADC) {
+    adc_sync();
+    if (adc.dma_channel == (int)channel)
+      adc.dma_channel = -1;
+  }
+  if (dma[channel].done_event)
+    sim_cancel(dma[channel].done_event);
+  dma[channel].done_event = 0;
+  dma[channel].busy = false;
+  if (dreq_is_i2c(dma[channel].cfg.dreq)) {
+    i2c_hw_t *hw = dma_i2c(channel)->hw;
+    hw->raw_intr_stat &= ~I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS;
+    hw->status = I2C_IC_STATUS_TFE_BITS;
+  }
+}
+
+void dma_channel_set_irq0_enabled(uint channel, bool enabled) {
+  dma[channel].irq0_enabled = enabled;
+}
+
+bool dma_channel_get_irq0_status(uint channel) {
+  return dma[channel].irq0_status;
+}
+
+void dma_channel_acknowledge_irq0(uint channel) {
+  dma[channel].irq0_status = false;
+}
+
+// ---------------------------------------------------------------------------
+// PWM: registra frequência e ciclo de trabalho sempre que mudam
+// ---------------------------------------------------------------------------
+
+static struct {
+  uint32_t div16;            // Divisor em 1/16
+  uint16_t wrap;
+  uint16_t level[2];
+  bool enabled;
+  int8_t gpio[2];
+  uint32_t logged_freq[2];
+  uint32_t logged_duty[2];
+} slices[8];
+
+void gpio_set_function(uint gpio, enum gpio_function fn) {
+  pins[gpio].func = fn;
+  if (fn == GPIO_FUNC_PWM)
+    slices[pwm_gpio_to_slice_num(gpio)].gpio[pwm_gpio_to_channel(gpio)] = gpio;
+}
+
+pwm_config pwm_get_default_config(void) {
+  return (pwm_config){ 0, 16, 0xFFFF };
+}
+
+static void pwm_report(uint slice, uint chan) {
+  uint32_t period = slices[slice].wrap + 1u;
+  uint32_t freq = 0, duty = 0;
+  if (slices[slice].enabled && slices[slice].level[chan]) {
+    freq = (uint32_t)((uint64_t)clock_get_hz(clk_sys) * 16 / ((uint64_t)slices[slice].div16 * period));
+    duty = slices[slice].level[chan] >= period ? 100 : slices[slice].level[chan] * 100u / period;
+  }
+  if (freq == slices[slice].logged_freq[chan] && duty == slices[slice].logged_duty[chan])
+    return;
+  slices[slice].logged_freq[chan] = freq;
+  slices[slice].logged_duty[chan] = duty;
+  sim_stats.pwm_changes++;
+  sim_log("pwm", "%d,%u,%u", slices[slice].gpio[chan], freq, duty);
+}
+
+void pwm_init(uint slice_num, pwm_config *c, bool start) {
+  slices[slice_num].div16 = c->div;
+  slices[slice_num].wrap = c->top;
+  slices[slice_num].enabled = start;
+}
+
+void pwm_set_clkdiv_int_frac(uint slice_num, uint8_t integer, uint8_t fract) {
+  slices[slice_num].div16 = ((uint32_t)integer << 4) | (fract & 0xF);
+}
+
+void pwm_set_wrap(uint slice_num, uint16_t wrap) {
+  slices[slice_num].wrap = wrap;
+}
+
+void pwm_set_chan_level(uint slice_num, uint chan, uint16_t level) {
+  slices[slice_num].level[chan] = level;
+  pwm_report(slice_num, chan);
+}
+
+void pwm_set_gpio_level(uint gpio, uint16_t level) {
+  pwm_set_chan_level(pwm_gpio_to_slice_num(gpio), pwm_gpio_to_channel(gpio), level);
+}
+
+void pwm_set_enabled(uint slice_num, bool enabled) {
+  slices[slice_num].enabled = enabled;
+  pwm_report(slice_num, 0);
+  pwm_report(slice_num, 1);
+}
+
+// ---------------------------------------------------------------------------
+
+void sim_periph_init(void) {
+  sim_flash_init();
+  for (uint i = 0; i < NUM_BANK0_GPIOS; ++i)
+    pins[i].ext = -1;
+  for (uint s = 0; s < 8; ++s)
+    slices[s].gpio[0] = slices[s].gpio[1] = -1;
+  adc.dma_channel = -1;
+  // Sensor de temperatura interno (~27 C) e entradas em meia escala
+  for (uint i = 0; i < ADC_INPUTS; ++i)
+    adc_in[i].v0 = adc_in[i].v1 = i == 4 ? 876 : 2048;
+}
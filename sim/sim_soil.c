@@ -0,0 +1,98 @@
+#include <math.h>
+#include "sim.h"
+
+// ---------------------------------------------------------------------------
+// Solo do vaso: a bomba (GPIO 12) despeja água na superfície, que infiltra com
+// atraso (constante de tempo tau) e sobe a umidade; o solo seca devagar e,
+// saturado, o excesso escorre pelo fundo. A umidade vira a tensão do canal 0
+// do ADC pela mesma reta da calibração do firmware (0 = 99 %, 4095 = 0 %).
+// Com o reservatório vazio a bomba liga e não sai água.
+// ---------------------------------------------------------------------------
+
+#define SOIL_PUMP_GPIO 12
+#define SOIL_ADC       0
+#define SOIL_STEP_US   100000
+#define SOIL_LOG_US    10000000      // Uma linha de umidade a cada 10 s
+
+static struct {
+  bool active;
+  bool pump;
+  bool tank_empty;
+  double moisture;           // %
+  double surface;            // Água ainda na superfície, em % de umidade
+  double flow;               // %/s com a bomba ligada
+  double dry_per_h;          // %/h
+  double tau_s;
+  double saturation;         // %
+  double pump_s;             // Bomba ligada com água
+  double dry_pump_s;         // Bomba ligada a seco
+  double drained;            // Excesso escorrido, em % de umidade
+  uint64_t next_log;
+} soil = { .tau_s = 4.0, .saturation = 90.0 };
+
+static void soil_output(void) {
+  double counts = (99.0 - soil.moisture) * 4095.0 / 99.0;
+  sim_adc_hold(SOIL_ADC, counts < 0 ? 0 : counts > 4095 ? 4095 : (uint16_t)lround(counts));
+}
+
+static void soil_step(void *arg, int32_t id) {
+  const double dt = SOIL_STEP_US * 1e-6;
+  if (soil.pump) {
+    if (soil.tank_empty) {
+      soil.dry_pump_s += dt;
+    } else {
+      soil.surface += soil.flow * dt;
+      soil.pump_s += dt;
+    }
+  }
+  double infiltrated = soil.surface * (1.0 - exp(-dt / soil.tau_s));
+  soil.surface -= infiltrated;
+  soil.moisture += infiltrated - soil.dry_per_h / 3600.0 * dt;
+  if (soil.moisture < 0)
+    soil.moisture = 0;
+  if (soil.moisture > soil.saturation) {
+    if (soil.drained == 0)
+      sim_log("solo", "transbordo,%.1f", soil.moisture);
+    soil.drained += soil.moisture - soil.saturation;
+    soil.moisture = soil.saturation;
+  }
+  soil_output();
+  if (sim_now() >= soil.next_log) {
+    sim_log("solo", "umidade,%.1f", soil.moisture);
+    soil.next_log += SOIL_LOG_US;
+  }
+  sim_schedule(sim_now() + SOIL_STEP_US, SIM_EV_HW, 0, soil_step, NULL);
+}
+
+void sim_soil_start(double moisture, double flow, double dry_per_h, double tau_s) {
+  soil.moisture = moisture;
+  soil.flow = flow;
+  soil.dry_per_h = dry_per_h;
+  if (tau_s > 0)
+    soil.tau_s = tau_s;
+  sim_log("solo", "inicio,%.1f,%.2f,%.2f,%.1f", moisture, flow, dry_per_h, soil.tau_s);
+  soil_output();
+  if (!soil.active) {
+    soil.active = true;
+    soil.next_log = sim_now();
+    sim_schedule(sim_now() + SOIL_STEP_US, SIM_EV_HW, 0, soil_step, NULL);
+  }
+}
+
+void sim_soil_tank(bool empty) {
+  soil.tank_empty = empty;
+  sim_log("solo", "reservatorio,%s", empty ? "vazio" : "cheio");
+}
+
+// Chamada pelo gpio_put: só interessa o pino da bomba
+void sim_soil_gpio(uint gpio, bool level) {
+  if (gpio == SOIL_PUMP_GPIO)
+    soil.pump = level;
+}
+
+void sim_soil_print(FILE *f) {
+  if (!soil.active)
+    return;
+  fprintf(f, "sim: solo %.1f %% | bomba %.1f s com agua, %.1f s a seco | escorrido %.1f %%\n",
+          soil.moisture, soil.pump_s, soil.dry_pump_s, soil.drained);
+}
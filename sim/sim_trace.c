@@ -0,0 +1,215 @@
+#include <stdlib.h>
+#include <string.h>
+#include "sim.h"
+#include "wav.h"
+
+// ---------------------------------------------------------------------------
+// Roteiro de entradas: uma ação por linha, em ms de tempo virtual
+//
+//   # comentário
+//   <t_ms> adc<N>|temp|umidade|lumi <0..4095> [rampa_ms]
+//   <t_ms> gpio<N>|btnA|btnB|sw <0|1|solto>
+//   <t_ms> press btnA|btnB|sw [duracao_ms]     (aperta e solta, padrão 100 ms)
+//   <t_ms> noise adc<N>|temp|umidade|lumi <amplitude>
+//   <t_ms> nack                                (próxima transação I2C sem ACK)
+//   <t_ms> usb <texto>                         (caracteres recebidos pelo USB)
+//   <t_ms> host parado|lendo                   (o PC para ou volta a ler a porta USB)
+//   <t_ms> corte                               (falta de energia: a simulação para ali)
+//   <t_ms> solo <umidade_%> [vazao_%/s] [secagem_%/h] [infiltracao_s]
+//                                              (liga o modelo do solo: a bomba molha e
+//                                               o canal da umidade passa a seguir o vaso)
+//   <t_ms> reservatorio cheio|vazio            (vazio: a bomba liga e não sai água)
+//   <t_ms> wav adc<N>|temp|umidade|lumi <arquivo.wav> [repete]
+//                                              (WAV PCM de 16 bits na entrada, com o
+//                                               caminho relativo ao roteiro)
+//
+// As ações ficam ordenadas por tempo e só a próxima ocupa a fila de eventos.
+// ---------------------------------------------------------------------------
+
+typedef enum { ACT_ADC, ACT_NOISE, ACT_GPIO, ACT_NACK, ACT_USB, ACT_CUT, ACT_SOIL, ACT_TANK, ACT_WAV, ACT_HOST } action_kind_t;
+
+typedef struct {
+  uint64_t t_us;
+  uint32_t line;             // Desempate estável entre ações do mesmo instante
+  action_kind_t kind;
+  uint8_t target;
+  int32_t value;
+  uint32_t ramp_us;
+  char *text;
+  double soil[4];            // Parâmetros do modelo do solo
+  int16_t *wav;
+  size_t wav_count;
+  uint32_t wav_rate;
+} action_t;
+
+static action_t *actions;
+static size_t action_count, action_next;
+static char trace_dir[256];   // Diretório do roteiro, com a barra final
+
+// Nomes da placa: canal 1 é a temperatura (eixo X), 0 a umidade (eixo Y), 2 o microfone
+static int adc_input(const char *name) {
+  if (!strcmp(name, "temp")) return 1;
+  if (!strcmp(name, "umidade")) return 0;
+  if (!strcmp(name, "lumi")) return 2;
+  if (!strncmp(name, "adc", 3)) return atoi(name + 3);
+  return -1;
+}
+
+static int gpio_pin(const char *name) {
+  if (!strcmp(name, "btnA")) return 5;
+  if (!strcmp(name, "btnB")) return 6;
+  if (!strcmp(name, "sw")) return 22;
+  if (!strncmp(name, "gpio", 4)) return atoi(name + 4);
+  return -1;
+}
+
+static void add_action(action_t a) {
+  static size_t capacity;
+  if (action_count == capacity) {
+    capacity = capacity ? capacity * 2 : 64;
+    actions = realloc(actions, capacity * sizeof(action_t));
+  }
+  actions[action_count++] = a;
+}
+
+static int action_cmp(const void *pa, const void *pb) {
+  const action_t *a = pa, *b = pb;
+  if (a->t_us != b->t_us)
+    return a->t_us < b->t_us ? -1 : 1;
+  return a->line < b->line ? -1 : a->line > b->line;
+}
+
+static void schedule_next(void);
+
+static void action_fire(void *arg, int32_t id) {
+  const action_t *a = &actions[action_next++];
+  switch (a->kind) {
+    case ACT_ADC: sim_adc_set(a->target, a->value, a->ramp_us); break;
+    case ACT_NOISE: sim_adc_noise(a->target, a->value); break;
+    case ACT_GPIO: sim_gpio_drive(a->target, a->value); break;
+    case ACT_NACK: sim_i2c_nack_next(); break;
+    case ACT_USB: sim_usb_input(a->text); break;
+    case ACT_CUT: sim_flash_power_cut(); break;
+    case ACT_SOIL: sim_soil_start(a->soil[0], a->soil[1], a->soil[2], a->soil[3]); break;
+    case ACT_TANK: sim_soil_tank(a->value); break;
+    case ACT_WAV: sim_adc_wav(a->target, a->wav, a->wav_count, a->wav_rate, a->value); break;
+    case ACT_HOST: sim_usb_host(a->value); break;
+  }
+  schedule_next();
+}
+
+static void schedule_next(void) {
+  if (action_next < action_count)
+    sim_schedule(actions[action_next].t_us, SIM_EV_HW, 0, action_fire, NULL);
+}
+
+static bool parse_line(char *s, uint32_t line) {
+  char *hash = strchr(s, '#');
+  if (hash)
+    *hash = '\0';
+  char *tok[6] = {0};
+  int n = 0;
+  for (char *p = strtok(s, " \t\r\n"); p && n < 6; p = strtok(NULL, " \t\r\n"))
+    tok[n++] = p;
+  if (n == 0)
+    return true;
+  if (n < 2)
+    return false;
+
+  action_t a = { (uint64_t)(strtod(tok[0], NULL) * 1000), line };
+  int target;
+  if (!strcmp(tok[1], "nack")) {
+    a.kind = ACT_NACK;
+  } else if (!strcmp(tok[1], "corte")) {
+    a.kind = ACT_CUT;
+  } else if (!strcmp(tok[1], "solo") && n >= 3) {
+    // Padrões: 2 %/s de vazão, seca 1 %/h, infiltração com tau de 4 s
+    static const double defaults[4] = { 0, 2.0, 1.0, 4.0 };
+    a.kind = ACT_SOIL;
+    for (int i = 0; i < 4; ++i)
+      a.soil[i] = n > i + 2 ? strtod(tok[i + 2], NULL) : defaults[i];
+  } else if (!strcmp(tok[1], "reservatorio") && n >= 3) {
+    a.kind = ACT_TANK;
+    a.value = !strcmp(tok[2], "vazio");
+  } else if (!strcmp(tok[1], "host") && n >= 3) {
+    a.kind = ACT_HOST;
+    a.value = !strcmp(tok[2], "lendo");
+  } else if (!strcmp(tok[1], "usb") && n >= 3) {
+    a.kind = ACT_USB;
+    a.text = strdup(tok[2]);
+  } else if (!strcmp(tok[1], "press") && n >= 3 && (target = gpio_pin(tok[2])) >= 0) {
+    // Botões da placa são ativos em nível baixo. Com "quique", o contato
+    // repica por ~2 ms ao apertar e ao soltar, como uma chave de verdade
+    static const uint32_t bounce_us[] = { 300, 700, 1200, 1900 };
+    uint32_t hold_ms = n >= 4 ? (uint32_t)atoi(tok[3]) : 100;
+    bool bounce = n >= 5 && !strcmp(tok[4], "quique");
+    a.kind = ACT_GPIO;
+    a.target = target;
+    for (int edge = 0; edge < 2; ++edge) {
+      action_t b = a;
+      b.value = edge;
+      add_action(b);
+      for (uint32_t i = 0; bounce && i < count_of(bounce_us); ++i) {
+        b.t_us = a.t_us + bounce_us[i];
+        b.value = edge ^ !(i & 1);
+        add_action(b);
+      }
+      a.t_us += (uint64_t)hold_ms * 1000;
+    }
+    return true;
+  } else if (!strcmp(tok[1], "wav") && n >= 4 && (target = adc_input(tok[2])) >= 0) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s%s", tok[3][0] == '/' ? "" : trace_dir, tok[3]);
+    a.kind = ACT_WAV;
+    a.target = target;
+    a.value = n >= 5 && !strcmp(tok[4], "repete");
+    if (!(a.wav = wav_load(path, &a.wav_rate, &a.wav_count)))
+      return false;
+  } else if (!strcmp(tok[1], "noise") && n >= 4 && (target = adc_input(tok[2])) >= 0) {
+    a.kind = ACT_NOISE;
+    a.target = target;
+    a.value = atoi(tok[3]);
+  } else if (n >= 3 && (target = adc_input(tok[1])) >= 0) {
+    a.kind = ACT_ADC;
+    a.target = target;
+    a.value = atoi(tok[2]);
+    a.ramp_us = n >= 4 ? (uint32_t)atoi(tok[3]) * 1000 : 0;
+  } else if (n >= 3 && (target = gpio_pin(tok[1])) >= 0) {
+    a.kind = ACT_GPIO;
+    a.target = target;
+    a.value = !strcmp(tok[2], "solto") ? -1 : atoi(tok[2]) != 0;
+  } else {
+    return false;
+  }
+  add_action(a);
+  return true;
+}
+
+bool sim_trace_load(const char *path) {
+  FILE *f = fopen(path, "r");
+  if (!f) {
+    fprintf(stderr, "sim: nao abriu o roteiro %s\n", path);
+    return false;
+  }
+  const char *slash = strrchr(path, '/');
+  size_t dir_len = slash ? (size_t)(slash - path + 1) : 0;
+  if (dir_len >= sizeof(trace_dir))
+    dir_len = 0;
+  memcpy(trace_dir, path, dir_len);
+  trace_dir[dir_len] = '\0';
+  char buf[256];
+  uint32_t line = 0;
+  bool ok = true;
+  while (fgets(buf, sizeof(buf), f)) {
+    ++line;
+    if (!parse_line(buf, line)) {
+      fprintf(stderr, "sim: %s:%u: linha invalida\n", path, line);
+      ok = false;
+    }
+  }
+  fclose(f);
+  qsort(actions, action_count, sizeof(action_t), action_cmp);
+  action_next = 0;
+  schedule_next();
+  return ok;
+}
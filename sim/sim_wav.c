@@ -0,0 +1,96 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "wav.h"
+
+static uint32_t le32(const uint8_t *p) {
+  return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint16_t le16(const uint8_t *p) {
+  return p[0] | (p[1] << 8);
+}
+
+static void put32(uint8_t *p, uint32_t v) {
+  for (int i = 0; i < 4; ++i)
+    p[i] = v >> (8 * i);
+}
+
+static void put16(uint8_t *p, uint16_t v) {
+  p[0] = v;
+  p[1] = v >> 8;
+}
+
+// Percorre os blocos RIFF até "fmt " e "data"; outros blocos (LIST etc.) são pulados
+int16_t *wav_load(const char *path, uint32_t *rate, size_t *count) {
+  FILE *f = fopen(path, "rb");
+  if (!f) {
+    fprintf(stderr, "wav: nao abriu %s\n", path);
+    return NULL;
+  }
+  uint8_t hdr[12], chunk[8], fmt[16];
+  uint16_t channels = 0, bits = 0;
+  int16_t *out = NULL;
+  if (fread(hdr, 1, 12, f) != 12 || memcmp(hdr, "RIFF", 4) || memcmp(hdr + 8, "WAVE", 4))
+    goto invalid;
+  while (fread(chunk, 1, 8, f) == 8) {
+    uint32_t size = le32(chunk + 4);
+    if (!memcmp(chunk, "fmt ", 4) && size >= 16) {
+      if (fread(fmt, 1, 16, f) != 16)
+        goto invalid;
+      if (le16(fmt) != 1)   // Só PCM inteiro
+        goto invalid;
+      channels = le16(fmt + 2);
+      *rate = le32(fmt + 4);
+      bits = le16(fmt + 14);
+      fseek(f, (long)(size - 16 + (size & 1)), SEEK_CUR);
+    } else if (!memcmp(chunk, "data", 4)) {
+      if (!channels || bits != 16)
+        goto invalid;
+      size_t frames = size / (2u * channels);
+      out = malloc((frames ? frames : 1) * sizeof(int16_t));
+      uint8_t frame[2 * 8];
+      size_t n = 0;
+      for (; n < frames && channels <= 8 && fread(frame, 2u * channels, 1, f) == 1; ++n)
+        out[n] = (int16_t)le16(frame);
+      *count = n;
+      fclose(f);
+      return out;
+    } else {
+      fseek(f, (long)(size + (size & 1)), SEEK_CUR);
+    }
+  }
+invalid:
+  fprintf(stderr, "wav: %s nao e um WAV PCM de 16 bits\n", path);
+  fclose(f);
+  return NULL;
+}
+
+bool wav_save(const char *path, const int16_t *samples, size_t count, uint32_t rate) {
+  FILE *f = fopen(path, "wb");
+  if (!f) {
+    fprintf(stderr, "wav: nao criou %s\n", path);
+    return false;
+  }
+  uint8_t hdr[44];
+  uint32_t data = (uint32_t)(count * 2);
+  memcpy(hdr, "RIFF", 4);
+  put32(hdr + 4, 36 + data);
+  memcpy(hdr + 8, "WAVEfmt ", 8);
+  put32(hdr + 16, 16);
+  put16(hdr + 20, 1);        // PCM
+  put16(hdr + 22, 1);        // Mono
+  put32(hdr + 24, rate);
+  put32(hdr + 28, rate * 2);
+  put16(hdr + 32, 2);
+  put16(hdr + 34, 16);
+  memcpy(hdr + 36, "data", 4);
+  put32(hdr + 40, data);
+  bool ok = fwrite(hdr, 1, 44, f) == 44;
+  for (size_t i = 0; ok && i < count; ++i) {
+    uint8_t s[2];
+    put16(s, (uint16_t)samples[i]);
+    ok = fwrite(s, 1, 2, f) == 2;
+  }
+  return fclose(f) == 0 && ok;
+}
@@ -0,0 +1,14 @@
+#ifndef WAV_H
+#define WAV_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Arquivos WAV PCM de 16 bits (sim_wav.c), para a simulação e as ferramentas
+// do PC. Na leitura, com mais de um canal fica só o primeiro
+
+int16_t *wav_load(const char *path, uint32_t *rate, size_t *count);
+bool wav_save(const char *path, const int16_t *samples, size_t count, uint32_t rate);
+
+#endif
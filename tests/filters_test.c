@@ -0,0 +1,278 @@
+// Testes no PC da cadeia de filtros e da histerese (lib/filters.c).
+//
+// Além dos casos de cada estágio, repassa traços ruidosos pela mesma cadeia e
+// pelos mesmos limiares do firmware. Os traços são sintéticos, com semente
+// fixa: rampa lenta cruzando o limiar, ruído uniforme e picos isolados de
+// escala cheia, como os do joystick e do sensor de umidade na placa. Com
+// arquivos na linha de comando (uma amostra bruta por linha), repassa também
+// esses traços gravados pelo seletor e mostra as trocas de zona.
+//
+//   filters_test [traco.txt ...]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "lib/filters.h"
+
+// Os mesmos parâmetros do Projeto_Integrado.c
+#define OS_LOG2 5
+#define MEDIANA 5
+#define EMA     3
+
+static int failures;
+
+#define CHECK(cond, ...)                                       \
+  do {                                                         \
+    if (!(cond)) {                                             \
+      printf("FALHOU %s:%d: ", __FILE__, __LINE__);            \
+      printf(__VA_ARGS__);                                     \
+      printf("\n");                                            \
+      failures++;                                              \
+    }                                                          \
+  } while (0)
+
+static uint32_t rng = 0x2545F491u;
+
+static uint32_t xorshift(void) {
+  rng ^= rng << 13;
+  rng ^= rng >> 17;
+  rng ^= rng << 5;
+  return rng;
+}
+
+// Inteiro uniforme em [-amp, amp]
+static int32_t noise(int32_t amp) {
+  return amp ? (int32_t)(xorshift() % (2u * amp + 1)) - amp : 0;
+}
+
+static uint16_t clamp12(int32_t v) {
+  return (uint16_t)(v < 0 ? 0 : v > 4095 ? 4095 : v);
+}
+
+// Cada saída da sobreamostragem é a média exata das 2^n amostras
+static void test_oversampling(void) {
+  filter_chain_t f;
+  filter_init(&f, 2, 1, 0);
+  static const uint16_t in[] = { 10, 20, 30, 40, 100, 100, 100, 104 };
+  int outputs = 0;
+  for (unsigned i = 0; i < sizeof(in) / sizeof(in[0]); ++i) {
+    bool out = filter_push(&f, in[i]);
+    CHECK(out == (i % 4 == 3), "saída na amostra %u", i);
+    if (out) {
+      uint16_t expected = outputs ? 101 : 25;
+      CHECK(filter_value(&f) == expected, "média %u, esperado %u", filter_value(&f), expected);
+      outputs++;
+    }
+  }
+  CHECK(f.outputs == 2, "%u saídas", (unsigned)f.outputs);
+}
+
+// Uma janela cheia da mediana de 5 com 10..50 na ordem dada; conta 1
+static int check_median5(const int *perm) {
+  static const uint16_t v[5] = { 10, 20, 30, 40, 50 };
+  filter_chain_t f;
+  filter_init(&f, 0, 5, 0);
+  for (int i = 0; i < 5; ++i)
+    filter_push(&f, v[perm[i]]);
+  CHECK(filter_value(&f) == 30, "mediana %u com %d %d %d %d %d", filter_value(&f), perm[0], perm[1], perm[2], perm[3],
+        perm[4]);
+  return 1;
+}
+
+// A mediana tira picos menores que metade da janela e deixa passar degraus
+static void test_median(void) {
+  filter_chain_t f;
+  filter_init(&f, 0, 5, 0);
+  for (int i = 0; i < 5; ++i)
+    filter_push(&f, 1000);
+  static const uint16_t spikes[] = { 4095, 1000, 0, 1000, 4095, 4095, 1000, 1000, 0, 0 };
+  for (unsigned i = 0; i < sizeof(spikes) / sizeof(spikes[0]); ++i) {
+    filter_push(&f, spikes[i]);
+    CHECK(filter_value(&f) == 1000, "pico %u passou pela mediana de 5 (%u)", i, filter_value(&f));
+  }
+  // Degrau: a saída muda na 3a amostra nova e fica
+  for (int i = 0; i < 5; ++i)
+    filter_push(&f, 1000);
+  for (int i = 1; i <= 5; ++i) {
+    filter_push(&f, 2000);
+    CHECK(filter_value(&f) == (i < 3 ? 1000 : 2000), "degrau, amostra %d: %u", i, filter_value(&f));
+  }
+
+  filter_init(&f, 0, 3, 0);
+  static const uint16_t in3[] = { 500, 500, 500, 4095, 500, 0, 500 };
+  for (unsigned i = 0; i < sizeof(in3) / sizeof(in3[0]); ++i) {
+    filter_push(&f, in3[i]);
+    CHECK(filter_value(&f) == 500, "pico %u passou pela mediana de 3 (%u)", i, filter_value(&f));
+  }
+
+  // Todas as 120 ordens de 5 valores distintos dão a mediana certa: a
+  // identidade e as 119 trocas do algoritmo de Heap
+  int perm[5] = { 0, 1, 2, 3, 4 }, c[5] = { 0 }, checked = 0;
+  checked += check_median5(perm);
+  for (int k = 0; k < 5;) {
+    if (c[k] < k) {
+      int a = k % 2 ? c[k] : 0, t = perm[a];
+      perm[a] = perm[k];
+      perm[k] = t;
+      c[k]++;
+      k = 0;
+      checked += check_median5(perm);
+    } else {
+      c[k++] = 0;
+    }
+  }
+  CHECK(checked == 120, "%d permutações", checked);
+}
+
+// A EMA parte do primeiro valor, é exata em entrada constante e segue um
+// degrau sem passar do alvo
+static void test_ema(void) {
+  filter_chain_t f;
+  filter_init(&f, 0, 1, EMA);
+  filter_push(&f, 1234);
+  CHECK(filter_value(&f) == 1234, "primeira saída %u", filter_value(&f));
+  for (int i = 0; i < 100; ++i)
+    filter_push(&f, 1234);
+  CHECK(filter_value(&f) == 1234, "constante %u", filter_value(&f));
+
+  uint16_t prev = filter_value(&f);
+  int settle = -1;
+  for (int i = 0; i < 200; ++i) {
+    filter_push(&f, 3000);
+    uint16_t out = filter_value(&f);
+    CHECK(out >= prev && out <= 3000, "degrau, saída %d: %u depois de %u", i, out, prev);
+    if (settle < 0 && 3000 - out <= 1)
+      settle = i;
+    prev = out;
+  }
+  // Peso 1/8: a distância cai 12,5% por saída, ~60 saídas para 1 contagem
+  CHECK(settle > 20 && settle < 80, "acomodou em %d saídas", settle);
+  CHECK(filter_value(&f) >= 2999, "final %u", filter_value(&f));
+}
+
+// Histerese nos dois sentidos: só troca além das bordas
+static void test_hysteresis(void) {
+  hysteresis_t h = HYST_ABOVE_INIT(80, 77);
+  static const int32_t up[] = { 70, 80, 81, 79, 78, 77, 76, 79, 80, 81 };
+  static const bool up_active[] = { false, false, true, true, true, true, false, false, false, true };
+  for (unsigned i = 0; i < sizeof(up) / sizeof(up[0]); ++i)
+    CHECK(hyst_update(&h, up[i]) == up_active[i], "acima, valor %ld", (long)up[i]);
+
+  hysteresis_t b = HYST_BELOW_INIT(30, 33);
+  static const int32_t down[] = { 40, 30, 29, 31, 33, 34, 32, 30, 29 };
+  static const bool down_active[] = { false, false, true, true, true, false, false, false, true };
+  for (unsigned i = 0; i < sizeof(down) / sizeof(down[0]); ++i)
+    CHECK(hyst_update(&b, down[i]) == down_active[i], "abaixo, valor %ld", (long)down[i]);
+}
+
+typedef struct {
+  uint32_t raw;                  // Trocas do limiar sem filtro nem histerese
+  uint32_t filtered;             // Trocas depois da cadeia e da histerese
+} flips_t;
+
+// Amostras brutas pela cadeia do firmware e pela histerese; conta as trocas
+// dos dois jeitos para mostrar que o traço de fato oscila no limiar
+static flips_t replay(const uint16_t *trace, size_t n, hysteresis_t h, bool verbose) {
+  filter_chain_t f;
+  filter_init(&f, OS_LOG2, MEDIANA, EMA);
+  flips_t flips = { 0, 0 };
+  bool raw_state = false, state = false;
+  for (size_t i = 0; i < n; ++i) {
+    bool raw = h.dir == HYST_ABOVE ? trace[i] > h.on : trace[i] < h.on;
+    flips.raw += raw != raw_state;
+    raw_state = raw;
+    if (!filter_push(&f, trace[i]))
+      continue;
+    bool active = hyst_update(&h, filter_value(&f));
+    if (active != state) {
+      flips.filtered++;
+      if (verbose)
+        printf("  amostra %zu: %s (%u)\n", i, active ? "ativo" : "livre", filter_value(&f));
+    }
+    state = active;
+  }
+  return flips;
+}
+
+// Rampa de 'from' a 'to' e de volta, com ruído uniforme de +-amp e um pico de
+// escala cheia (0 ou 4095) a cada 'spike_every' amostras em média
+static size_t ramp_trace(uint16_t *out, size_t n, int32_t from, int32_t to, int32_t amp, uint32_t spike_every) {
+  for (size_t i = 0; i < n; ++i) {
+    size_t half = n / 2;
+    int32_t pos = (int32_t)(i < half ? i : n - 1 - i);
+    int32_t v = from + (to - from) * pos / (int32_t)half + noise(amp);
+    if (spike_every && xorshift() % spike_every == 0)
+      v = xorshift() & 1 ? 4095 : 0;
+    out[i] = clamp12(v);
+  }
+  return n;
+}
+
+// Seletor da rega (eixo X, 1 kHz no firmware): o joystick vai devagar até a
+// direita e volta, com ruído e picos. Uma entrada e uma saída da zona alta
+static void test_selector_trace(void) {
+  static uint16_t trace[40000];
+  size_t n = ramp_trace(trace, 40000, 2700, 3400, 120, 200);
+  flips_t flips = replay(trace, n, (hysteresis_t)HYST_ABOVE_INIT(3080, 2980), false);
+  CHECK(flips.raw > 100, "o traço do seletor devia oscilar sem filtro (%u trocas)", (unsigned)flips.raw);
+  CHECK(flips.filtered == 2, "seletor: %u trocas com filtro e histerese, esperado 2", (unsigned)flips.filtered);
+
+  n = ramp_trace(trace, 40000, 1400, 700, 120, 200);
+  flips = replay(trace, n, (hysteresis_t)HYST_BELOW_INIT(1000, 1100), false);
+  CHECK(flips.raw > 100, "o traço da zona baixa devia oscilar (%u trocas)", (unsigned)flips.raw);
+  CHECK(flips.filtered == 2, "zona baixa: %u trocas, esperado 2", (unsigned)flips.filtered);
+}
+
+// Umidade do solo em contagens perto do alerta de 30% (~1229 de 4095) e da
+// liberação em 33% (~1351): a umidade quase parada no limiar, com ruído maior
+// que a banda da histerese, não pode piscar o alerta
+static void test_moisture_trace(void) {
+  static uint16_t trace[60000];
+  for (size_t i = 0; i < 60000; ++i) {
+    int32_t v = (i < 20000 ? 1300 : i < 40000 ? 1200 : 1400) + noise(200);
+    if (xorshift() % 500 == 0)
+      v = 4095;
+    trace[i] = clamp12(v);
+  }
+  flips_t flips = replay(trace, 60000, (hysteresis_t)HYST_BELOW_INIT(1229, 1351), false);
+  CHECK(flips.raw > 1000, "o traço de umidade devia oscilar (%u trocas)", (unsigned)flips.raw);
+  CHECK(flips.filtered == 2, "umidade: %u trocas, esperado 2", (unsigned)flips.filtered);
+}
+
+static int replay_file(const char *path) {
+  FILE *fp = fopen(path, "r");
+  if (!fp) {
+    perror(path);
+    return 1;
+  }
+  size_t cap = 4096, n = 0;
+  uint16_t *trace = malloc(cap * sizeof(uint16_t));
+  long v;
+  while (trace && fscanf(fp, "%ld", &v) == 1) {
+    if (n == cap)
+      trace = realloc(trace, (cap *= 2) * sizeof(uint16_t));
+    if (trace)
+      trace[n++] = clamp12((int32_t)v);
+  }
+  fclose(fp);
+  if (!trace)
+    return 1;
+  printf("%s: %zu amostras, seletor (zona alta 3080/2980)\n", path, n);
+  flips_t flips = replay(trace, n, (hysteresis_t)HYST_ABOVE_INIT(3080, 2980), true);
+  printf("%s: %u trocas sem filtro, %u com filtro e histerese\n", path, (unsigned)flips.raw,
+         (unsigned)flips.filtered);
+  free(trace);
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  test_oversampling();
+  test_median();
+  test_ema();
+  test_hysteresis();
+  test_selector_trace();
+  test_moisture_trace();
+  for (int i = 1; i < argc; ++i)
+    failures += replay_file(argv[i]);
+  printf("filters_test: %s (%d falhas)\n", failures ? "FALHOU" : "ok", failures);
+  return failures ? 1 : 0;
+}
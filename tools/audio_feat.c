@@ -0,0 +1,122 @@
+// Características de áudio de um WAV pelo mesmo código do firmware (lib/audio.c).
+//
+// Cada amostra de 16 bits vira 12 bits em torno do meio da escala, como o
+// microfone chega ao ADC, e passa por audio_push/audio_process. Sai um CSV
+// por bloco de 32 ms com o nível RMS, o pico e as bandas em dBFS. Com -g,
+// em vez de analisar, grava um WAV de teste (seno, ruído ou os dois).
+//
+//   audio_feat [-q] entrada.wav
+//   audio_feat -g saida.wav [-f hz] [-a dbfs] [-n dbfs] [-s segundos] [-r taxa]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <getopt.h>
+#include "lib/audio.h"
+#include "sim/wav.h"
+
+static void print_db(int32_t q8) {
+  printf(",%.1f", q8 / 256.0);
+}
+
+static int analyze(const char *path, bool quiet) {
+  uint32_t rate;
+  size_t count;
+  int16_t *pcm = wav_load(path, &rate, &count);
+  if (!pcm)
+    return 1;
+  if (rate != 8000)
+    fprintf(stderr, "audio_feat: %s a %u Hz; as bandas supõem 8000 Hz\n", path, rate);
+
+  static audio_t a;
+  audio_init(&a, audio_bands_8k);
+  if (!quiet)
+    printf("bloco,t_ms,rms,pico,rms_db,pico_db,b31_250,b250_1k,b1k_2k,b2k_4k\n");
+  int64_t sum[2 + AUDIO_BANDS] = { 0 };
+  for (size_t i = 0; i < count; ++i) {
+    int32_t v = 2048 + pcm[i] / 16;
+    audio_push(&a, (uint16_t)(v < 0 ? 0 : v > 4095 ? 4095 : v));
+    while (audio_process(&a)) {
+      const audio_features_t *f = &a.out;
+      sum[0] += f->rms_db_q8;
+      sum[1] += f->peak_db_q8;
+      for (int b = 0; b < AUDIO_BANDS; ++b)
+        sum[2 + b] += f->band_db_q8[b];
+      if (quiet)
+        continue;
+      printf("%lu,%.1f,%u,%u", (unsigned long)f->blocks - 1,
+             (double)(f->blocks - 1) * AUDIO_BLOCK * 1000.0 / rate, f->rms, f->peak);
+      print_db(f->rms_db_q8);
+      print_db(f->peak_db_q8);
+      for (int b = 0; b < AUDIO_BANDS; ++b)
+        print_db(f->band_db_q8[b]);
+      printf("\n");
+    }
+  }
+  uint32_t n = a.out.blocks;
+  fprintf(stderr, "%s: %zu amostras, %u blocos", path, count, n);
+  if (n) {
+    fprintf(stderr, "; medias rms %.1f pico %.1f bandas", sum[0] / 256.0 / n, sum[1] / 256.0 / n);
+    for (int b = 0; b < AUDIO_BANDS; ++b)
+      fprintf(stderr, " %.1f", sum[2 + b] / 256.0 / n);
+    fprintf(stderr, " dBFS");
+  }
+  fprintf(stderr, "\n");
+  free(pcm);
+  return n ? 0 : 1;
+}
+
+// Seno de freq_hz com pico em tone_db e ruído branco uniforme em noise_db,
+// ambos em dBFS com a referência do firmware: 0 dB é o seno de escala cheia
+// (o ruído de 0 dB tem o RMS desse seno)
+static int generate(const char *path, double freq_hz, double tone_db, double noise_db, double seconds,
+                    uint32_t rate) {
+  size_t count = (size_t)(seconds * rate);
+  int16_t *pcm = malloc((count ? count : 1) * sizeof(int16_t));
+  double tone = freq_hz > 0 ? 32767.0 * pow(10.0, tone_db / 20.0) : 0;
+  double noise = noise_db > -120 ? 32767.0 * pow(10.0, noise_db / 20.0) * sqrt(1.5) : 0;
+  uint32_t state = 0x2545F491u;
+  for (size_t i = 0; i < count; ++i) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    double v = tone * sin(2.0 * M_PI * freq_hz * i / rate) + noise * ((double)state / 4294967295.0 * 2.0 - 1.0);
+    pcm[i] = (int16_t)lrint(v > 32767 ? 32767 : v < -32768 ? -32768 : v);
+  }
+  bool ok = wav_save(path, pcm, count, rate);
+  free(pcm);
+  return ok ? 0 : 1;
+}
+
+int main(int argc, char **argv) {
+  const char *out_path = NULL;
+  double freq = 1000, tone_db = -6, noise_db = -200, seconds = 2;
+  uint32_t rate = 8000;
+  bool quiet = false;
+  int opt;
+  while ((opt = getopt(argc, argv, "g:f:a:n:s:r:qh")) != -1) {
+    switch (opt) {
+      case 'g': out_path = optarg; break;
+      case 'f': freq = atof(optarg); break;
+      case 'a': tone_db = atof(optarg); break;
+      case 'n': noise_db = atof(optarg); break;
+      case 's': seconds = atof(optarg); break;
+      case 'r': rate = (uint32_t)atoi(optarg); break;
+      case 'q': quiet = true; break;
+      default:
+        fprintf(stderr, "uso: %s [-q] entrada.wav\n"
+                        "     %s -g saida.wav [-f hz] [-a dbfs] [-n dbfs] [-s segundos] [-r taxa]\n"
+                        "  -q  só as médias, sem o CSV por bloco\n"
+                        "  -g  grava um WAV de teste: seno de -f Hz (0: sem seno, padrão 1000)\n"
+                        "      de -a dBFS (padrão -6) mais ruído branco de -n dBFS\n", argv[0], argv[0]);
+        return opt == 'h' ? 0 : 2;
+    }
+  }
+  if (out_path)
+    return generate(out_path, freq, tone_db, noise_db, seconds, rate ? rate : 8000);
+  if (optind >= argc) {
+    fprintf(stderr, "audio_feat: falta o arquivo WAV\n");
+    return 2;
+  }
+  return analyze(argv[optind], quiet);
+}
@@ -0,0 +1,321 @@
+// Decodificador e gravador da telemetria binária do firmware (lib/telemetry.h).
+//
+// Lê a porta USB da placa (ou um arquivo gravado, ou a saída do bitdog_sim)
+// e imprime um CSV por registro. O texto do printf que chega entre os quadros
+// vai para o stderr com "# " na frente. No fim, ou com Ctrl+C, mostra os
+// quadros válidos, os com CRC ou COBS ruim e os perdidos pelas lacunas da
+// sequência. Com -r, grava os bytes recebidos para decodificar depois.
+//
+// Com -l, testa o enquadramento sem a placa. A codificação do firmware
+// escreve num pseudo-terminal, a leitura é feita do outro lado, e o teste
+// injeta texto, corrompe quadros e para de ler por um tempo.
+//
+//   tlm_decode [-x] [-q] [-r gravacao.bin] [/dev/ttyACM0 | arquivo]
+//   tlm_decode -l [registros]
+
+#define _XOPEN_SOURCE 600   // posix_openpt, grantpt, unlockpt, ptsname
+#define _DEFAULT_SOURCE     // cfmakeraw, usleep
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <getopt.h>
+#include <termios.h>
+#include <unistd.h>
+#include "lib/telemetry.h"
+
+typedef struct {
+  tlm_decoder_t dec;
+  char text[4096];             // Bytes desde o último zero, para mostrar o texto
+  size_t text_len;
+  bool have_seq;
+  uint16_t last_seq;
+  bool quiet;                  // Sem CSV nem texto (teste e resumo)
+  // Contagens
+  uint32_t frames, records, bad_crc, bad_cobs, too_long, lost, text_chunks;
+  uint64_t bytes, text_bytes;
+  // Conferência do teste em pseudo-terminal
+  bool check;
+  uint32_t check_bad;
+} reader_t;
+
+static volatile sig_atomic_t stop;
+
+static void on_signal(int sig) {
+  stop = 1;
+}
+
+static void print_q8(int16_t v) {
+  printf(",%.1f", v / 256.0);
+}
+
+static void print_record(const tlm_rec_t *r) {
+  static const char *const energy[] = { "ativo", "apagado", "janela", "economia" };
+  const uint8_t *d = r->data;
+  printf("%lu", (unsigned long)r->t_ms);
+  if (r->type == TLM_SENSORS && r->len >= TLM_SENSORS_LEN) {
+    printf(",sensores");
+    for (int i = 0; i < 4; ++i)
+      print_q8((int16_t)tlm_get16(d + 2 * i));
+  } else if (r->type == TLM_AUDIO && r->len >= TLM_AUDIO_LEN) {
+    printf(",audio");
+    for (int i = 0; i < 5; ++i)
+      print_q8((int16_t)tlm_get16(d + 2 * i));
+  } else if (r->type == TLM_STATUS && r->len >= TLM_STATUS_LEN) {
+    printf(",estado,%s,%u,%u,%u,%lu,%lu,%lu", d[0] < 4 ? energy[d[0]] : "?", d[1] & 1, (d[1] >> 1) & 1,
+           (d[1] >> 2) & 1, (unsigned long)tlm_get32(d + 2), (unsigned long)tlm_get32(d + 6),
+           (unsigned long)tlm_get32(d + 10));
+  } else {
+    printf(",tipo%u,", r->type);
+    for (int i = 0; i < r->len; ++i)
+      printf("%02x", d[i]);
+  }
+  printf("\n");
+}
+
+// Registro do teste: índice, complemento, índice * 7 e o instante índice * 50 ms
+static bool check_record(const tlm_rec_t *r) {
+  if (r->type != TLM_SENSORS || r->len != TLM_SENSORS_LEN)
+    return false;
+  uint16_t i = tlm_get16(r->data);
+  return tlm_get16(r->data + 2) == (uint16_t)~i && tlm_get16(r->data + 4) == (uint16_t)(i * 7) &&
+         r->t_ms == i * 50u;
+}
+
+static bool printable(const char *s, size_t n) {
+  for (size_t i = 0; i < n; ++i) {
+    if (!isprint((unsigned char)s[i]) && s[i] != '\n' && s[i] != '\r' && s[i] != '\t')
+      return false;
+  }
+  return n > 0;
+}
+
+static void show_text(const char *s, size_t n) {
+  const char *end = s + n;
+  while (s < end) {
+    const char *nl = memchr(s, '\n', end - s);
+    size_t len = nl ? (size_t)(nl - s) : (size_t)(end - s);
+    if (len && s[len - 1] == '\r')
+      len--;
+    if (len)
+      fprintf(stderr, "# %.*s\n", (int)len, s);
+    s = nl ? nl + 1 : end;
+  }
+}
+
+static void feed(reader_t *rd, const uint8_t *data, size_t n) {
+  uint8_t raw[TLM_PACKET];
+  size_t raw_len;
+  for (size_t i = 0; i < n; ++i) {
+    rd->bytes++;
+    if (data[i] && rd->text_len < sizeof(rd->text))
+      rd->text[rd->text_len++] = (char)data[i];
+    tlm_dec_result_t res = tlm_decode_byte(&rd->dec, data[i], raw, &raw_len);
+    if (!data[i]) {
+      // Um trecho que não é quadro: texto do printf ou quadro estragado
+      if (res != TLM_DEC_FRAME && res != TLM_DEC_NONE && printable(rd->text, rd->text_len)) {
+        rd->text_chunks++;
+        rd->text_bytes += rd->text_len;
+        if (!rd->quiet)
+          show_text(rd->text, rd->text_len);
+      } else if (res == TLM_DEC_BAD_CRC) {
+        rd->bad_crc++;
+      } else if (res == TLM_DEC_BAD_COBS) {
+        rd->bad_cobs++;
+      } else if (res == TLM_DEC_TOO_LONG) {
+        rd->too_long++;
+      }
+      rd->text_len = 0;
+    }
+    if (res != TLM_DEC_FRAME)
+      continue;
+    uint16_t seq = tlm_get16(raw + 1);
+    if (rd->have_seq)
+      rd->lost += (uint16_t)(seq - rd->last_seq - 1);
+    rd->have_seq = true;
+    rd->last_seq = seq;
+    rd->frames++;
+    size_t pos = 0;
+    tlm_rec_t r;
+    while (tlm_frame_next(raw, raw_len, &pos, &r)) {
+      rd->records++;
+      if (rd->check && !check_record(&r))
+        rd->check_bad++;
+      if (!rd->quiet)
+        print_record(&r);
+    }
+  }
+}
+
+static void print_summary(const reader_t *rd) {
+  fprintf(stderr,
+          "tlm: %llu bytes, %u quadros, %u registros | perdidos %u (lacunas na sequencia) | "
+          "CRC ruim %u, COBS ruim %u, longos %u | texto %u trechos, %llu bytes\n",
+          (unsigned long long)rd->bytes, rd->frames, rd->records, rd->lost, rd->bad_crc, rd->bad_cobs,
+          rd->too_long, rd->text_chunks, (unsigned long long)rd->text_bytes);
+}
+
+static bool set_raw(int fd) {
+  struct termios tio;
+  if (tcgetattr(fd, &tio))
+    return false;
+  cfmakeraw(&tio);
+  return tcsetattr(fd, TCSANOW, &tio) == 0;
+}
+
+// ---------------------------------------------------------------------------
+// Teste em pseudo-terminal: o lado mestre faz o papel da placa, o escravo o
+// da porta /dev/ttyACM0 no PC
+// ---------------------------------------------------------------------------
+
+static size_t pty_write(void *ctx, const uint8_t *data, size_t len) {
+  ssize_t n = write(*(int *)ctx, data, len);
+  return n < 0 ? 0 : (size_t)n;   // EAGAIN: o "host" não leu, o anel segura
+}
+
+static void pty_drain(int fd, reader_t *rd) {
+  uint8_t buf[4096];
+  ssize_t n;
+  while ((n = read(fd, buf, sizeof(buf))) > 0)
+    feed(rd, buf, (size_t)n);
+}
+
+static int loopback(uint32_t count) {
+  int master = posix_openpt(O_RDWR | O_NOCTTY);
+  if (master < 0 || grantpt(master) || unlockpt(master)) {
+    perror("tlm: pseudo-terminal");
+    return 1;
+  }
+  int slave = open(ptsname(master), O_RDWR | O_NOCTTY);
+  if (slave < 0 || !set_raw(slave)) {
+    perror("tlm: pseudo-terminal");
+    return 1;
+  }
+  fcntl(master, F_SETFL, fcntl(master, F_GETFL) | O_NONBLOCK);
+  fcntl(slave, F_SETFL, fcntl(slave, F_GETFL) | O_NONBLOCK);
+
+  static tlm_t t;
+  static reader_t rd = { .quiet = true, .check = true };
+  tlm_init(&t, pty_write, &master);
+  uint32_t texts = 0, corrupted = 0;
+  uint32_t stall_from = count / 4, stall_to = count / 4 + count / 3;   // O "host" para de ler
+  for (uint32_t i = 0; i < count; ++i) {
+    uint8_t d[TLM_SENSORS_LEN], *p = d;
+    p = tlm_put16(p, i);
+    p = tlm_put16(p, ~i);
+    p = tlm_put16(p, i * 7);
+    tlm_put16(p, 0);
+    uint32_t frames = t.stats.frames, dropped = t.stats.dropped_frames;
+    tlm_record(&t, TLM_SENSORS, i * 50, d, TLM_SENSORS_LEN);
+    // A cada 53 quadros que entraram no anel, um byte trocado no meio do último
+    if (t.stats.frames != frames && t.stats.dropped_frames == dropped && t.stats.frames % 53 == 0) {
+      uint8_t *b = &t.ring[(t.head - 6) & (TLM_RING_LEN - 1)];
+      *b ^= *b == 1 ? 2 : 1;
+      corrupted++;
+    }
+    tlm_poll(&t, i * 50);
+    // Texto do printf entre quadros, com o anel vazio
+    if (i % 97 == 0 && !tlm_pending(&t) && (i < stall_from || i >= stall_to)) {
+      char line[64];
+      int n = snprintf(line, sizeof(line), "relatorio %u: texto no meio\r\n", i);
+      if (write(master, line, n) == n)
+        texts++;
+    }
+    if (i < stall_from || i >= stall_to)
+      pty_drain(slave, &rd);
+  }
+  tlm_close(&t);
+  for (int tries = 0; tries < 1000 && tlm_pending(&t); ++tries) {
+    tlm_poll(&t, count * 50);
+    pty_drain(slave, &rd);
+  }
+  feed(&rd, (const uint8_t *)"", 1);   // Um zero fecha o que sobrou
+  usleep(10000);
+  pty_drain(slave, &rd);
+  close(slave);
+  close(master);
+
+  print_summary(&rd);
+  fprintf(stderr, "tlm: enviados %u quadros, %u registros; %u descartados no anel, %u corrompidos, %u textos\n",
+          t.stats.frames, t.stats.records, t.stats.dropped_frames, corrupted, texts);
+  uint32_t expected = t.stats.frames - t.stats.dropped_frames - corrupted;
+  bool ok = rd.frames == expected && rd.bad_crc + rd.bad_cobs == corrupted && rd.lost == t.stats.dropped_frames + corrupted &&
+            rd.text_chunks == texts && !rd.check_bad;
+  if (!ok)
+    fprintf(stderr, "tlm: esperados %u quadros validos, %u ruins, %u perdidos; %u registros errados\n", expected,
+            corrupted, t.stats.dropped_frames + corrupted, rd.check_bad);
+  if (!t.stats.dropped_frames)
+    fprintf(stderr, "tlm: a pausa nao encheu o pseudo-terminal; o descarte ficou sem teste (use mais registros)\n");
+  fprintf(stderr, "loopback: %s\n", ok ? "ok" : "FALHOU");
+  return ok ? 0 : 1;
+}
+
+int main(int argc, char **argv) {
+  const char *rec_path = NULL;
+  bool enable = false, quiet = false, test = false;
+  int opt;
+  while ((opt = getopt(argc, argv, "r:xqlh")) != -1) {
+    switch (opt) {
+      case 'r': rec_path = optarg; break;
+      case 'x': enable = true; break;
+      case 'q': quiet = true; break;
+      case 'l': test = true; break;
+      default:
+        fprintf(stderr, "uso: %s [-x] [-q] [-r gravacao.bin] [porta|arquivo]\n"
+                        "     %s -l [registros]\n"
+                        "  -x  manda 'x' pela porta para ligar a telemetria\n"
+                        "  -q  só o resumo, sem o CSV nem o texto\n"
+                        "  -r  grava os bytes recebidos (decodificar depois com o arquivo)\n"
+                        "  -l  teste do enquadramento num pseudo-terminal, sem a placa\n", argv[0], argv[0]);
+        return opt == 'h' ? 0 : 2;
+    }
+  }
+  if (test)
+    return loopback(optind < argc ? (uint32_t)atoi(argv[optind]) : 20000);
+
+  int fd = STDIN_FILENO;
+  if (optind < argc && (fd = open(argv[optind], O_RDWR | O_NOCTTY)) < 0 &&
+      (fd = open(argv[optind], O_RDONLY)) < 0) {
+    fprintf(stderr, "tlm: nao abriu %s\n", argv[optind]);
+    return 1;
+  }
+  if (isatty(fd)) {
+    set_raw(fd);
+    if (enable && write(fd, "x", 1) != 1)
+      fprintf(stderr, "tlm: nao mandou o comando x\n");
+  }
+  FILE *rec = NULL;
+  if (rec_path && !(rec = fopen(rec_path, "wb"))) {
+    fprintf(stderr, "tlm: nao criou %s\n", rec_path);
+    return 1;
+  }
+  // Sem SA_RESTART: o Ctrl+C interrompe o read parado e o resumo sai
+  struct sigaction sa = { .sa_handler = on_signal };
+  sigaction(SIGINT, &sa, NULL);
+  static reader_t rd;
+  rd.quiet = quiet;
+  uint8_t buf[4096];
+  ssize_t n;
+  while (!stop && (n = read(fd, buf, sizeof(buf))) != 0) {
+    if (n < 0) {
+      if (errno == EINTR)
+        continue;
+      break;
+    }
+    if (rec)
+      fwrite(buf, 1, (size_t)n, rec);
+    feed(&rd, buf, (size_t)n);
+    fflush(stdout);
+  }
+  if (rec)
+    fclose(rec);
+  if (fd != STDIN_FILENO)
+    close(fd);
+  print_summary(&rd);
+  return 0;
+}
@@ -0,0 +1,297 @@
+// Decodificador do registro de eventos do firmware (lib/trace.h).
+//
+// Lê a saída do USB (ou do bitdog_sim) com um ou mais despejos do comando 't'
+// e monta a linha do tempo dos dois núcleos: cada evento com o instante em ms,
+// os intervalos (tarefas, renderização, envios ao OLED) com a duração e, no
+// fim, um resumo por intervalo. Com -j também grava o formato de trace do
+// Chrome (abrir em chrome://tracing ou no Perfetto).
+//
+//   trace_decode [-j saida.json] [-q] [log.txt]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <getopt.h>
+
+#define MAX_EVENTS 64
+#define MAX_NAMES  64
+#define MAX_OPEN   16
+
+enum { KIND_MARK, KIND_BEGIN, KIND_END };
+
+typedef struct {
+  uint64_t t_us;
+  uint32_t seq;                // Ordem de chegada (desempate estável)
+  uint8_t core;
+  uint16_t event;
+  uint16_t arg;
+} rec_t;
+
+typedef struct {
+  char name[24];
+  uint8_t kind;
+} event_info_t;
+
+typedef struct {
+  char event[24];
+  uint16_t arg;
+  char name[24];
+} arg_name_t;
+
+// Estatística de um intervalo (nome do evento + argumento)
+typedef struct {
+  char label[48];
+  uint32_t count;
+  uint64_t total_us;
+  uint32_t max_us;
+} span_stat_t;
+
+static event_info_t events[MAX_EVENTS];
+static arg_name_t names[MAX_NAMES];
+static size_t name_count;
+static rec_t *recs;
+static size_t rec_count, rec_capacity;
+static span_stat_t stats[MAX_EVENTS * 8];
+static size_t stat_count;
+
+static void add_rec(rec_t r) {
+  if (rec_count == rec_capacity) {
+    rec_capacity = rec_capacity ? rec_capacity * 2 : 1024;
+    recs = realloc(recs, rec_capacity * sizeof(rec_t));
+  }
+  r.seq = rec_count;
+  recs[rec_count++] = r;
+}
+
+static int rec_cmp(const void *pa, const void *pb) {
+  const rec_t *a = pa, *b = pb;
+  if (a->t_us != b->t_us)
+    return a->t_us < b->t_us ? -1 : 1;
+  return a->seq < b->seq ? -1 : a->seq > b->seq;
+}
+
+static const char *event_name(uint16_t event) {
+  return event < MAX_EVENTS && events[event].name[0] ? events[event].name : "?";
+}
+
+// Nome do argumento ("tarefa 1" -> "sensores"), se o despejo informou
+static const char *arg_name(uint16_t event, uint16_t arg) {
+  for (size_t i = 0; i < name_count; ++i)
+    if (names[i].arg == arg && !strcmp(names[i].event, event_name(event)))
+      return names[i].name;
+  return NULL;
+}
+
+static void label_of(const rec_t *r, char *out, size_t len) {
+  const char *an = arg_name(r->event, r->arg);
+  if (an)
+    snprintf(out, len, "%s %s", event_name(r->event), an);
+  else
+    snprintf(out, len, "%s", event_name(r->event));
+}
+
+static void stat_add(const char *label, uint32_t us) {
+  span_stat_t *s = NULL;
+  for (size_t i = 0; i < stat_count && !s; ++i)
+    if (!strcmp(stats[i].label, label))
+      s = &stats[i];
+  if (!s) {
+    if (stat_count == sizeof(stats) / sizeof(stats[0]))
+      return;
+    s = &stats[stat_count++];
+    snprintf(s->label, sizeof(s->label), "%s", label);
+  }
+  s->count++;
+  s->total_us += us;
+  if (us > s->max_us)
+    s->max_us = us;
+}
+
+// Uma linha "#T <núcleo> tttttttteeeeaaaa ..." de um despejo ancorado em 'agora'
+static void parse_records(const char *s, uint64_t now) {
+  unsigned core;
+  int used;
+  if (sscanf(s, "#T %u%n", &core, &used) != 1 || core > 1)
+    return;
+  s += used;
+  char hex[17];
+  while (sscanf(s, " %16[0-9a-fA-F]%n", hex, &used) == 1) {
+    s += used;
+    if (strlen(hex) != 16)
+      continue;
+    uint64_t v = strtoull(hex, NULL, 16);
+    rec_t r = { 0 };
+    // Tempo de 32 bits: o registro é sempre anterior ao 'agora' do despejo
+    uint32_t t32 = (uint32_t)(v >> 32);
+    r.t_us = now - (uint32_t)((uint32_t)now - t32);
+    r.core = core;
+    r.event = (v >> 16) & 0xFFFF;
+    r.arg = v & 0xFFFF;
+    add_rec(r);
+  }
+}
+
+static bool load(FILE *f) {
+  char line[1024];
+  uint64_t now = 0;
+  bool in_dump = false;
+  size_t dumps = 0;
+  while (fgets(line, sizeof(line), f)) {
+    char *s = line;
+    while (*s == ' ' || *s == '\t')
+      s++;
+    unsigned long long agora;
+    unsigned id, kind, arg;
+    char a[24], b[24];
+    if (sscanf(s, "#trace inicio agora=%llu", &agora) == 1) {
+      now = agora;
+      in_dump = true;
+      dumps++;
+    } else if (!strncmp(s, "#trace fim", 10)) {
+      in_dump = false;
+      unsigned long lost0, lost1;
+      if (sscanf(s, "#trace fim perdidos=%lu,%lu", &lost0, &lost1) == 2 && (lost0 || lost1))
+        fprintf(stderr, "trace_decode: registros perdidos (sobrescritos): nucleo0=%lu nucleo1=%lu\n", lost0, lost1);
+    } else if (sscanf(s, "#E %u %23s %u", &id, a, &kind) == 3 && id < MAX_EVENTS) {
+      snprintf(events[id].name, sizeof(events[id].name), "%s", a);
+      events[id].kind = kind;
+    } else if (sscanf(s, "#N %23s %u %23s", a, &arg, b) == 3) {
+      size_t i;
+      for (i = 0; i < name_count; ++i)
+        if (names[i].arg == arg && !strcmp(names[i].event, a))
+          break;
+      if (i == name_count && name_count < MAX_NAMES)
+        name_count++;
+      if (i < MAX_NAMES) {
+        snprintf(names[i].event, sizeof(names[i].event), "%s", a);
+        snprintf(names[i].name, sizeof(names[i].name), "%s", b);
+        names[i].arg = arg;
+      }
+    } else if (in_dump && !strncmp(s, "#T ", 3)) {
+      parse_records(s, now);
+    }
+  }
+  if (!dumps)
+    fprintf(stderr, "trace_decode: nenhum despejo (#trace inicio) na entrada\n");
+  return dumps > 0;
+}
+
+// Intervalos viram eventos completos ("X", com duração); os demais, instantâneos
+static void json_event(FILE *j, bool *first, const rec_t *r, const uint32_t *dur_us, uint64_t t0) {
+  char label[48], extra[32];
+  label_of(r, label, sizeof(label));
+  if (dur_us)
+    snprintf(extra, sizeof(extra), "\"ph\":\"X\",\"dur\":%lu", (unsigned long)*dur_us);
+  else
+    snprintf(extra, sizeof(extra), "\"ph\":\"i\",\"s\":\"t\"");
+  fprintf(j, "%s\n{\"name\":\"%s\",%s,\"ts\":%llu,\"pid\":0,\"tid\":%u,\"args\":{\"arg\":%u}}",
+          *first ? "" : ",", label, extra, (unsigned long long)(r->t_us - t0), r->core, r->arg);
+  *first = false;
+}
+
+int main(int argc, char **argv) {
+  const char *json_path = NULL;
+  bool quiet = false;
+  int opt;
+  while ((opt = getopt(argc, argv, "j:qh")) != -1) {
+    switch (opt) {
+      case 'j': json_path = optarg; break;
+      case 'q': quiet = true; break;
+      default:
+        fprintf(stderr, "uso: %s [-j saida.json] [-q] [log.txt]\n"
+                        "  -j  grava também no formato de trace do Chrome/Perfetto\n"
+                        "  -q  só o resumo, sem a linha do tempo\n", argv[0]);
+        return opt == 'h' ? 0 : 2;
+    }
+  }
+  FILE *in = stdin;
+  if (optind < argc && !(in = fopen(argv[optind], "r"))) {
+    fprintf(stderr, "trace_decode: nao abriu %s\n", argv[optind]);
+    return 1;
+  }
+  bool ok = load(in);
+  if (in != stdin)
+    fclose(in);
+  if (!ok || !rec_count)
+    return 1;
+  qsort(recs, rec_count, sizeof(rec_t), rec_cmp);
+
+  FILE *j = NULL;
+  bool first = true;
+  if (json_path) {
+    if (!(j = fopen(json_path, "w"))) {
+      fprintf(stderr, "trace_decode: nao criou %s\n", json_path);
+      return 1;
+    }
+    fprintf(j, "{\"traceEvents\":[");
+  }
+
+  // Intervalos abertos por núcleo: o fim fecha o início mais recente do mesmo evento/argumento
+  rec_t open[2][MAX_OPEN];
+  size_t open_count[2] = { 0, 0 };
+
+  uint64_t t0 = recs[0].t_us;
+  if (!quiet)
+    printf("%12s %3s  %-24s %s\n", "t (ms)", "nuc", "evento", "detalhe");
+  for (size_t i = 0; i < rec_count; ++i) {
+    const rec_t *r = &recs[i];
+    uint8_t kind = r->event < MAX_EVENTS ? events[r->event].kind : KIND_MARK;
+    char label[48], detail[48] = "";
+    label_of(r, label, sizeof(label));
+
+    if (kind == KIND_BEGIN) {
+      if (open_count[r->core] < MAX_OPEN)
+        open[r->core][open_count[r->core]++] = *r;
+      snprintf(detail, sizeof(detail), "inicio");
+      if (!arg_name(r->event, r->arg) && r->arg)
+        snprintf(detail, sizeof(detail), "inicio (%u)", r->arg);
+    } else if (kind == KIND_END) {
+      // Procura do topo para baixo: intervalos aninhados fecham na ordem inversa
+      size_t k = open_count[r->core];
+      while (k > 0) {
+        const rec_t *b = &open[r->core][k - 1];
+        if (!strcmp(event_name(b->event), event_name(r->event)) &&
+            (b->arg == r->arg || !arg_name(r->event, r->arg)))
+          break;
+        k--;
+      }
+      if (k > 0) {
+        const rec_t *b = &open[r->core][k - 1];
+        uint32_t us = (uint32_t)(r->t_us - b->t_us);
+        char begin_label[48];
+        label_of(b, begin_label, sizeof(begin_label));
+        stat_add(begin_label, us);
+        snprintf(detail, sizeof(detail), "fim, %lu us", (unsigned long)us);
+        if (j)
+          json_event(j, &first, b, &us, t0);
+        open_count[r->core] = k - 1;
+      } else {
+        snprintf(detail, sizeof(detail), "fim sem inicio");
+      }
+    } else {
+      snprintf(detail, sizeof(detail), "%u", r->arg);
+    }
+    if (j && kind == KIND_MARK)
+      json_event(j, &first, r, NULL, t0);
+
+    if (!quiet)
+      printf("%12.3f %3u  %-24s %s\n", (r->t_us - t0) / 1000.0, r->core, label, detail);
+  }
+
+  if (j) {
+    fprintf(j, "\n]}\n");
+    fclose(j);
+  }
+
+  printf("\n%-24s %8s %10s %10s %10s\n", "intervalo", "vezes", "media(us)", "pior(us)", "total(ms)");
+  for (size_t i = 0; i < stat_count; ++i) {
+    const span_stat_t *s = &stats[i];
+    printf("%-24s %8lu %10lu %10lu %10.1f\n", s->label, (unsigned long)s->count,
+           (unsigned long)(s->total_us / s->count), (unsigned long)s->max_us, s->total_us / 1000.0);
+  }
+  printf("%zu registros em %.1f ms\n", rec_count, (recs[rec_count - 1].t_us - t0) / 1000.0);
+  free(recs);
+  return 0;
+}